@@ -38,7 +38,7 @@ public:
     uint8_t in_count();
 
     shared_ptr<Message_M2C> out_pop();
-    void out_push(shared_ptr<Message_M2C> field);
+    virtual void out_push(shared_ptr<Message_M2C> field);
     uint8_t out_count();
     void out_wait();
     void out_wait(uint32_t useconds);
@@ -66,6 +66,11 @@ uint8_t Initializer::setup() {
     if (status)
         return status;
 
+    // Answer local statistics queries, if configured.
+    storage nwStats;
+    if (conf->getNetworkStats(nwStats))
+        this->nw.setQueryPath(nwStats.path);
+
     // Create Messages for spawning network threads.
     // These messages are polled from message hub as soon as the main thread of this instance is running.
     shared_ptr<M2M_Respawn> respawn(new M2M_Respawn);
@@ -76,6 +81,16 @@ uint8_t Initializer::setup() {
     // Push message to hub.
     MsgHub::getInstance()->appendMsg(respawn);
 
+    // The deferred communicator is optional, it needs a log to store data in.
+    storage deferredLog;
+    if (conf->getDeferredLog(deferredLog)) {
+        shared_ptr<M2M_Respawn> deferred(new M2M_Respawn);
+        shared_ptr<ValInt> deferredID(new ValInt);
+        deferredID->setValue(NW_DEFERRED);
+        deferred->setValue(ARG_RESPAWN_CHILD, deferredID);
+        MsgHub::getInstance()->appendMsg(deferred);
+    }
+
     return status;
 }
 
@@ -248,27 +263,55 @@ uint8_t Initializer::setUpImgProc(shared_ptr<Config> conf) {
         return INIT_ERR_LOAD;
     }
 
+    // Get optional jpeg compression of thumbnail region, defaults to no reduction.
+    uint8_t roiCompression=100;
+    conf->getRoiCompression(roiCompression);
+
     // Initialize arguments.
-    shared_ptr<cv::Mat> prep_mat(new cv::Mat(480, 640, CV_8UC1));
-    shared_ptr<ValMat> prep_ValMat(new ValMat(prep_mat));
     shared_ptr<ValInt> prep_ValScale(new ValInt(4));
     shared_ptr<ValInt> prep_ValPosX(new ValInt(5));
     shared_ptr<ValInt> prep_ValPosY(new ValInt(5));
     shared_ptr<ValInt> prep_ValQuali(new ValInt(compression));
+    shared_ptr<ValInt> prep_ValRoiQuali(new ValInt(roiCompression));
 
     // Create OpPrepare for image preparation and set arguments.
     shared_ptr<OpPrepare> prep_Op(new OpPrepare);
-    prep_Op->setValue("Capture0", prep_ValMat);
-    prep_Op->setValue("Capture1", prep_ValMat);
     prep_Op->setValue(ARG_SCALE, prep_ValScale);
     prep_Op->setValue(ARG_POS_X, prep_ValPosX);
     prep_Op->setValue(ARG_POS_Y, prep_ValPosY);
     prep_Op->setValue(ARG_JPEG_QUALITY, prep_ValQuali);
+    prep_Op->setValue(ARG_ROI_QUALITY, prep_ValRoiQuali);
+
+    // Initialization of motion gate, skipping preparation of static scenes.
+    // Mean difference in grey levels and maximum number of consecutively skipped frames.
+    shared_ptr<ValDouble> gate_ValThreshold(new ValDouble(2.0));
+    shared_ptr<ValInt> gate_ValMaxSkip(new ValInt(50));
+
+    // Create OpMotionGate and set arguments.
+    shared_ptr<OpMotionGate> gate_Op(new OpMotionGate);
+    gate_Op->setValue(ARG_MOTION_THRESHOLD, gate_ValThreshold);
+    gate_Op->setValue(ARG_MOTION_MAX_SKIP, gate_ValMaxSkip);
+
+    // Initialization of optional video stream encoder.
+    shared_ptr<OpEncodeStream> stream_Op;
+    encoding streamEnc;
+    if (conf->getStream(streamEnc)) {
+
+        // Frame rate follows the primary capture.
+        uint8_t streamPrime=0;
+        conf->getPrimeCap(streamPrime);
+        uint8_t streamFps = (in.index == streamPrime) ? in.fps : out.fps;
+
+        // Create OpEncodeStream and set arguments.
+        stream_Op = shared_ptr<OpEncodeStream>(new OpEncodeStream);
+        stream_Op->setValue(ARG_STREAM_CODEC, shared_ptr<ValString>(new ValString(streamEnc.codec)));
+        stream_Op->setValue(ARG_STREAM_BITRATE, shared_ptr<ValInt>(new ValInt(streamEnc.bitrate)));
+        stream_Op->setValue(ARG_STREAM_GOP, shared_ptr<ValInt>(new ValInt(streamEnc.gop)));
+        stream_Op->setValue(ARG_STREAM_FPS, shared_ptr<ValInt>(new ValInt(streamFps)));
+    }
 
     // Initialization of curve detection.
     // Initialize arguments.
-    shared_ptr<cv::Mat> curve_mat(new cv::Mat(480, 640, CV_8UC1));
-    shared_ptr<ValMat> curve_ValMat(new ValMat(prep_mat));
     shared_ptr<ValInt> curve_ValAngle(new ValInt(47));
     shared_ptr<ValInt> curve_ValRadAtMeter(new ValInt(10));
     shared_ptr<ValInt> curve_ValAreaPix(new ValInt(80));
@@ -283,7 +326,6 @@ uint8_t Initializer::setUpImgProc(shared_ptr<Config> conf) {
 
     // Create OpCurveDetection for curve detection and set arguments.
     shared_ptr<OpCurveDetection> curve_Op(new OpCurveDetection);
-    curve_Op->setValue("Capture0", curve_ValMat);
     curve_Op->setValue(ARG_CAM_VIEW_ANGLE_V, curve_ValAngle);
     curve_Op->setValue(ARG_CAM_CALC_RADIUS_AT_METER, curve_ValRadAtMeter);
     curve_Op->setValue(ARG_CAM_MARKING_SEARCH_AREA_PIX, curve_ValAreaPix);
@@ -352,7 +394,11 @@ uint8_t Initializer::setUpImgProc(shared_ptr<Config> conf) {
         return INIT_ERR_DEV_UNKNOWN;
     }
 
-    // Append operator to corresponding executor.
+    // Append operators to corresponding executor, motion gate has to come first.
+    // The video stream encoder is placed in front of it, to get every frame.
+    if (stream_Op)
+        exe->op_append(dynamic_pointer_cast<ImgOperator>(stream_Op));
+    exe->op_append(dynamic_pointer_cast<ImgOperator>(gate_Op));
     exe->op_append(dynamic_pointer_cast<ImgOperator>(prep_Op));
     // exe->op_append(dynamic_pointer_cast<ImgOperator>(curve_Op));
 
@@ -488,34 +534,107 @@ shared_ptr<Message_M2M> Initializer::processMsg(shared_ptr<Message_M2M> msg) {
                 return msg;
             }
 
-            // Get device id.
-            uint8_t devID=0;
+            // Get device id, optional payload compression, acknowledgement window and transmit policy.
+            uint8_t devID=0, compression=0;
+            uint16_t window=0;
+            transmit tx = {T_NODELAY, 0, 0, 0};
             conf->getDeviceID(devID);
+            conf->getNetworkCompression(compression);
+            conf->getNetworkWindow(window);
+            conf->getNetworkTransmit(tx);
+
+            // Stream fragments are offered to the server, if a stream encoder is set up.
+            encoding streamEnc;
+            bool stream = conf->getStream(streamEnc);
+
+            // Get optional send rate budgets.
+            budget image = {0, 0}, telemetry = {0, 0};
+            shared_ptr<NW_Shaper> shaper;
+            if (conf->getNetworkShaping(image, telemetry))
+                shaper = createShaper(image, telemetry);
+
+            // Get optional TLS context, created once to resume sessions across respawns.
+            security tls;
+            if (conf->getNetworkSecurity(tls) && !this->tlsRealtime) {
+                this->tlsRealtime = createTLSContext(tls);
+                if (!this->tlsRealtime)
+                    return msg;
+            }
 
             // Create network communicator instance.
-            shared_ptr<NetworkCommunicator> comm = createComm(realtime.target, realtime.port, realtime.iface, NW_TYPE_REALTIME, devID);
+            shared_ptr<NetworkCommunicator> comm = createComm(realtime.target, realtime.port, realtime.iface, realtime.media, NW_TYPE_REALTIME, devID, compression, window, stream, tx, shaper, this->tlsRealtime);
 
             // If comm does not point to null, communicator creation was successful.
             if (comm) {
 
+                // Report statistics to the server, if configured.
+                storage stats;
+                if (conf->getNetworkStats(stats))
+                    comm->setReportInterval(stats.interval*1000);
+
+                // Observe child, it is driven by the network module's reactor.
+                comm->attachObserver(&(this->nw));
+
                 // Append network communicator to network module.
                 if (this->nw.com_append(comm)){
                     printErr(INIT_ERR_DEV_APPEND, "communicator");
                     return msg;
                 }
 
-                // Add child to list of threaded children and run it.
-                this->nw.addChild(comm);
-                comm->attachObserver(&(this->nw));
-                this->nw.runChild(this->nw.getChildCount()-1);
-
             } else return msg;
             break;
         }
 
         // Respawn deferred communicator.
-        case NW_DEFERRED:
+        case NW_DEFERRED: {
+
+            // Get configuration of deferred connection and its log.
+            server deferred;
+            storage log;
+            if (!conf->getDeferred(deferred) || !conf->getDeferredLog(log)) {
+                printErr(INIT_ERR_LOAD, "deferred server params");
+                return msg;
+            }
+
+            // Get device id, optional payload compression and transmit policy.
+            uint8_t devID=0, compression=0;
+            transmit tx = {T_NODELAY, 0, 0, 0};
+            conf->getDeviceID(devID);
+            conf->getNetworkCompression(compression);
+            conf->getNetworkTransmit(tx);
+
+            // Get optional send rate budgets.
+            budget image = {0, 0}, telemetry = {0, 0};
+            shared_ptr<NW_Shaper> shaper;
+            if (conf->getNetworkShaping(image, telemetry))
+                shaper = createShaper(image, telemetry);
+
+            // Get optional TLS context, created once to resume sessions across respawns.
+            security tls;
+            if (conf->getNetworkSecurity(tls) && !this->tlsDeferred) {
+                this->tlsDeferred = createTLSContext(tls);
+                if (!this->tlsDeferred)
+                    return msg;
+            }
+
+            // Create network communicator instance.
+            shared_ptr<NetworkCommunicator> comm = createDeferredComm(deferred, log, devID, compression, tx, shaper, this->tlsDeferred);
+
+            // If comm does not point to null, communicator creation was successful.
+            if (comm) {
+
+                // Observe child, it is driven by the network module's reactor.
+                comm->attachObserver(&(this->nw));
+
+                // Append network communicator to network module.
+                if (this->nw.com_append(comm)){
+                    printErr(INIT_ERR_DEV_APPEND, "communicator");
+                    return msg;
+                }
+
+            } else return msg;
             break;
+        }
         default:
             break;
         }
@@ -539,14 +658,29 @@ shared_ptr<Message_M2M> Initializer::processMsg(shared_ptr<Message_M2M> msg) {
  *  Creates and sets up a network communicator instance.
  *  The instance connects over network interface 'iface' to server at 'addr' on port 'port'.
  *
+ *  If 'compression' is set, payloads are compressed with this deflate level, once the server accepts it.
+ *  If 'media' is set, image and stream fragments are sent as datagrams to this UDP port of the server.
+ *  If 'window' is set, payloads are kept until the server acknowledges them, at most 'window' at once.
+ *  If 'stream' is set, video stream fragments are offered to the server and sent once it accepts them.
+ *  The server connection batches and buffers according to 'tx'.
+ *  If 'shaper' is set, it limits the send rate of images and telemetry.
+ *  If 'tls' is set, the server connection is encrypted, the media channel is not.
+ *
  *  \param addr Server address (IP or domain name).
  *  \param port Server port to connect to.
  *  \param iface Network interface to use for connection.
+ *  \param media Server port of the media channel, empty for none.
  *  \param commID Identifier of this network communicator.
  *  \param devID Id of this obu.
+ *  \param compression Deflate level of payloads, 0 for none.
+ *  \param window Number of unacknowledged payloads in flight, 0 for no acknowledgements.
+ *  \param stream Whether a stream encoder is set up.
+ *  \param tx Transmit policy of the server connection.
+ *  \param shaper Send rate limit, empty for none.
+ *  \param tls TLS context of the server connection, empty for none.
  *  \return Shared pointer to freshly created network communicator instance..
  */
-shared_ptr<NetworkCommunicator> Initializer::createComm(string addr, string port, string iface, uint8_t commID, uint8_t devID) {
+shared_ptr<NetworkCommunicator> Initializer::createComm(string addr, string port, string iface, string media, uint8_t commID, uint8_t devID, uint8_t compression, uint16_t window, bool stream, transmit tx, shared_ptr<NW_Shaper> shaper, shared_ptr<NW_TLSContext> tls) {
 
     shared_ptr<NetworkCommunicator> result;
 
@@ -557,25 +691,161 @@ shared_ptr<NetworkCommunicator> Initializer::createComm(string addr, string port
             addr,
             port,
             iface));
+    setUpTransmit(interface, tx);
 
-    uint16_t status = 0;
-
-    // Initialize server connection.
-    if ((status=interface->initialize())) {
+    // Initialize server connection, the communicator retries if the server is not reachable yet.
+    bool connected = !interface->initialize();
+    if (!connected)
         printErr(INIT_ERR_DEV_SETUP, "server");
+
+    // Processor instances for building up data frames.
+    shared_ptr<ProcDataFrame> frame(new ProcDataFrame);
+    shared_ptr<ProcPayload> payload(new ProcPayload(devID, PROTOCOL_ASCII,
+            (compression ? FEATURE_COMPRESS : 0) | (window ? FEATURE_ACK : 0) | (stream ? FEATURE_STREAM : 0)));
+    payload->setShaper(shaper);
+
+    // Optional media channel, sending datagrams which are dropped rather than sent late.
+    if (media.length()) {
+
+        shared_ptr<NW_SocketInterface> datagrams(new NW_SocketInterface(
+                AF_UNSPEC,
+                SOCK_DGRAM,
+                addr,
+                media,
+                iface));
+
+        if (datagrams->initialize()) {
+            printErr(INIT_ERR_DEV_SETUP, "media channel");
+            return result;
+        }
+
+        shared_ptr<ProcDatagram> sequencer(new ProcDatagram);
+        sequencer->setSuccessor(datagrams);
+        payload->setMediaChannel(sequencer);
+    }
+
+    // Optional compression, offered to the server on registration.
+    shared_ptr<ProcCompress> compress;
+    if (compression) {
+        compress = shared_ptr<ProcCompress>(new ProcCompress(compression));
+        if (compress->initialize()) {
+            printErr(INIT_ERR_DEV_SETUP, "compression");
+            return result;
+        }
+    }
+
+    // Optional acknowledgements, offered to the server on registration.
+    shared_ptr<ProcAck> ack;
+    if (window)
+        ack = shared_ptr<ProcAck>(new ProcAck(window));
+
+    // Optional encryption, the handshake starts with the first flush.
+    shared_ptr<ProcTLS> secure;
+    if (tls) {
+        secure = shared_ptr<ProcTLS>(new ProcTLS(tls, addr));
+        if (secure->initialize()) {
+            printErr(INIT_ERR_DEV_SETUP, "tls");
+            return result;
+        }
+    }
+
+    // Network communicator instance.
+    result = shared_ptr<NetworkCommunicator>(new NetworkCommunicator(commID));
+
+    // Append Frame processors
+    if (!result->appenProc(payload) ||
+            (compress && !result->appenProc(compress)) ||
+            (ack && !result->appenProc(ack)) ||
+            !result->appenProc(frame) ||
+            (secure && !result->appenProc(secure)) ||
+            !result->appenProc(interface)) {
+        printErr(INIT_ERR_DEV_APPEND, "frame processor");
+        return shared_ptr<NetworkCommunicator>();
+    }
+
+    if (!connected)
+        result->fail();
+
+    return result;
+}
+
+/** \brief Create store-and-forward communicator instance.
+ *
+ *  Creates and sets up a network communicator instance, which stores its data in a segment log
+ *  below 'log.path' and requests a data acquisition every 'log.interval' seconds.
+ *  The log is uploaded to server 'serv' whenever it is reachable.
+ *
+ *  Stored frames can't wait for negotiation, so if 'compression' is set, they are compressed right away.
+ *  If 'shaper' is set, the upload is limited to its image budget.
+ *  If 'tls' is set, the upload is encrypted.
+ *
+ *  \param serv Server to upload to.
+ *  \param log Log directory and acquisition interval.
+ *  \param devID Id of this obu.
+ *  \param compression Deflate level of payloads, 0 for none.
+ *  \param tx Transmit policy of the server connection.
+ *  \param shaper Upload rate limit, empty for none.
+ *  \param tls TLS context of the server connection, empty for none.
+ *  \return Shared pointer to freshly created network communicator instance..
+ */
+shared_ptr<NetworkCommunicator> Initializer::createDeferredComm(server serv, storage log, uint8_t devID, uint8_t compression, transmit tx, shared_ptr<NW_Shaper> shaper, shared_ptr<NW_TLSContext> tls) {
+
+    shared_ptr<NetworkCommunicator> result;
+
+    // Socket interface, connected by the log as soon as there is something to upload.
+    shared_ptr<NW_SocketInterface> interface(new NW_SocketInterface(
+            AF_UNSPEC,
+            SOCK_STREAM,
+            serv.target,
+            serv.port,
+            serv.iface));
+    setUpTransmit(interface, tx);
+
+    // Open segment log.
+    shared_ptr<ProcSegmentLog> segments(new ProcSegmentLog(log.path));
+    if (segments->initialize()) {
+        printErr(INIT_ERR_DEV_SETUP, "deferred log");
         return result;
     }
+    segments->setShaper(shaper);
+
+    // Optional encryption, set up with each connection of the log.
+    shared_ptr<ProcTLS> secure;
+    if (tls) {
+        secure = shared_ptr<ProcTLS>(new ProcTLS(tls, serv.target));
+        if (secure->initialize()) {
+            printErr(INIT_ERR_DEV_SETUP, "tls");
+            return result;
+        }
+    }
 
     // Processor instances for building up data frames.
+    // Stored frames can't wait for protocol negotiation, so they use the binary protocol right away.
+    // The log offers acknowledged uploads, so it only drops data the server received.
     shared_ptr<ProcDataFrame> frame(new ProcDataFrame);
-    shared_ptr<ProcPayload> payload(new ProcPayload(devID));
+    shared_ptr<ProcPayload> payload(new ProcPayload(devID, PROTOCOL_BINARY,
+            FEATURE_LOG_ACK | (compression ? FEATURE_COMPRESS : 0)));
+
+    // Optional compression, without waiting for the server.
+    shared_ptr<ProcCompress> compress;
+    if (compression) {
+        compress = shared_ptr<ProcCompress>(new ProcCompress(compression, false));
+        if (compress->initialize()) {
+            printErr(INIT_ERR_DEV_SETUP, "compression");
+            return result;
+        }
+    }
 
     // Network communicator instance.
-    result = shared_ptr<NetworkCommunicator>(new NetworkCommunicator(commID));
+    result = shared_ptr<NetworkCommunicator>(new NetworkCommunicator(NW_TYPE_DEFERRED));
+    result->setAcquireInterval(log.interval*1000);
 
     // Append Frame processors
     if (!result->appenProc(payload) ||
+            (compress && !result->appenProc(compress)) ||
             !result->appenProc(frame) ||
+            !result->appenProc(segments) ||
+            (secure && !result->appenProc(secure)) ||
             !result->appenProc(interface)) {
         printErr(INIT_ERR_DEV_APPEND, "frame processor");
         return shared_ptr<NetworkCommunicator>();
@@ -583,3 +853,71 @@ shared_ptr<NetworkCommunicator> Initializer::createComm(string addr, string port
 
     return result;
 }
+
+/** \brief Apply transmit policy to server connection.
+ *
+ *  Maps the configured batching mode to the socket interface and sizes its socket buffers
+ *  to the bandwidth-delay product of the link, if bandwidth and round trip time are known.
+ *  Must be called before the interface is initialized.
+ *
+ *  \param interface The socket interface of the server connection.
+ *  \param tx Configured transmit policy.
+ */
+void Initializer::setUpTransmit(shared_ptr<NW_SocketInterface> interface, transmit tx) {
+
+    uint8_t batching;
+    switch (tx.mode) {
+    case T_CORK:
+        batching = TX_CORK;
+        break;
+    case T_MORE:
+        batching = TX_MORE;
+        break;
+    default:
+        batching = TX_NODELAY;
+        break;
+    }
+
+    // Bandwidth in kbit/s times round trip time in ms gives bits in flight.
+    uint64_t bufferSize = (uint64_t)tx.bandwidth * tx.rtt / 8;
+    if (bufferSize > INT32_MAX)
+        bufferSize = INT32_MAX;
+
+    interface->setTransmit(batching, bufferSize, tx.lowat);
+}
+
+/** \brief Create send rate limit.
+ *
+ *  Creates a shaper with the budgets 'image' and 'telemetry', converted from kbit/s and kB.
+ *
+ *  \param image Budget of image traffic.
+ *  \param telemetry Budget of telemetry traffic.
+ *  \return Shared pointer to freshly created shaper instance.
+ */
+shared_ptr<NW_Shaper> Initializer::createShaper(budget image, budget telemetry) {
+
+    shared_ptr<NW_Shaper> result(new NW_Shaper);
+    result->setBudget(SHAPE_IMAGE, image.rate*125, image.burst*1000);
+    result->setBudget(SHAPE_TELEMETRY, telemetry.rate*125, telemetry.burst*1000);
+
+    return result;
+}
+
+/** \brief Create TLS context.
+ *
+ *  Creates a TLS context trusting the certificates of 'tls', for the connections to one server.
+ *
+ *  \param tls Configured TLS settings.
+ *  \return Shared pointer to freshly created TLS context, empty in case of an error.
+ */
+shared_ptr<NW_TLSContext> Initializer::createTLSContext(security tls) {
+
+    shared_ptr<NW_TLSContext> result(new NW_TLSContext);
+
+    if (result->initialize(tls.caFile, tls.offload)) {
+        printErr(INIT_ERR_DEV_SETUP, "tls context");
+        return shared_ptr<NW_TLSContext>();
+    }
+
+    return result;
+}
@@ -33,10 +33,17 @@
 // Image handling classes.
 #include "img-handling/ImgCapture.h"
 #include "img-handling/OpPrepare.h"
+#include "img-handling/OpEncodeStream.h"
 #include "img-handling/OpCurveDetection.h"
+#include "img-handling/OpMotionGate.h"
 
 // Network handling classes.
 #include "nw-handling/NW_SocketInterface.h"
+#include "nw-handling/ProcAck.h"
+#include "nw-handling/ProcCompress.h"
+#include "nw-handling/ProcDatagram.h"
+#include "nw-handling/ProcSegmentLog.h"
+#include "nw-handling/ProcTLS.h"
 
 #include <memory>
 #include <unistd.h>
@@ -81,13 +88,39 @@ private:
     ModuleImgProcessing proc;   // Image processing module.
     ModuleNetworking nw;    // Network processing module.
 
+    // TLS contexts of the server connections, kept across respawns to resume sessions.
+    shared_ptr<NW_TLSContext> tlsRealtime, tlsDeferred;
+
     static void printErr(uint8_t status, string location);  // Print setup error messages.
     static shared_ptr<NetworkCommunicator> createComm(
             string addr,
             string port,
             string iface,
+            string media,
             uint8_t commID,
-            uint8_t devID); // Create network communication instance.
+            uint8_t devID,
+            uint8_t compression,
+            uint16_t window,
+            bool stream,
+            transmit tx,
+            shared_ptr<NW_Shaper> shaper,
+            shared_ptr<NW_TLSContext> tls); // Create network communication instance.
+    static shared_ptr<NetworkCommunicator> createDeferredComm(
+            server serv,
+            storage log,
+            uint8_t devID,
+            uint8_t compression,
+            transmit tx,
+            shared_ptr<NW_Shaper> shaper,
+            shared_ptr<NW_TLSContext> tls); // Create store-and-forward communication instance.
+    static void setUpTransmit(
+            shared_ptr<NW_SocketInterface> interface,
+            transmit tx); // Apply transmit policy to server connection.
+    static shared_ptr<NW_Shaper> createShaper(
+            budget image,
+            budget telemetry); // Create send rate limit.
+    static shared_ptr<NW_TLSContext> createTLSContext(
+            security tls); // Create TLS context of server connections.
 
 };
 
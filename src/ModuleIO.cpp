@@ -30,24 +30,57 @@ ModuleIO::~ModuleIO() { }
 /** \brief Count messages from module children.
  *
  *  Counts incoming messages from children.
- *  Since ModuleIO has no children creating any message, this function returns 0.
+ *  Only the sensor handler creates messages, carrying batches of motion samples.
  *
  *  \return Number of child messages.
  */
 uint8_t ModuleIO::countMsgFromChildren() {
-    return 0;
+
+    if (!this->sensors) return 0;
+    return this->sensors->in_count();
 }
 
 /** \brief Polls messages from module children.
  *
  *  Polls incoming messages from children and counts the polled messages.
  *  This method implements child-module communication.
- *  Since ModuleIO has no children creating any message, this function returns 0.
+ *  Sample batches of the sensor handler are passed on to the message hub.
  *
  *  \return Number of polled child messages.
  */
 uint8_t ModuleIO::pollMsgFromChildren() {
-    return 0;
+
+    // Return value.
+    uint8_t result = 0;
+
+    if (!this->sensors) return result;
+
+    // Do while there are pending messages from sensor handler.
+    while (this->sensors->in_count()) {
+
+        // Get next message.
+        shared_ptr<Message_M2C> next = this->sensors->in_pop();
+        result++;
+
+        // Switch incoming message type.
+        switch (next->getType()) {
+        case MSG_SAMPLES:
+        {
+            // Send sample batch to message hub.
+            shared_ptr<Value> samples;
+            next->getValue(ARG_SAMPLES, samples);
+
+            shared_ptr<M2M_Samples> batch(new M2M_Samples);
+            batch->setValue(ARG_SAMPLES, samples);
+            MsgHub::getInstance()->appendMsg(batch);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return result;
 }
 
 /** \brief Sets member for sensor io.
@@ -60,27 +93,26 @@ void ModuleIO::setSensorIO(shared_ptr<SensorIO> sensors) {
     this->sensors=sensors;
 }
 
-/** \brief Helper method for creating string values.
+/** \brief Helper method for creating numeric values.
  *
- *  Returns a ValiString instance based on the key 'string', which is searched in 'data'.
+ *  Returns a ValDouble instance based on the key 'string', which is searched in 'data'.
+ *  Missing values are NAN.
  *
  *  \param data Field with key-value pairs.
- *  \param string the key to get the resulting ValString for.
- *  \return ValString instance with the value.
+ *  \param string the key to get the resulting ValDouble for.
+ *  \return ValDouble instance with the value.
  */
-shared_ptr<ValString> ModuleIO::createValue(unordered_map<string, string> &data, string string) {
+shared_ptr<ValDouble> ModuleIO::createValue(unordered_map<string, double> &data, string string) {
 
     // Initialize result value
-    shared_ptr<ValString> result(new ValString("--"));
+    shared_ptr<ValDouble> result(new ValDouble(NAN));
 
     // Find key 'string'.
     auto dataIt = data.find(string);
 
-    // Key found and value not empty, set up result.
-    if (dataIt != data.end() && dataIt->second.length() > 0) {
-        cerr << dataIt->second;
+    // Key found, set up result.
+    if (dataIt != data.end())
         result->setValue(dataIt->second);
-    }
 
     return result;
 }
@@ -106,7 +138,7 @@ shared_ptr<Message_M2M> ModuleIO::processMsg(shared_ptr<Message_M2M> msg) {
     {
         // Get sensor data.
         shared_ptr<M2M_DataSet> instance = dynamic_pointer_cast<M2M_DataSet>(msg);
-        unordered_map<string, string> data = this->sensors->getData();
+        unordered_map<string, double> data = this->sensors->getData();
 
         // Set position values.
         instance->setValue(ARG_POS_N, this->createValue(data, GPS_POS_LAT));
@@ -146,7 +178,7 @@ shared_ptr<Message_M2M> ModuleIO::processMsg(shared_ptr<Message_M2M> msg) {
     {
         // Get sensor data.
         shared_ptr<M2M_EventDataSet> instance = dynamic_pointer_cast<M2M_EventDataSet>(msg);
-        unordered_map<string, string> data = this->sensors->getData();
+        unordered_map<string, double> data = this->sensors->getData();
 
         // Set position values.
         instance->setValue(ARG_POS_N, this->createValue(data, GPS_POS_LAT));
@@ -27,7 +27,7 @@ protected:
     // Config conf;
     shared_ptr<SensorIO> sensors;
 
-    shared_ptr<ValString> createValue(unordered_map<string, string> &data, string string);
+    shared_ptr<ValDouble> createValue(unordered_map<string, double> &data, string string);
 
     virtual uint8_t countMsgFromChildren();
     virtual uint8_t pollMsgFromChildren();
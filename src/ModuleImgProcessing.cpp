@@ -143,6 +143,12 @@ shared_ptr<Message_M2M> ModuleImgProcessing::processMsg(shared_ptr<Message_M2M>
                 set->setValue(ARG_IMG, jpegImg);
             }
 
+            // Try getting video stream, collected since the last acquisition.
+            // Stays empty if no stream encoder is set up.
+            shared_ptr<Value> streamResult;
+            if (!prep_Exe->getResult(RES_ENCODED_STREAM, streamResult))
+                set->setValue(ARG_STREAM, streamResult);
+
             // Preparator not found, set empty image.
         } else set->setValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar(tmp)));
 
@@ -217,6 +223,16 @@ shared_ptr<Message_M2M> ModuleImgProcessing::processMsg(shared_ptr<Message_M2M>
             prep_Exe->setValue(active, active_Val);
             break;
         }
+        case CMD_STREAM_ACTIVE:
+        case CMD_STREAM_INACTIVE: {
+
+            // Encode the video stream only while the server subscribes to it.
+            shared_ptr<ImgOpExecutor> prep_Exe = this->executors.find(PREPARE)->second;
+            shared_ptr<ValInt> active_Val(new ValInt(cmdType->getValue() == CMD_STREAM_ACTIVE));
+            string active = ARG_STREAM_ACTIVE;
+            prep_Exe->setValue(active, active_Val);
+            break;
+        }
         default:
             break;
         }
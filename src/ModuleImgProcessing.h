@@ -12,6 +12,7 @@
 
 #include "Module.h"
 #include "img-handling/OpPrepare.h"
+#include "img-handling/OpEncodeStream.h"
 #include "img-handling/ImgOpExecutor.h"
 
 #include <string>
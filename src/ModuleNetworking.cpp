@@ -11,13 +11,19 @@
 /** \brief Constructor.
  *
  *  Default Constructor of ModuleNetworking instances.
- *  Registers for messages regarding termination, commands and data acquisition.
+ *  Registers for messages regarding termination, commands, data acquisition and sample batches.
+ *  Creates the reactor driving all communicators, which runs as child of this module.
  */
 ModuleNetworking::ModuleNetworking() {
 
+    // Create network event loop.
+    this->reactor = shared_ptr<NW_Reactor>(new NW_Reactor);
+    this->addChild(this->reactor);
+
     // Register for message types.
     MsgHub::getInstance()->attachObserverToMsg(this, MSG_DATA_COMPLETE);
     MsgHub::getInstance()->attachObserverToMsg(this, MSG_EVENT);
+    MsgHub::getInstance()->attachObserverToMsg(this, MSG_SAMPLES);
     MsgHub::getInstance()->attachObserverToMsg(this, MSG_TERM_BROADCAST);
 }
 
@@ -40,9 +46,11 @@ uint8_t ModuleNetworking::com_append(shared_ptr<NetworkCommunicator> communicato
     // NetworkCommunicator reference must be valid and key not empty.
     if (!communicator) return NW_MOD_ERR_INVALID_REFERENCE;
 
-    // Add communicator to list.
+    // Add communicator to list and let the reactor drive it.
     this->communicators.push_back(communicator);
     this->attachChildToMsg(communicator, MSG_EVENT);
+    this->attachChildToMsg(communicator, MSG_SAMPLES);
+    this->reactor->attach(communicator);
     return NW_MOD_OK;
 }
 
@@ -62,7 +70,9 @@ void ModuleNetworking::com_delete(shared_ptr<NetworkCommunicator> com) {
 
         if (*it == com) {
             this->detachChildFromMsg(*it, MSG_EVENT);
-            this->communicators.erase(it);
+            this->detachChildFromMsg(*it, MSG_SAMPLES);
+            this->reactor->detach(*it);
+            it = this->communicators.erase(it);
         } else
             it++;
     }
@@ -74,9 +84,24 @@ void ModuleNetworking::com_delete(shared_ptr<NetworkCommunicator> com) {
  *  Completely clears list of network communicator instances.
  */
 void ModuleNetworking::com_clear() {
+
+    for (auto comm : this->communicators)
+        this->reactor->detach(comm);
+
     this->communicators.clear();
 }
 
+/** \brief Sets statistics query path.
+ *
+ *  Lets the reactor answer statistics queries on the local socket at 'path'.
+ *  Must be called before the module runs.
+ *
+ *  \param path Absolute path of the socket.
+ */
+void ModuleNetworking::setQueryPath(string path) {
+    this->reactor->setQueryPath(path);
+}
+
 /** \brief Counts messages of children.
  *
  *  Counts the pending messages of all managed NetworkCommunicator instances
@@ -209,8 +234,9 @@ shared_ptr<Message_M2M> ModuleNetworking::processMsg(shared_ptr<Message_M2M> msg
     case MSG_DATA_COMPLETE:
     {
         // Get values from M2M message (navigation data).
-        shared_ptr<Value> image, posE, posN, posH, accX, accY, accZ, gyroX, gyroY, gyroZ;
+        shared_ptr<Value> image, stream, posE, posN, posH, accX, accY, accZ, gyroX, gyroY, gyroZ;
         msg->getValue(ARG_IMG, image);
+        msg->getValue(ARG_STREAM, stream);
         msg->getValue(ARG_POS_E, posE);
         msg->getValue(ARG_POS_N, posN);
         msg->getValue(ARG_POS_H, posH);
@@ -241,6 +267,9 @@ shared_ptr<Message_M2M> ModuleNetworking::processMsg(shared_ptr<Message_M2M> msg
         else
             outData->setValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
 
+        if (stream)
+            outData->setValue(ARG_STREAM, stream);
+
         // Set values for M2C message (navigation data).
         outData->setValue(ARG_POS_E, posE);
         outData->setValue(ARG_POS_N, posN);
@@ -265,6 +294,9 @@ shared_ptr<Message_M2M> ModuleNetworking::processMsg(shared_ptr<Message_M2M> msg
         outData->setValue(ARG_OBD_ENG_KM, engKM);
         outData->setType(MSG_DATA_COMPLETE);
 
+        // Encoded once, shared by all communicators.
+        outData->createValue(ARG_ENCODED, shared_ptr<SharedPayload>(new SharedPayload));
+
         // Get child iterator to distribute message to children.
         auto childIt = this->getChildrenBegin(MSG_DATA_COMPLETE);
 
@@ -296,6 +328,7 @@ shared_ptr<Message_M2M> ModuleNetworking::processMsg(shared_ptr<Message_M2M> msg
         event->setValue(ARG_POS_E, posE);
         event->setValue(ARG_POS_N, posN);
         event->setValue(ARG_EVT_TYPE, type);
+        event->createValue(ARG_ENCODED, shared_ptr<SharedPayload>(new SharedPayload));
 
         // Get child iterator to distribute message to children.
         auto childIt = this->getChildrenBegin(MSG_EVENT);
@@ -311,6 +344,27 @@ shared_ptr<Message_M2M> ModuleNetworking::processMsg(shared_ptr<Message_M2M> msg
 
         break;
     }
+    case MSG_SAMPLES:
+    {
+        // Set values for M2C message.
+        shared_ptr<Value> samples;
+        msg->getValue(ARG_SAMPLES, samples);
+
+        shared_ptr<M2C_Samples> batch(new M2C_Samples);
+        batch->setValue(ARG_SAMPLES, samples);
+        batch->createValue(ARG_ENCODED, shared_ptr<SharedPayload>(new SharedPayload));
+
+        // Distribute sample batch to all children.
+        auto childIt = this->getChildrenBegin(MSG_SAMPLES);
+        while (childIt != this->getChildrenEnd(MSG_SAMPLES)) {
+
+            shared_ptr<NetworkCommunicator> comm = dynamic_pointer_cast<NetworkCommunicator>(*childIt);
+            comm->out_push(dynamic_pointer_cast<Message_M2C>(batch));
+            childIt++;
+        }
+
+        break;
+    }
     case MSG_TERM_BROADCAST:
     {
         this->terminate();
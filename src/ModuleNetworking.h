@@ -11,6 +11,7 @@
 #include "msg-handling/Msg.h"
 #include "msg-handling/MsgHub.h"
 #include "nw-handling/NetworkCommunicator.h"
+#include "nw-handling/NW_Reactor.h"
 #include "nw-handling/NW_SocketInterface.h"
 #include "nw-handling/ProcPayload.h"
 #include "nw-handling/ProcDataFrame.h"
@@ -33,9 +34,11 @@ public:
     uint8_t com_append(shared_ptr<NetworkCommunicator> executor);
     void com_delete(shared_ptr<NetworkCommunicator> com);
     void com_clear();
+    void setQueryPath(string path);
 
 protected:
     vector<shared_ptr<NetworkCommunicator>> communicators;
+    shared_ptr<NW_Reactor> reactor;
 
     virtual uint8_t countMsgFromChildren();
     virtual uint8_t pollMsgFromChildren();
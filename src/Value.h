@@ -22,7 +22,8 @@ typedef enum {
     VAL_MAT,
     VAL_INT,
     VAL_STRING,
-    VAL_UCHAR_VECTOR
+    VAL_UCHAR_VECTOR,
+    VAL_SHARED_PAYLOAD
 }valType;
 
 // Abstract Value parent.
@@ -135,11 +135,14 @@ uint8_t OpAcceleration::process(shared_ptr<Message_M2C> message) {
         if (message->getValue(ARG_ACC_Z, accZ_Value))
             return NO_EVENT;
 
-        // Cast number from values.
-        int16_t accX=0, accY=0, accZ=0;
-        istringstream ( dynamic_pointer_cast<ValString>(accX_Value)->getValue() ) >> accX;
-        istringstream ( dynamic_pointer_cast<ValString>(accY_Value)->getValue() ) >> accY;
-        istringstream ( dynamic_pointer_cast<ValString>(accZ_Value)->getValue() ) >> accZ;
+        // Get numbers from values, skip sets without sensor data.
+        double rawAccX = dynamic_pointer_cast<ValDouble>(accX_Value)->getValue();
+        double rawAccY = dynamic_pointer_cast<ValDouble>(accY_Value)->getValue();
+        double rawAccZ = dynamic_pointer_cast<ValDouble>(accZ_Value)->getValue();
+        if (isnan(rawAccX) || isnan(rawAccY) || isnan(rawAccZ))
+            return NO_EVENT;
+
+        int16_t accX=rawAccX, accY=rawAccY, accZ=rawAccZ;
 
         int32_t minuX = (int32_t)accX - (int32_t)oldAccX;
         int32_t accXDiff = ABS(minuX);
@@ -191,11 +194,14 @@ uint8_t OpGyroscope::process(shared_ptr<Message_M2C> message) {
         if (message->getValue(ARG_GYRO_Z, gyroZ_Value))
             return NO_EVENT;
 
-        // Cast number from values.
-        int16_t gyroX=0, gyroY=0, gyroZ=0;
-        istringstream ( dynamic_pointer_cast<ValString>(gyroX_Value)->getValue() ) >> gyroX;
-        istringstream ( dynamic_pointer_cast<ValString>(gyroY_Value)->getValue() ) >> gyroY;
-        istringstream ( dynamic_pointer_cast<ValString>(gyroZ_Value)->getValue() ) >> gyroZ;
+        // Get numbers from values, skip sets without sensor data.
+        double rawGyroX = dynamic_pointer_cast<ValDouble>(gyroX_Value)->getValue();
+        double rawGyroY = dynamic_pointer_cast<ValDouble>(gyroY_Value)->getValue();
+        double rawGyroZ = dynamic_pointer_cast<ValDouble>(gyroZ_Value)->getValue();
+        if (isnan(rawGyroX) || isnan(rawGyroY) || isnan(rawGyroZ))
+            return NO_EVENT;
+
+        int16_t gyroX=rawGyroX, gyroY=rawGyroY, gyroZ=rawGyroZ;
 
         int32_t minuX = (int32_t)gyroX - (int32_t)oldGyroX;
         int32_t gyroXDiff = ABS(minuX);
@@ -20,6 +20,8 @@ typedef enum {
 
 #include "../Child.h"
 
+#include <cmath>
+
 #include <unistd.h>
 
 class EvtOperator {
@@ -0,0 +1,246 @@
+/** \brief      Per-frame context for image operators.
+ *
+ * \details     Holds the captures and intermediate results of one frame in typed slots.
+ *              Operators resolve their input and result slots once, when bound to the
+ *              frame, and access them by index while processing.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       ImgFrame
+ */
+
+#include "ImgFrame.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of ImgFrame instances.
+ */
+ImgFrame::ImgFrame() {
+    this->captureCount = 0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of ImgFrame instances.
+ */
+ImgFrame::~ImgFrame() { }
+
+/** \brief Reset slot layout.
+ *
+ *  Drops all slots and reserves the first 'captureCount' mat slots for captures.
+ *  Operators have to be bound again afterwards.
+ *
+ *  \param captureCount Number of capture slots.
+ */
+void ImgFrame::reset(uint8_t captureCount) {
+
+    this->captureCount = captureCount;
+
+    this->mats.assign(captureCount, shared_ptr<cv::Mat>());
+    this->bytes.clear();
+    this->bytesDropped.clear();
+    this->doubles.clear();
+    this->doublesSet.clear();
+}
+
+/** \brief Getter for capture count.
+ *
+ *  Returns the number of mat slots reserved for captures.
+ *
+ *  \return capture count.
+ */
+uint8_t ImgFrame::getCaptureCount() {
+    return this->captureCount;
+}
+
+/** \brief Allocate slot.
+ *
+ *  Allocates a new slot of type 'type', which may be VAL_MAT, VAL_UCHAR_VECTOR or VAL_DOUBLE.
+ *  Returns the slot reference, its index is 0xFF in case of errors.
+ *
+ *  \param type Value type of the slot.
+ *  \return Reference to the new slot.
+ */
+imgSlot ImgFrame::allocate(uint8_t type) {
+
+    imgSlot slot = { type, 0xFF, false };
+
+    switch (type) {
+    case VAL_MAT:
+        if (this->mats.size() < 0xFF) {
+            slot.index = this->mats.size();
+            this->mats.push_back(shared_ptr<cv::Mat>());
+        }
+        break;
+    case VAL_UCHAR_VECTOR:
+        if (this->bytes.size() < 0xFF) {
+            slot.index = this->bytes.size();
+            this->bytes.push_back(shared_ptr<vector<uint8_t>>());
+            this->bytesDropped.push_back(false);
+        }
+        break;
+    case VAL_DOUBLE:
+        if (this->doubles.size() < 0xFF) {
+            slot.index = this->doubles.size();
+            this->doubles.push_back(0);
+            this->doublesSet.push_back(false);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return slot;
+}
+
+/** \brief Getter for mat slot.
+ *
+ *  Returns the mat stored at slot 'index', NULL if unset.
+ *
+ *  \param index Slot index.
+ *  \return Stored mat.
+ */
+shared_ptr<cv::Mat> ImgFrame::getMat(uint8_t index) {
+
+    if (index < this->mats.size())
+        return this->mats[index];
+
+    return shared_ptr<cv::Mat>();
+}
+
+/** \brief Setter for mat slot.
+ *
+ *  Stores 'mat' at slot 'index'.
+ *
+ *  \param index Slot index.
+ *  \param mat Mat to store.
+ */
+void ImgFrame::setMat(uint8_t index, const shared_ptr<cv::Mat> &mat) {
+
+    if (index < this->mats.size())
+        this->mats[index] = mat;
+}
+
+/** \brief Getter for byte slot.
+ *
+ *  Returns the byte vector stored at slot 'index', NULL if unset.
+ *
+ *  \param index Slot index.
+ *  \return Stored byte vector.
+ */
+shared_ptr<vector<uint8_t>> ImgFrame::getBytes(uint8_t index) {
+
+    if (index < this->bytes.size())
+        return this->bytes[index];
+
+    return shared_ptr<vector<uint8_t>>();
+}
+
+/** \brief Setter for byte slot.
+ *
+ *  Stores 'bytes' at slot 'index'.
+ *
+ *  \param index Slot index.
+ *  \param bytes Byte vector to store.
+ */
+void ImgFrame::setBytes(uint8_t index, const shared_ptr<vector<uint8_t>> &bytes) {
+
+    if (index < this->bytes.size())
+        this->bytes[index] = bytes;
+}
+
+/** \brief Checks for dropped bytes.
+ *
+ *  Returns whether the results of byte slot 'index' got dropped unread, so the operator
+ *  producing them can e.g. restart a stream, whose later results depend on the dropped ones.
+ *
+ *  \param index Slot index.
+ *  \return true if results got dropped, false otherwise.
+ */
+bool ImgFrame::isDropped(uint8_t index) {
+    return index < this->bytesDropped.size() && this->bytesDropped[index];
+}
+
+/** \brief Marks dropped bytes.
+ *
+ *  Marks the results of byte slot 'index' as dropped, or clears the mark once handled.
+ *
+ *  \param index Slot index.
+ *  \param dropped Whether results got dropped.
+ */
+void ImgFrame::setDropped(uint8_t index, bool dropped) {
+
+    if (index < this->bytesDropped.size())
+        this->bytesDropped[index] = dropped;
+}
+
+/** \brief Getter for double slot.
+ *
+ *  Writes the double stored at slot 'index' to 'target'.
+ *
+ *  \param index Slot index.
+ *  \param target Target to write the value to.
+ *  \return true if the slot is set, false otherwise.
+ */
+bool ImgFrame::getDouble(uint8_t index, double &target) {
+
+    if (index < this->doubles.size() && this->doublesSet[index]) {
+        target = this->doubles[index];
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Setter for double slot.
+ *
+ *  Stores 'value' at slot 'index'.
+ *
+ *  \param index Slot index.
+ *  \param value Value to store.
+ */
+void ImgFrame::setDouble(uint8_t index, double value) {
+
+    if (index < this->doubles.size()) {
+        this->doubles[index] = value;
+        this->doublesSet[index] = true;
+    }
+}
+
+/** \brief Wrap slot content.
+ *
+ *  Wraps the content of slot 'slot' into a new Value instance.
+ *  Used for handing results to other modules, not on the per-frame path.
+ *
+ *  \param slot Slot to wrap.
+ *  \return New Value instance, NULL if the slot is unset.
+ */
+shared_ptr<Value> ImgFrame::toValue(imgSlot slot) {
+
+    switch (slot.type) {
+    case VAL_MAT:
+    {
+        shared_ptr<cv::Mat> mat = getMat(slot.index);
+        if (mat)
+            return shared_ptr<ValMat>(new ValMat(mat));
+        break;
+    }
+    case VAL_UCHAR_VECTOR:
+    {
+        shared_ptr<vector<uint8_t>> buffer = getBytes(slot.index);
+        if (buffer)
+            return shared_ptr<ValVectorUChar>(new ValVectorUChar(buffer));
+        break;
+    }
+    case VAL_DOUBLE:
+    {
+        double value;
+        if (getDouble(slot.index, value))
+            return shared_ptr<ValDouble>(new ValDouble(value));
+        break;
+    }
+    default:
+        break;
+    }
+
+    return shared_ptr<Value>();
+}
@@ -0,0 +1,58 @@
+/*
+ * ImgFrame.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef IMGFRAME_H_
+#define IMGFRAME_H_
+
+#include "../Value.h"
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/** Typed slot reference, bound once when operators are set up.
+ *  Results of appending slots are accumulated over frames until they are read.
+ *  If they are dropped unread instead, the slot is marked, see ImgFrame::isDropped. */
+typedef struct imgSlot {
+    uint8_t type;
+    uint8_t index;
+    bool append;
+} imgSlot;
+
+class ImgFrame {
+public:
+    ImgFrame();
+    virtual ~ImgFrame();
+
+    void reset(uint8_t captureCount);
+    uint8_t getCaptureCount();
+    imgSlot allocate(uint8_t type);
+
+    shared_ptr<cv::Mat> getMat(uint8_t index);
+    void setMat(uint8_t index, const shared_ptr<cv::Mat> &mat);
+    shared_ptr<vector<uint8_t>> getBytes(uint8_t index);
+    void setBytes(uint8_t index, const shared_ptr<vector<uint8_t>> &bytes);
+    bool isDropped(uint8_t index);
+    void setDropped(uint8_t index, bool dropped);
+    bool getDouble(uint8_t index, double &target);
+    void setDouble(uint8_t index, double value);
+
+    shared_ptr<Value> toValue(imgSlot slot);
+
+private:
+    uint8_t captureCount;
+    vector<shared_ptr<cv::Mat>> mats;
+    vector<shared_ptr<vector<uint8_t>>> bytes;
+    vector<bool> bytesDropped;
+    vector<double> doubles;
+    vector<bool> doublesSet;
+};
+
+#endif /* IMGFRAME_H_ */
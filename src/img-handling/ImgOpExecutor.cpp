@@ -8,12 +8,12 @@
 
 #include "ImgOpExecutor.h"
 
-ResultContainer::ResultContainer() {}
-ResultContainer::~ResultContainer() {}
-
-ImgOpExecutor::ImgOpExecutor() { }
+ImgOpExecutor::ImgOpExecutor() {
+    this->bound = false;
+}
 
 ImgOpExecutor::ImgOpExecutor(shared_ptr<ImgCapture> &capture) {
+    this->bound = false;
     if (capture)
         this->imageCaptures.push_back(capture);
 }
@@ -35,6 +35,7 @@ uint8_t ImgOpExecutor::op_append(shared_ptr<ImgOperator> op) {
 
         if (op) {
             this->imageOperators.push_back(op);
+            this->bound = false;
             return EXEC_OK;
         }
 
@@ -65,6 +66,7 @@ uint8_t ImgOpExecutor::op_delete(shared_ptr<ImgOperator> op) {
 
             if (*delIt == op) {
                 this->imageOperators.erase(delIt);
+                this->bound = false;
                 return EXEC_OK;
             }
 
@@ -90,6 +92,7 @@ uint8_t ImgOpExecutor::op_delete(uint8_t index) {
 
         // Erase from list.
         this->imageOperators.erase(this->imageOperators.begin()+index);
+        this->bound = false;
         return EXEC_OK;
     }
 
@@ -104,6 +107,7 @@ void ImgOpExecutor::op_clear() {
 
     // Clear complete list.
     this->imageOperators.clear();
+    this->bound = false;
 }
 
 /** \brief Swaps image operators indices.
@@ -171,6 +175,7 @@ uint8_t ImgOpExecutor::cap_append(shared_ptr<ImgCapture> capture) {
 
         if (capture) {
             this->imageCaptures.push_back(capture);
+            this->bound = false;
             this->captureMutex.unlock();
             return EXEC_OK;
         }
@@ -206,6 +211,7 @@ uint8_t ImgOpExecutor::cap_delete(shared_ptr<ImgCapture> capture) {
 
             if (*delIt == capture) {
                 this->imageCaptures.erase(delIt);
+                this->bound = false;
                 this->captureMutex.unlock();
                 return EXEC_OK;
             }
@@ -235,6 +241,7 @@ uint8_t ImgOpExecutor::cap_delete(uint8_t index) {
 
         // Erase from list.
         this->imageCaptures.erase(this->imageCaptures.begin()+index);
+        this->bound = false;
         this->captureMutex.unlock();
         return EXEC_OK;
     }
@@ -253,6 +260,7 @@ void ImgOpExecutor::cap_clear() {
 
     // Clear complete list.
     this->imageCaptures.clear();
+    this->bound = false;
 
     this->captureMutex.unlock();
 
@@ -311,62 +319,45 @@ uint8_t ImgOpExecutor::cap_firstIndexOf(uint8_t captureID) {
 
 }
 
-/** \brief Sets result.
+/** \brief Gets result.
  *
- *  Sets the result value identified by 'identifier' to value 'target'.
- *  Creates the key-value pair, if not existing.
+ *  Gets the result value identified by 'identifier' from the most recent frame
+ *  and writes it to value 'target'. Accumulated results contain everything produced
+ *  since the last call and are reset by it.
  *  Returns status indicator.
  *
  *  \param identifier The result identifier.
- *  \param target The result value.
+ *  \param target The value instance to write the result to.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ImgOpExecutor::setResult(string identifier, shared_ptr<Value> &target) {
+uint8_t ImgOpExecutor::getResult(string identifier, shared_ptr<Value> &target) {
 
     this->producer.lock();
 
-    // Try setting value.
-    uint8_t status = this->results.setValue(identifier, target);
+    // Find slot of requested result.
+    auto slotIt = this->resultSlots.find(identifier);
 
-    // Not a valid key yet, so create it.
-    if (status == ERR_NO_SUCH_KEY) {
-        this->results.createValue(identifier, target);
-        this->producer.unlock();
-        return OK;
-    }
-    // Wrong type, so recreate key-value pair.
-    if (status == ERR_TYPE_MISMATCH) {
-        this->results.deleteKey(identifier);
-        this->results.createValue(identifier, target);
+    // No operator provides this result.
+    if (slotIt == this->resultSlots.end()) {
         this->producer.unlock();
-        return OK;
+        return ERR_NO_SUCH_KEY;
     }
 
-    this->producer.unlock();
-
-    return status;
-
-}
-
-/** \brief Gets result.
- *
- *  Gets the result value identified by 'identifier' and writes it to value 'target'.
- *  Returns status indicator.
- *
- *  \param identifier The result identifier.
- *  \param target The value instance to write the result to.
- *  \return 0 in case of success, an error code otherwise.
- */
-uint8_t ImgOpExecutor::getResult(string identifier, shared_ptr<Value> &target) {
-
-    this->producer.lock();
+    // Wrap slot content of most recent frame.
+    shared_ptr<Value> result = this->published.toValue(slotIt->second);
 
-    // Try getting value.
-    uint8_t status =  this->results.getValue(identifier, target);
+    // Accumulated results are handed out only once.
+    if (slotIt->second.append)
+        this->published.setBytes(slotIt->second.index, shared_ptr<vector<uint8_t>>());
 
     this->producer.unlock();
 
-    return status;
+    // Result was not produced yet.
+    if (!result)
+        return ERR_UNSET_VALUE;
+
+    target = result;
+    return OK;
 }
 
 /** \brief Sets value.
@@ -386,88 +377,139 @@ uint8_t ImgOpExecutor::setValue(string identifier, shared_ptr<Value> target) {
     auto opIt = this->imageOperators.begin();
 
     // Iterate list of execution.
-    while (opIt != this->imageOperators.end())
+    while (opIt != this->imageOperators.end()) {
 
         (*opIt)->setValue(identifier, target);
+        opIt++;
+    }
 
     this->producer.unlock();
 
     return OK;
 }
 
-/** \brief Executes image operations.
+/** \brief Binds operators to frame.
  *
- *  Iterates list of image operators executes their operations..
- *  Returns status indicator.
+ *  Resets the frame layout to the current captures and operators and lets every
+ *  operator allocate its result slots. Called whenever captures or operators change,
+ *  so the per-frame path only works on slot indices.
+ */
+void ImgOpExecutor::bind() {
+
+    // Reserve capture slots for all captures and all operator inputs.
+    uint8_t captureCount = this->imageCaptures.size();
+    for (auto opIt : this->imageOperators)
+        if (opIt->getCaptureCount() > captureCount)
+            captureCount = opIt->getCaptureCount();
+
+    this->producer.lock();
+
+    this->frame.reset(captureCount);
+    this->resultSlots.clear();
+
+    // Allocate result slots and collect them for lookup.
+    for (auto opIt : this->imageOperators) {
+        opIt->bind(this->frame);
+        opIt->getResultSlots(this->resultSlots);
+    }
+
+    this->published = this->frame;
+    this->bound = true;
+
+    this->producer.unlock();
+}
+
+/** \brief Publishes frame.
  *
- *  \return 0 in case of success, an error code otherwise.
+ *  Makes the results of the current frame available to getResult.
+ *  Results of appending slots are added to the data not read yet. Both get dropped once they
+ *  exceed MAX_PENDING_APPEND bytes and the slot is marked as dropped, so e.g. the stream encoder
+ *  continues with a keyframe, which can be decoded without the dropped data.
+ *  Has to be called with the producer mutex locked.
  */
-uint8_t ImgOpExecutor::execute() {
+void ImgOpExecutor::publish() {
 
-    try {
+    for (auto slotIt : this->resultSlots) {
 
-        uint8_t resultCount = 0;
+        if (!slotIt.second.append)
+            continue;
 
-        // At least primary image source exists.
-        if (this->imageCaptures.size()) {
+        uint8_t index = slotIt.second.index;
+        shared_ptr<vector<uint8_t>> pending = this->published.getBytes(index);
+        shared_ptr<vector<uint8_t>> current = this->frame.getBytes(index);
 
-            this->captureMutex.lock();
+        // Nothing was read yet and it is not too much, so append.
+        if (pending && current && pending->size() + current->size() <= MAX_PENDING_APPEND) {
+            pending->insert(pending->end(), current->begin(), current->end());
+            this->frame.setBytes(index, pending);
+        }
 
-            // Next capture from camera + temp pointer for additional ones.
-            shared_ptr<cv::Mat> newest(this->imageCaptures[0]->getFrame());
-            shared_ptr<cv::Mat> temp;
+        // Nothing new this frame, keep pending data.
+        else if (!current)
+            this->frame.setBytes(index, pending);
 
-            // 'newest' does not point to NULL.
-            if (newest) {
+        // Too much, pending and current data are dropped, as the current data continue the dropped ones.
+        // The slot is marked for the producing operator.
+        else if (pending) {
+            this->frame.setBytes(index, shared_ptr<vector<uint8_t>>());
+            this->frame.setDropped(index, true);
+        }
+    }
 
-                // Get iterator for operator instances.
-                auto opIt = this->imageOperators.begin();
+    this->published = this->frame;
 
-                // Iterate list of execution.
-                while (opIt != this->imageOperators.end()) {
+    // Next frame starts without appended data.
+    for (auto slotIt : this->resultSlots)
+        if (slotIt.second.append)
+            this->frame.setBytes(slotIt.second.index, shared_ptr<vector<uint8_t>>());
+}
 
-                    stringstream cap;
-                    cap << ARG_CAPTURE << (int)0;
-                    (*opIt)->setValue(cap.str(), shared_ptr<ValMat>(new ValMat(newest)));
+/** \brief Executes image operations.
+ *
+ *  Fetches a frame from every capture and applies the list of image operators on it.
+ *  Operators returning OP_SKIP_FRAME end processing of the frame early.
+ *  Returns the number of available results.
+ *
+ *  \return Number of results.
+ */
+uint8_t ImgOpExecutor::execute() {
 
-                    // If operator requires more than one capture.
-                    for (uint8_t capture=1;
-                            capture < (*opIt)->getCaptureCount() && capture < this->imageCaptures.size();
-                            capture++) {
+    try {
 
-                        cap.str(std::string());
-                        cap.clear();
-                        cap << ARG_CAPTURE << (int)capture;
+        uint8_t resultCount = 0;
 
-                        // Get frame from image capture and set corresponding value of operator.
-                        // temp = newest;  // TODO: Actually bind additional cameras.
-                        temp = this->imageCaptures[capture]->getFrame();
-                        shared_ptr<ValMat> argValue(new ValMat(temp));
-                        (*opIt)->setValue(cap.str(), argValue);
-                    }
+        this->captureMutex.lock();
 
-                    // Process image from primary capture.
-                    unordered_map<string,shared_ptr<Value>> instanceResults;
-                    (*opIt)->apply(instanceResults);
+        // At least primary image source exists.
+        if (this->imageCaptures.size()) {
 
-                    // Get iterator for results.
-                    auto resIt = instanceResults.begin();
+            // Captures or operators changed, so bind again.
+            if (!this->bound)
+                bind();
 
-                    // Iterate list of results and add them to own list.
-                    while (resIt != instanceResults.end()) {
+            // Next frames from cameras.
+            for (uint8_t capture=0; capture < this->imageCaptures.size(); capture++)
+                this->frame.setMat(capture, this->imageCaptures[capture]->getFrame());
 
-                        this->setResult(resIt->first, resIt->second);
-                        resultCount++;
-                        resIt++;
-                    }
-                    opIt++;
-                }
+            // Primary frame does not point to NULL.
+            if (this->frame.getMat(0)) {
 
-                this->captureMutex.unlock();
+                // Iterate list of execution, an operator may skip the remaining ones.
+                // Their slots keep the results of the last frame processed.
+                for (auto opIt : this->imageOperators)
+                    if (opIt->apply(this->frame) == OP_SKIP_FRAME)
+                        break;
 
-            } else this->captureMutex.unlock();
+                // Publish results of this frame.
+                this->producer.lock();
+                publish();
+                resultCount = this->resultSlots.size();
+                this->producer.unlock();
+            }
         }
 
+        this->captureMutex.unlock();
+
         return resultCount;
 
     } catch(const std::system_error& e) {
@@ -9,15 +9,18 @@
 #define IMGOPEXECUTOR_H_
 
 #define MAX_CAPTURES    0xFF
+#define MAX_PENDING_APPEND  (8*1024*1024)
 #define ARG_THUMB   "Thumbnail"
 
 #include "ImgCapture.h"
+#include "ImgFrame.h"
 #include "ImgOperator.h"
 #include "../Child.h"
 
 #include <opencv2/highgui/highgui.hpp>
 
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -29,12 +32,6 @@ typedef enum {
 }execReturns;
 
 
-class ResultContainer : public ValContainer {
-public:
-    ResultContainer();
-    virtual ~ResultContainer();
-};
-
 class ImgOpExecutor : public Child {
 public:
 
@@ -42,7 +39,6 @@ public:
     ImgOpExecutor(shared_ptr<ImgCapture> &capture);
     virtual ~ImgOpExecutor();
 
-    uint8_t setResult(string identifier, shared_ptr<Value> &target);
     uint8_t getResult(string identifier, shared_ptr<Value> &target);
     uint8_t setValue(string identifier, shared_ptr<Value> target);
 
@@ -66,9 +62,14 @@ public:
 protected:
     vector<shared_ptr<ImgOperator>> imageOperators;
     vector<shared_ptr<ImgCapture>> imageCaptures;
-    ResultContainer results;
+    ImgFrame frame, published;
+    unordered_map<string,imgSlot> resultSlots;
+    bool bound;
     mutex producer, captureMutex;
 
+    void bind();
+    void publish();
+
 
 
 
@@ -40,22 +40,16 @@ uint8_t ImgOperator::getType() {
 
 /** \brief Create captures.
  *
- *  Creates 'captureCount' new camera captures and creates the corresponding instances
- *  of Value for ValContainer.
+ *  Creates 'captureCount' operator inputs, bound to the frames capture slots
+ *  in the same order by default.
  *
  *  \param captureCount Number of video captures.
  */
 void ImgOperator::createCaptures(uint8_t captureCount) {
 
-    // Add capture identifiers.
-    for (uint8_t capture=0; capture<captureCount;capture++) {
-
-        stringstream cap;
-        cap << ARG_CAPTURE << (int)capture;
-        createValue(cap.str(), shared_ptr<ValMat>(new ValMat));
-        this->captureIDs.push_back(cap.str());
-
-    }
+    // Bind inputs to capture slots.
+    for (uint8_t capture=0; capture<captureCount;capture++)
+        this->inputs.push_back(capture);
 }
 
 /** \brief Getter for capture count.
@@ -65,22 +59,97 @@ void ImgOperator::createCaptures(uint8_t captureCount) {
  *  \return capture count.
  */
 uint8_t ImgOperator::getCaptureCount() {
-    return this->captureIDs.size()+1;
+    return this->inputs.size();
+}
+
+/** \brief Bind operator to frame.
+ *
+ *  Allocates the operators result slots in 'frame'. Called once whenever the
+ *  frame layout changes, not per frame.
+ *  Operators without results do not need to override this.
+ *
+ *  \param frame Frame context to bind to.
+ */
+void ImgOperator::bind(ImgFrame &frame) { }
+
+/** \brief Connect input.
+ *
+ *  Binds operator input 'input' to the frames mat slot 'slot'.
+ *
+ *  \param input Index of the operator input.
+ *  \param slot Index of the mat slot.
+ */
+void ImgOperator::setInput(uint8_t input, uint8_t slot) {
+
+    if (input < this->inputs.size())
+        this->inputs[input] = slot;
+}
+
+/** \brief Create result slot.
+ *
+ *  Allocates slot of type 'type' in 'frame' and registers it as result 'name'.
+ *  Byte results of appending slots are accumulated by the executor until they are read.
+ *
+ *  \param frame Frame context to allocate the slot in.
+ *  \param name Name of the result.
+ *  \param type Value type of the result.
+ *  \param append Whether the result gets accumulated.
+ *  \return Reference to the new slot.
+ */
+imgSlot ImgOperator::createResult(ImgFrame &frame, string name, uint8_t type, bool append) {
+
+    imgSlot slot = frame.allocate(type);
+    slot.append = append && type == VAL_UCHAR_VECTOR;
+    this->resultSlots[name] = slot;
+
+    return slot;
+}
+
+/** \brief Getter for result slot.
+ *
+ *  Writes the slot of result 'name' to 'slot'.
+ *
+ *  \param name Name of the result.
+ *  \param slot Target slot reference.
+ *  \return true if the result exists, false otherwise.
+ */
+bool ImgOperator::getResultSlot(string name, imgSlot &slot) {
+
+    auto slotIt = this->resultSlots.find(name);
+
+    if (slotIt == this->resultSlots.end())
+        return false;
+
+    slot = slotIt->second;
+    return true;
+}
+
+/** \brief Getter for result slots.
+ *
+ *  Adds all result slots of the operator to 'slots'.
+ *
+ *  \param slots Target list of result slots.
+ */
+void ImgOperator::getResultSlots(unordered_map<string,imgSlot> &slots) {
+
+    for (auto slotIt : this->resultSlots)
+        slots[slotIt.first] = slotIt.second;
 }
 
 /** \brief Applies operator.
  *
- *  Checks if operator is set up properly and applies its operation.
+ *  Checks if operator is set up properly and applies its operation on 'frame'.
  *  Returns status indicator.
  *
+ *  \param frame Frame context holding inputs and results.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ImgOperator::apply(unordered_map<string,shared_ptr<Value>> &results) {
+uint8_t ImgOperator::apply(ImgFrame &frame) {
 
     if (!this->initialized())
         return ERR_UNSET_VALUE;
 
     // Return result of actual image processing call.
-    return process(results);
+    return process(frame);
 
 }
@@ -9,19 +9,21 @@
 #define IMGOPERATOR_H_
 
 #define ARG_SOURCE      "Source"
-#define ARG_CAPTURE     "Capture"
 #define ARG_OP_ACTIVE   "Active"
 
 #define RES_ENCODED_JPEG        "Encoded JPEG"
 #define RES_PICTURE_IN_PICTURE  "Picture in Picture"
 #define RES_CURVE_RADIUS        "Curve Radius"
 
+// Returned by operators to skip the remaining operators of the current frame.
+#define OP_SKIP_FRAME   0xFE
+
+#include "ImgFrame.h"
 #include "../ValContainer.h"
 
 #include <opencv2/highgui/highgui.hpp>
 
 #include <string>
-#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -31,7 +33,10 @@ typedef enum {
     OP_PICTURE_IN_PICTURE,
     OP_ENCODED_JPEG,
     OP_PREPARE,
-    OP_DETECT_CURVE
+    OP_DETECT_CURVE,
+    OP_ENCODED_REGIONS,
+    OP_MOTION_GATE,
+    OP_ENCODED_STREAM
 } opType;
 
 using namespace std;
@@ -41,13 +46,19 @@ public:
     ImgOperator(uint8_t type, uint8_t captureCount);
     uint8_t getType();
     virtual ~ImgOperator()=0;
-    uint8_t apply(unordered_map<string,shared_ptr<Value>> &results);
+    uint8_t apply(ImgFrame &frame);
     virtual uint8_t getCaptureCount();
     virtual void createCaptures(uint8_t captureCount);
+    virtual void bind(ImgFrame &frame);
+    void setInput(uint8_t input, uint8_t slot);
+    bool getResultSlot(string name, imgSlot &slot);
+    virtual void getResultSlots(unordered_map<string,imgSlot> &slots);
 protected:
     uint8_t type;
-    vector<string> captureIDs;
-    virtual uint8_t process(unordered_map<string,shared_ptr<Value>> &results)=0;
+    vector<uint8_t> inputs;
+    unordered_map<string,imgSlot> resultSlots;
+    imgSlot createResult(ImgFrame &frame, string name, uint8_t type, bool append=false);
+    virtual uint8_t process(ImgFrame &frame)=0;
 };
 
 #endif /* IMGOPERATOR_H_ */
@@ -22,27 +22,19 @@ OpComposite::OpComposite(uint8_t type) : ImgOperator(type, 1) {}
  */
 OpComposite::~OpComposite() { }
 
-/** \brief Connect result and parameter.
+/** \brief Connect result and input.
  *
- *  Connects the result values identified by 'resultName' with the parameter identified by 'paramName'.
+ *  Connects the result identified by 'resultName' with input 'input' of the successor.
  *  This way, results of one operator in the composite implementation can be input for a
- *  successor one.
+ *  successor one. The connection is resolved to frame slots when the composite is bound.
  *
- *  \param resultName Name of the result, which gets connected to a parameter.
- *  \param paramName Name of the parameter, which the result value gets connected to.
+ *  \param resultName Name of the result, which gets connected to an input.
+ *  \param input Index of the input, which the result gets connected to.
  */
-void OpComposite::connect(string resultName, string paramName) {
+void OpComposite::connect(string resultName, uint8_t input) {
 
-    // Find resultName occurrence.
-    auto connIt = this->connections.find(resultName);
-
-    // Does not exist, create it
-    if(connIt == this->connections.end())
-        this->connections.insert(make_pair(resultName, paramName));
-
-    // Exists, set new value.
-    else
-        connIt->second = paramName;
+    // Create or overwrite connection.
+    this->connections[resultName] = input;
 
 }
 
@@ -148,48 +140,70 @@ uint8_t OpComposite::getCaptureCount() {
     return result;
 }
 
-/** \brief Process operations.
+/** \brief Bind composite to frame.
  *
- *  Iterates over operators and processes their image operations and writes results into 'results'.
- *  Returns status indicator.
+ *  Binds all leafs to 'frame' and connects the result slots of each leaf
+ *  to the inputs of its successor.
  *
- *  \return 0 in case of success, an error code otherwise.
+ *  \param frame Frame context to bind to.
  */
-uint8_t OpComposite::process(unordered_map<string,shared_ptr<Value>> &results) {
-
-    uint8_t status = 0;
+void OpComposite::bind(ImgFrame &frame) {
 
     auto leafIt = this->imageOperators.begin();
 
     while (leafIt != this->imageOperators.end()) {
 
-        // Temp variable.
-        unordered_map<string,shared_ptr<Value>> tmp;
-
-        // Apply operator.
-        status = (*leafIt)->apply(tmp);
-
-        // An error occurred.
-        if (status != OK)
-            return status;
+        // Allocate result slots of leaf.
+        (*leafIt)->bind(frame);
 
-        // There are more operators pending, so try setting their parameters.
+        // There are more operators pending, so connect their inputs.
         if ((leafIt+1) != this->imageOperators.end())
 
-            // Iterate over results and set parameters of successor.
+            // Iterate over connections and bind inputs of successor.
             for (auto connIt : this->connections) {
 
-                auto resIt = tmp.find(connIt.first);
-                shared_ptr<Value> dasdsadsa = (resIt->second);
-                if(resIt != tmp.end())
-                    (*(leafIt+1))->setValue(connIt.second, resIt->second);
+                imgSlot slot;
+                if ((*leafIt)->getResultSlot(connIt.first, slot) && slot.type == VAL_MAT)
+                    (*(leafIt+1))->setInput(connIt.second, slot.index);
             }
 
-        // Insert results to list.
-        results.insert(tmp.begin(), tmp.end());
-
         leafIt++;
     }
+}
+
+/** \brief Getter for result slots.
+ *
+ *  Adds the result slots of all leafs to 'slots'.
+ *
+ *  \param slots Target list of result slots.
+ */
+void OpComposite::getResultSlots(unordered_map<string,imgSlot> &slots) {
+
+    for (auto leafIt : this->imageOperators)
+        leafIt->getResultSlots(slots);
+}
+
+/** \brief Process operations.
+ *
+ *  Iterates over operators and processes their image operations on 'frame'.
+ *  Returns status indicator.
+ *
+ *  \param frame Frame context holding inputs and results.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t OpComposite::process(ImgFrame &frame) {
+
+    uint8_t status = 0;
+
+    for (auto leafIt : this->imageOperators) {
+
+        // Apply operator.
+        status = leafIt->apply(frame);
+
+        // An error occurred.
+        if (status != OK)
+            return status;
+    }
 
     return status;
 
@@ -30,17 +30,19 @@ public:
     uint8_t op_swap(uint8_t index1, uint8_t index2);
     uint8_t op_firstIndexOf(uint8_t opType);
 
-    void connect(string resultName, string paramName);
+    void connect(string resultName, uint8_t input);
 
     virtual uint8_t setValue(string name, const shared_ptr<Value> &val);
     virtual uint8_t getValue(string name, shared_ptr<Value> &val);
     virtual bool initialized();
     virtual void createCaptures(uint8_t captureCount);
     virtual uint8_t getCaptureCount();
+    virtual void bind(ImgFrame &frame);
+    virtual void getResultSlots(unordered_map<string,imgSlot> &slots);
 private:
     vector<shared_ptr<ImgOperator>> imageOperators;
-    unordered_map<string,string> connections;
-    virtual uint8_t process(unordered_map<string,shared_ptr<Value>> &results);
+    unordered_map<string,uint8_t> connections;
+    virtual uint8_t process(ImgFrame &frame);
 };
 
 #endif /* OPCOMPOSITE_H_ */
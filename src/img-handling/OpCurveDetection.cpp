@@ -21,7 +21,8 @@ OpCurveDetection::OpCurveDetection() : ImgOperator(OP_DETECT_CURVE, 1)
     createValue(ARG_CAM_MAX_DIST, shared_ptr<ValInt>(new ValInt(50)));
     createValue(ARG_CAM_OFFSET, shared_ptr<ValDouble>(new ValDouble(50)));
     createValue(ARG_CAM_HEIGHT, shared_ptr<ValDouble>(new ValDouble(50)));
-    createValue(ARG_OP_ACTIVE, shared_ptr<ValInt>(new ValInt(1)));
+    active = shared_ptr<ValInt>(new ValInt(1));
+    createValue(ARG_OP_ACTIVE, active);
 
     lookup = NULL;
     nlookup = -1;
@@ -33,32 +34,36 @@ OpCurveDetection::~OpCurveDetection()
     delete lookup;
 }
 /**
- * \brief The main function to start.
+ * \brief Allocates the curve radius result slot.
  *
- * \param radius Double to write radius to
+ * \param frame Frame context to bind to
  */
-uint8_t OpCurveDetection::process(unordered_map<string,shared_ptr<Value>> &results)
+void OpCurveDetection::bind(ImgFrame &frame)
 {
-    shared_ptr<Value> active_Val;
-    getValue(ARG_OP_ACTIVE, active_Val);
+    result = createResult(frame, RES_CURVE_RADIUS, VAL_DOUBLE);
+}
 
-    if (active_Val && dynamic_pointer_cast<ValInt>(active_Val)->getValue()) {
+/**
+ * \brief The main function to start.
+ *
+ * \param frame Frame context to read the image from and write the radius to
+ */
+uint8_t OpCurveDetection::process(ImgFrame &frame)
+{
+    if (active->getValue()) {
 
         if (!initialized) {
             if (initialize())
                 return ERR_UNKNOWN;
         }
 
-        // Get source image argument.
-        shared_ptr<Value> src_Val;
-        uint8_t status = getValue(this->captureIDs[0], src_Val);
+        // Get source image.
+        const shared_ptr<Mat> source = frame.getMat(inputs[0]);
 
-        // An error occured.
-        if( status != OK )
-            return status;
+        // Input is not available.
+        if (!source)
+            return ERR_UNSET_VALUE;
 
-        // Get source mat from value instance.
-        const shared_ptr<Mat> source = dynamic_pointer_cast<ValMat>(src_Val)->getValue();
         Mat tmp;
 
         //Convert color image to bw
@@ -82,7 +87,7 @@ uint8_t OpCurveDetection::process(unordered_map<string,shared_ptr<Value>> &resul
         if (rightMarking.ERROR_FLAG == true)
             rightMarking = oldRightMarking;
 
-        results.insert(make_pair(RES_CURVE_RADIUS, shared_ptr<ValDouble>(new ValDouble(getRadius(leftMarking, rightMarking)))));
+        frame.setDouble(result.index, getRadius(leftMarking, rightMarking));
 
         oldLeftMarking = leftMarking;
         oldRightMarking = rightMarking;
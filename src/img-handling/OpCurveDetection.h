@@ -40,7 +40,8 @@ using namespace std;
 
 class OpCurveDetection : public ImgOperator {
 public:
-    virtual uint8_t process(unordered_map<string,shared_ptr<Value>> &results);
+    virtual uint8_t process(ImgFrame &frame);
+    virtual void bind(ImgFrame &frame);
     uint8_t initialize();
     OpCurveDetection();
     ~OpCurveDetection();
@@ -63,6 +64,10 @@ private:
     //Initialization flag
     bool initialized;
 
+    //Activation option and result slot
+    shared_ptr<ValInt> active;
+    imgSlot result;
+
     //Variables
     map<double, int> lookupForFullImg;
     double *lookup;
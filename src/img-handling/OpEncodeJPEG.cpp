@@ -14,8 +14,9 @@
  */
 OpEncodeJPEG::OpEncodeJPEG() : ImgOperator(OP_ENCODED_JPEG, 1) {
 
-    // Create argument list.
-    createValue(ARG_JPEG_QUALITY, shared_ptr<ValInt>(new ValInt(50)));
+    // Create argument list, options are set in place and kept for processing.
+    this->quality = shared_ptr<ValInt>(new ValInt(50));
+    createValue(ARG_JPEG_QUALITY, this->quality);
 }
 
 /** \brief Destructor.
@@ -24,44 +25,44 @@ OpEncodeJPEG::OpEncodeJPEG() : ImgOperator(OP_ENCODED_JPEG, 1) {
  */
 OpEncodeJPEG::~OpEncodeJPEG() { }
 
+/** \brief Bind operator to frame.
+ *
+ *  Allocates the encoded image result slot in 'frame'.
+ *
+ *  \param frame Frame context to bind to.
+ */
+void OpEncodeJPEG::bind(ImgFrame &frame) {
+    this->result = createResult(frame, RES_ENCODED_JPEG, VAL_UCHAR_VECTOR);
+}
+
 /** \brief Process operation.
  *
- *  Encodes the Mat object passed by capture ID 0 as JPEG image.
+ *  Encodes the Mat object passed by input 0 as JPEG image.
  *  Returns status indicator.
  *
+ *  \param frame Frame context holding inputs and results.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t OpEncodeJPEG::process(unordered_map<string,shared_ptr<Value>> &results) {
-
-
-    // Get source image argument.
-    shared_ptr<Value> src_Val;
-    uint8_t status = getValue(this->captureIDs[0], src_Val);
-
-    // An error occured.
-    if( status != OK )
-        return status;
+uint8_t OpEncodeJPEG::process(ImgFrame &frame) {
 
-    // Get jpeg quality argument.
-    shared_ptr<Value> quali_Value;
-    status = getValue(ARG_JPEG_QUALITY, quali_Value);
+    // Get source image.
+    const shared_ptr<cv::Mat> source = frame.getMat(this->inputs[0]);
 
-    // An error occured.
-    if( status != OK )
-        return status;
+    // Input is not available.
+    if (!source)
+        return ERR_UNSET_VALUE;
 
     // Set up argument list for encoding.
-    const shared_ptr<cv::Mat> source = dynamic_pointer_cast<ValMat>(src_Val)->getValue();
     vector<int> jpegParams = vector<int>(2); //parameters for encoder
     jpegParams.push_back(CV_IMWRITE_JPEG_QUALITY); //jpeg quality
-    jpegParams.push_back((dynamic_pointer_cast<ValInt>(quali_Value))->getValue()); //is equal ...
+    jpegParams.push_back(this->quality->getValue()); //is equal ...
 
     // Encode image as JPEG.
     shared_ptr<vector<uint8_t>> target(new vector<uint8_t>);
     imencode(".jpg", *source, *target, jpegParams);
 
-    // Create result Value and add it to list of results.
-    results.insert(make_pair(RES_ENCODED_JPEG, shared_ptr<ValVectorUChar>(new ValVectorUChar(target))));
+    // Store result.
+    frame.setBytes(this->result.index, target);
 
     return OK;
 
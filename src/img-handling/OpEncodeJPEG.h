@@ -23,8 +23,11 @@ class OpEncodeJPEG : public ImgOperator {
 public:
     OpEncodeJPEG();
     virtual ~OpEncodeJPEG();
+    virtual void bind(ImgFrame &frame);
 protected:
-    virtual uint8_t process(unordered_map<string,shared_ptr<Value>> &results);
+    shared_ptr<ValInt> quality;
+    imgSlot result;
+    virtual uint8_t process(ImgFrame &frame);
 };
 
 #endif /* OPENCODEJPEG_H_ */
@@ -0,0 +1,148 @@
+/** \brief      Class for JPEG encoding with a low quality region.
+ *
+ * \details     Encodes a picture-in-picture image as JPEG, with the thumbnail region at a
+ *              lower quality than the rest of the image, and optionally blanks masked pixels.
+ *              The thumbnail region is encoded at the lower quality first, decoded again and
+ *              written back aligned to the JPEG block grid. Quantization of the final encoding
+ *              then keeps its reduced detail, so the result is one standard JPEG image.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       OpEncodeRegions
+ */
+
+#include "OpEncodeRegions.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of OpEncodeRegions instances.
+ *  Input 0 is the composed image, input 1 the source of the thumbnail.
+ */
+OpEncodeRegions::OpEncodeRegions() : ImgOperator(OP_ENCODED_REGIONS, 2) {
+
+    // Create argument list, options are set in place and kept for processing.
+    // Scale and position match the picture-in-picture options, so composites set both.
+    this->quality = shared_ptr<ValInt>(new ValInt(50));
+    this->roiQuality = shared_ptr<ValInt>(new ValInt(100));
+    this->scale = shared_ptr<ValInt>(new ValInt);
+    this->posX = shared_ptr<ValInt>(new ValInt);
+    this->posY = shared_ptr<ValInt>(new ValInt);
+    shared_ptr<cv::Mat> noMask(new cv::Mat());
+    this->mask = shared_ptr<ValMat>(new ValMat(noMask));
+
+    createValue(ARG_JPEG_QUALITY, this->quality);
+    createValue(ARG_ROI_QUALITY, this->roiQuality);
+    createValue(ARG_SCALE, this->scale);
+    createValue(ARG_POS_X, this->posX);
+    createValue(ARG_POS_Y, this->posY);
+    createValue(ARG_MASK, this->mask);
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of OpEncodeRegions instances.
+ */
+OpEncodeRegions::~OpEncodeRegions() { }
+
+/** \brief Bind operator to frame.
+ *
+ *  Allocates the encoded image result slot in 'frame'.
+ *
+ *  \param frame Frame context to bind to.
+ */
+void OpEncodeRegions::bind(ImgFrame &frame) {
+    this->result = createResult(frame, RES_ENCODED_JPEG, VAL_UCHAR_VECTOR);
+}
+
+/** \brief Process operation.
+ *
+ *  Blanks the pixels set in the mask option, reduces the quality of the thumbnail
+ *  region and encodes the Mat object passed by input 0 as JPEG image.
+ *  Returns status indicator.
+ *
+ *  \param frame Frame context holding inputs and results.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t OpEncodeRegions::process(ImgFrame &frame) {
+
+    // Get composed image and thumbnail source.
+    const shared_ptr<cv::Mat> source = frame.getMat(this->inputs[0]);
+    const shared_ptr<cv::Mat> thumb = frame.getMat(this->inputs[1]);
+
+    // Input is not available.
+    if (!source)
+        return ERR_UNSET_VALUE;
+
+    const shared_ptr<cv::Mat> mask = this->mask->getValue();
+    bool masked = mask && !mask->empty() && mask->size() == source->size();
+    bool reduced = thumb && this->scale->getValue() > 0
+            && this->roiQuality->getValue() < this->quality->getValue();
+
+    // Work on a copy, source is a result of another operator.
+    cv::Mat image = *source;
+    if (masked || reduced)
+        image = source->clone();
+
+    // Blank masked pixels.
+    if (masked)
+        image.setTo(cv::Scalar::all(0), *mask);
+
+    // Reduce quality of thumbnail region.
+    if (reduced)
+        degradeRegion(image, cv::Rect(this->posX->getValue(), this->posY->getValue(),
+                thumb->cols / this->scale->getValue(), thumb->rows / this->scale->getValue()));
+
+    // Set up argument list for encoding.
+    vector<int> jpegParams;
+    jpegParams.push_back(CV_IMWRITE_JPEG_QUALITY);
+    jpegParams.push_back(this->quality->getValue());
+
+    // Encode image as JPEG.
+    shared_ptr<vector<uint8_t>> target(new vector<uint8_t>);
+    imencode(".jpg", image, *target, jpegParams);
+
+    // Store result.
+    frame.setBytes(this->result.index, target);
+
+    return OK;
+
+}
+
+/** \brief Reduce region quality.
+ *
+ *  Encodes region 'area' of 'image' at the region quality, decodes it and writes it back.
+ *  The region is widened to the JPEG block grid first, so its blocks match the blocks of
+ *  the final encoding.
+ *
+ *  \param image Image to modify.
+ *  \param area Region to reduce.
+ */
+void OpEncodeRegions::degradeRegion(cv::Mat &image, cv::Rect area) {
+
+    // Widen region to block grid and clip it to the image.
+    int32_t left = max(0, area.x) / JPEG_MCU_SIZE * JPEG_MCU_SIZE;
+    int32_t top = max(0, area.y) / JPEG_MCU_SIZE * JPEG_MCU_SIZE;
+    int32_t right = (area.x + area.width + JPEG_MCU_SIZE - 1) / JPEG_MCU_SIZE * JPEG_MCU_SIZE;
+    int32_t bottom = (area.y + area.height + JPEG_MCU_SIZE - 1) / JPEG_MCU_SIZE * JPEG_MCU_SIZE;
+    right = min(right, image.cols);
+    bottom = min(bottom, image.rows);
+
+    // Region is empty.
+    if (right <= left || bottom <= top)
+        return;
+
+    cv::Mat region(image, cv::Rect(left, top, right - left, bottom - top));
+
+    // Encode region at low quality.
+    vector<int> jpegParams;
+    jpegParams.push_back(CV_IMWRITE_JPEG_QUALITY);
+    jpegParams.push_back(this->roiQuality->getValue());
+
+    vector<uint8_t> encoded;
+    if (!imencode(".jpg", region, encoded, jpegParams))
+        return;
+
+    // Decode and write back.
+    cv::Mat decoded = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (decoded.size() == region.size() && decoded.type() == region.type())
+        decoded.copyTo(region);
+}
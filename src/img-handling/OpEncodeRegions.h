@@ -0,0 +1,40 @@
+/*
+ * OpEncodeRegions.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef OPENCODEREGIONS_H_
+#define OPENCODEREGIONS_H_
+
+#define ARG_ROI_QUALITY "ROI Quality"
+#define ARG_MASK        "Mask"
+
+#define JPEG_MCU_SIZE   16
+
+#include "ImgOperator.h"
+#include "OpEncodeJPEG.h"
+#include "OpPictureInPicture.h"
+#include "../Value.h"
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <string>
+#include <unordered_map>
+
+class OpEncodeRegions : public ImgOperator {
+public:
+    OpEncodeRegions();
+    virtual ~OpEncodeRegions();
+    virtual void bind(ImgFrame &frame);
+protected:
+    shared_ptr<ValInt> quality, roiQuality, scale, posX, posY;
+    shared_ptr<ValMat> mask;
+    imgSlot result;
+    virtual uint8_t process(ImgFrame &frame);
+    void degradeRegion(cv::Mat &image, cv::Rect area);
+};
+
+#endif /* OPENCODEREGIONS_H_ */
@@ -0,0 +1,239 @@
+/** \brief      Class for inter-frame video encoding.
+ *
+ * \details     Encodes consecutive frames as continuous video stream using libavcodec,
+ *              H.264 by default. The NAL units (Annex B byte stream, parameter sets repeated
+ *              in front of every keyframe) are an appending result, so the executor collects
+ *              everything produced until the stream is read. If it drops them unread, the
+ *              stream continues with a keyframe.
+ *              Frames are only encoded while the stream is active, i.e. while the server
+ *              subscribes to it. Each activation starts a new stream.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       OpEncodeStream
+ */
+
+#include "OpEncodeStream.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of OpEncodeStream instances.
+ */
+OpEncodeStream::OpEncodeStream() : ImgOperator(OP_ENCODED_STREAM, 1) {
+
+    // Create argument list, options are set in place and kept for processing.
+    this->codecName = shared_ptr<ValString>(new ValString(STREAM_CODEC_H264));
+    this->bitrate = shared_ptr<ValInt>(new ValInt(500000));
+    this->gop = shared_ptr<ValInt>(new ValInt(25));
+    this->fps = shared_ptr<ValInt>(new ValInt(10));
+    this->keyframe = shared_ptr<ValInt>(new ValInt(0));
+    this->active = shared_ptr<ValInt>(new ValInt(0));
+
+    createValue(ARG_STREAM_CODEC, this->codecName);
+    createValue(ARG_STREAM_BITRATE, this->bitrate);
+    createValue(ARG_STREAM_GOP, this->gop);
+    createValue(ARG_STREAM_FPS, this->fps);
+    createValue(ARG_STREAM_KEYFRAME, this->keyframe);
+    createValue(ARG_STREAM_ACTIVE, this->active);
+
+    this->context = NULL;
+    this->picture = NULL;
+    this->packet = NULL;
+    this->pts = 0;
+    this->openedBitrate = 0;
+    this->openedGop = 0;
+    this->openedFps = 0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of OpEncodeStream instances, releasing the encoder.
+ */
+OpEncodeStream::~OpEncodeStream() {
+    close();
+}
+
+/** \brief Bind operator to frame.
+ *
+ *  Allocates the appending stream result slot in 'frame'.
+ *
+ *  \param frame Frame context to bind to.
+ */
+void OpEncodeStream::bind(ImgFrame &frame) {
+    this->result = createResult(frame, RES_ENCODED_STREAM, VAL_UCHAR_VECTOR, true);
+}
+
+/** \brief Open encoder.
+ *
+ *  Sets up the encoder for frames of size 'width' x 'height' with the current options.
+ *  Returns success state.
+ *
+ *  \param width Frame width.
+ *  \param height Frame height.
+ *  \return true in case of success, false otherwise.
+ */
+bool OpEncodeStream::open(int32_t width, int32_t height) {
+
+    close();
+
+    string name = this->codecName->getValue();
+
+    // Find encoder by name, fall back to any H.264 encoder.
+    const AVCodec *codec = avcodec_find_encoder_by_name(name.c_str());
+    if (!codec && name == STREAM_CODEC_H264)
+        codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    if (!codec)
+        return false;
+
+    this->context = avcodec_alloc_context3(codec);
+    if (!this->context)
+        return false;
+
+    // Stream parameters, no B-frames to keep latency low.
+    this->context->width = width;
+    this->context->height = height;
+    this->context->time_base.num = 1;
+    this->context->time_base.den = max(1, this->fps->getValue());
+    this->context->framerate.num = max(1, this->fps->getValue());
+    this->context->framerate.den = 1;
+    this->context->gop_size = max(1, this->gop->getValue());
+    this->context->max_b_frames = 0;
+    this->context->bit_rate = max(1, this->bitrate->getValue());
+    this->context->pix_fmt = (codec->id == AV_CODEC_ID_MJPEG) ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUV420P;
+
+    // Encoder specific tuning, ignored by encoders not knowing the options.
+    av_opt_set(this->context->priv_data, "preset", "ultrafast", 0);
+    av_opt_set(this->context->priv_data, "tune", "zerolatency", 0);
+    av_opt_set(this->context->priv_data, "forced-idr", "1", 0);
+
+    if (avcodec_open2(this->context, codec, NULL) < 0) {
+        close();
+        return false;
+    }
+
+    // Picture buffer and packet for encoding.
+    this->picture = av_frame_alloc();
+    this->packet = av_packet_alloc();
+    if (!this->picture || !this->packet) {
+        close();
+        return false;
+    }
+
+    this->picture->format = this->context->pix_fmt;
+    this->picture->width = width;
+    this->picture->height = height;
+    if (av_frame_get_buffer(this->picture, 32) < 0) {
+        close();
+        return false;
+    }
+
+    // Remember options the encoder was opened with.
+    this->openedCodec = name;
+    this->openedBitrate = this->bitrate->getValue();
+    this->openedGop = this->gop->getValue();
+    this->openedFps = this->fps->getValue();
+    this->pts = 0;
+
+    return true;
+}
+
+/** \brief Close encoder.
+ *
+ *  Releases encoder, picture buffer and packet.
+ */
+void OpEncodeStream::close() {
+
+    if (this->context)
+        avcodec_free_context(&this->context);
+    if (this->picture)
+        av_frame_free(&this->picture);
+    if (this->packet)
+        av_packet_free(&this->packet);
+
+    this->context = NULL;
+    this->picture = NULL;
+    this->packet = NULL;
+}
+
+/** \brief Process operation.
+ *
+ *  Encodes the Mat object passed by input 0 as next frame of the stream and
+ *  stores the resulting NAL units. Releases the encoder while the stream is inactive.
+ *  Returns status indicator.
+ *
+ *  \param frame Frame context holding inputs and results.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t OpEncodeStream::process(ImgFrame &frame) {
+
+    // Nobody receives the stream.
+    if (!this->active->getValue()) {
+        close();
+        return OK;
+    }
+
+    // Get source image.
+    const shared_ptr<cv::Mat> source = frame.getMat(this->inputs[0]);
+
+    // Input is not available.
+    if (!source || source->empty())
+        return ERR_UNSET_VALUE;
+
+    // 4:2:0 subsampling needs even dimensions.
+    int32_t width = source->cols & ~1;
+    int32_t height = source->rows & ~1;
+
+    // Open encoder, if not open yet or size or options changed.
+    if (!this->context
+            || this->context->width != width
+            || this->context->height != height
+            || this->openedCodec != this->codecName->getValue()
+            || this->openedBitrate != this->bitrate->getValue()
+            || this->openedGop != this->gop->getValue()
+            || this->openedFps != this->fps->getValue()) {
+
+        if (!open(width, height))
+            return ERR_UNKNOWN;
+    }
+
+    if (av_frame_make_writable(this->picture) < 0)
+        return ERR_UNKNOWN;
+
+    // Convert to planar YUV 4:2:0, planes are stored one after another.
+    cv::Mat yuv;
+    cv::cvtColor((*source)(cv::Rect(0, 0, width, height)), yuv, cv::COLOR_BGR2YUV_I420);
+
+    const uint8_t *plane = yuv.data;
+    for (int32_t row=0; row < height; row++, plane += width)
+        memcpy(this->picture->data[0] + row * this->picture->linesize[0], plane, width);
+    for (int32_t row=0; row < height/2; row++, plane += width/2)
+        memcpy(this->picture->data[1] + row * this->picture->linesize[1], plane, width/2);
+    for (int32_t row=0; row < height/2; row++, plane += width/2)
+        memcpy(this->picture->data[2] + row * this->picture->linesize[2], plane, width/2);
+
+    // Keyframe got requested, e.g. by a receiver joining the stream, or
+    // the executor dropped unread output, which later frames would refer to.
+    if (this->keyframe->getValue() || frame.isDropped(this->result.index)) {
+        this->picture->pict_type = AV_PICTURE_TYPE_I;
+        this->keyframe->setValue(0);
+        frame.setDropped(this->result.index, false);
+    } else
+        this->picture->pict_type = AV_PICTURE_TYPE_NONE;
+
+    this->picture->pts = this->pts++;
+
+    if (avcodec_send_frame(this->context, this->picture) < 0)
+        return ERR_UNKNOWN;
+
+    // Collect all NAL units the encoder emitted for this frame.
+    shared_ptr<vector<uint8_t>> units(new vector<uint8_t>);
+    while (avcodec_receive_packet(this->context, this->packet) == 0) {
+        units->insert(units->end(), this->packet->data, this->packet->data + this->packet->size);
+        av_packet_unref(this->packet);
+    }
+
+    // Store result.
+    if (units->size())
+        frame.setBytes(this->result.index, units);
+
+    return OK;
+}
@@ -0,0 +1,59 @@
+/*
+ * OpEncodeStream.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef OPENCODESTREAM_H_
+#define OPENCODESTREAM_H_
+
+#define ARG_STREAM_CODEC    "Codec"
+#define ARG_STREAM_BITRATE  "Bitrate"
+#define ARG_STREAM_GOP      "GOP"
+#define ARG_STREAM_FPS      "Frame rate"
+#define ARG_STREAM_KEYFRAME "Keyframe"
+#define ARG_STREAM_ACTIVE   "Streaming"
+
+#define RES_ENCODED_STREAM  "Encoded Stream"
+
+#define STREAM_CODEC_H264   "libx264"
+
+#include "ImgOperator.h"
+#include "../Value.h"
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+}
+
+#include <cstring>
+#include <string>
+
+class OpEncodeStream : public ImgOperator {
+public:
+    OpEncodeStream();
+    virtual ~OpEncodeStream();
+    virtual void bind(ImgFrame &frame);
+protected:
+    shared_ptr<ValString> codecName;
+    shared_ptr<ValInt> bitrate, gop, fps, keyframe, active;
+    imgSlot result;
+
+    AVCodecContext *context;
+    AVFrame *picture;
+    AVPacket *packet;
+    int64_t pts;
+    string openedCodec;
+    int32_t openedBitrate, openedGop, openedFps;
+
+    virtual uint8_t process(ImgFrame &frame);
+    bool open(int32_t width, int32_t height);
+    void close();
+};
+
+#endif /* OPENCODESTREAM_H_ */
@@ -0,0 +1,97 @@
+/** \brief      Image operator skipping frames without scene change.
+ *
+ * \details     Compares downsampled versions of all captures with the ones of the last
+ *              frame processed completely. If the mean difference is below the threshold,
+ *              the remaining operators of the executor are skipped, so their most recent
+ *              results stay published.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       OpMotionGate
+ */
+
+#include "OpMotionGate.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of OpMotionGate instances.
+ */
+OpMotionGate::OpMotionGate() : ImgOperator(OP_MOTION_GATE, 2) {
+
+    // Create argument list, options are set in place and kept for processing.
+    this->threshold = shared_ptr<ValDouble>(new ValDouble(0));
+    this->maxSkip = shared_ptr<ValInt>(new ValInt(0));
+    createValue(ARG_MOTION_THRESHOLD, this->threshold);
+    createValue(ARG_MOTION_MAX_SKIP, this->maxSkip);
+
+    this->reference.resize(this->inputs.size());
+    this->skipped = 0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of OpMotionGate instances.
+ */
+OpMotionGate::~OpMotionGate() { }
+
+/** \brief Process operation.
+ *
+ *  Downsamples all inputs and compares them with the reference frame.
+ *  Returns OP_SKIP_FRAME, if the scene did not change enough and the maximum
+ *  number of consecutively skipped frames is not reached yet.
+ *
+ *  \param frame Frame context holding inputs.
+ *  \return 0 or OP_SKIP_FRAME in case of success, an error code otherwise.
+ */
+uint8_t OpMotionGate::process(ImgFrame &frame) {
+
+    vector<cv::Mat> current(this->inputs.size());
+    double difference = 0;
+    bool changed = false;
+
+    for (uint8_t input=0; input < this->inputs.size(); input++) {
+
+        const shared_ptr<cv::Mat> source = frame.getMat(this->inputs[input]);
+
+        // Capture not available.
+        if (!source || source->empty())
+            continue;
+
+        // Build signature of capture.
+        cv::resize(*source, current[input],
+                cv::Size(MOTION_SIGNATURE_WIDTH, MOTION_SIGNATURE_HEIGHT), 0, 0, cv::INTER_AREA);
+
+        // No comparable reference, treat as changed.
+        if (this->reference[input].empty()
+                || this->reference[input].type() != current[input].type()) {
+            changed = true;
+            continue;
+        }
+
+        // Mean absolute difference, averaged over channels.
+        cv::Mat delta;
+        cv::absdiff(current[input], this->reference[input], delta);
+        cv::Scalar mean = cv::mean(delta);
+        double sum = 0;
+        for (int32_t channel=0; channel < delta.channels(); channel++)
+            sum += mean[channel];
+
+        difference = max(difference, sum / delta.channels());
+    }
+
+    // Scene is static and refresh is not due yet.
+    if (!changed && difference < this->threshold->getValue()
+            && (this->maxSkip->getValue() <= 0 || this->skipped < (uint32_t)this->maxSkip->getValue())) {
+
+        this->skipped++;
+        return OP_SKIP_FRAME;
+    }
+
+    // Frame gets processed, so it is the new reference.
+    for (uint8_t input=0; input < this->inputs.size(); input++)
+        if (!current[input].empty())
+            this->reference[input] = current[input];
+
+    this->skipped = 0;
+
+    return OK;
+}
@@ -0,0 +1,37 @@
+/*
+ * OpMotionGate.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef OPMOTIONGATE_H_
+#define OPMOTIONGATE_H_
+
+#define ARG_MOTION_THRESHOLD    "Motion threshold"
+#define ARG_MOTION_MAX_SKIP     "Motion max skip"
+
+#define MOTION_SIGNATURE_WIDTH  32
+#define MOTION_SIGNATURE_HEIGHT 24
+
+#include "ImgOperator.h"
+#include "../Value.h"
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <vector>
+
+class OpMotionGate : public ImgOperator {
+public:
+    OpMotionGate();
+    virtual ~OpMotionGate();
+protected:
+    shared_ptr<ValDouble> threshold;
+    shared_ptr<ValInt> maxSkip;
+    vector<cv::Mat> reference;
+    uint32_t skipped;
+    virtual uint8_t process(ImgFrame &frame);
+};
+
+#endif /* OPMOTIONGATE_H_ */
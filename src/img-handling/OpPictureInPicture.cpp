@@ -14,10 +14,13 @@
  */
 OpPictureInPicture::OpPictureInPicture() : ImgOperator(OP_PICTURE_IN_PICTURE, 2) {
 
-    // Create argument list.
-    createValue(ARG_SCALE, shared_ptr<ValInt>(new ValInt));
-    createValue(ARG_POS_X, shared_ptr<ValInt>(new ValInt));
-    createValue(ARG_POS_Y, shared_ptr<ValInt>(new ValInt));
+    // Create argument list, options are set in place and kept for processing.
+    this->scale = shared_ptr<ValInt>(new ValInt);
+    this->posX = shared_ptr<ValInt>(new ValInt);
+    this->posY = shared_ptr<ValInt>(new ValInt);
+    createValue(ARG_SCALE, this->scale);
+    createValue(ARG_POS_X, this->posX);
+    createValue(ARG_POS_Y, this->posY);
 }
 
 /** \brief Destructor.
@@ -26,63 +29,38 @@ OpPictureInPicture::OpPictureInPicture() : ImgOperator(OP_PICTURE_IN_PICTURE, 2)
  */
 OpPictureInPicture::~OpPictureInPicture() { }
 
+/** \brief Bind operator to frame.
+ *
+ *  Allocates the picture-in-picture result slot in 'frame'.
+ *
+ *  \param frame Frame context to bind to.
+ */
+void OpPictureInPicture::bind(ImgFrame &frame) {
+    this->result = createResult(frame, RES_PICTURE_IN_PICTURE, VAL_MAT);
+}
+
 /** \brief Process operation.
  *
- *  Writes the Mat object passed by capture ID 1 as picture-in-picture
- *  to a copy of the Mat object passed by capture ID 0.
+ *  Writes the Mat object passed by input 1 as picture-in-picture
+ *  to a copy of the Mat object passed by input 0.
  *  Returns status indicator.
  *
+ *  \param frame Frame context holding inputs and results.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t OpPictureInPicture::process(unordered_map<string,shared_ptr<Value>> &results) {
-
-    // Get source image argument.
-    shared_ptr<Value> src_Val;
-    uint8_t status = getValue(this->captureIDs[0], src_Val);
-
-    // An error occured.
-    if( status != OK )
-        return status;
-
-    // Get thumbnail image argument.
-    shared_ptr<Value> thumb_Value;
-    status = getValue(this->captureIDs[1], thumb_Value);
-
-    // An error occured.
-    if( status != OK )
-        return status;
-
-    // Get scale argument.
-    shared_ptr<Value> scale_Value;
-    status = getValue(ARG_SCALE, scale_Value);
-
-    // An error occured.
-    if( status != OK )
-        return status;
-
-    // Get position(x) argument.
-    shared_ptr<Value> posX_Value;
-    status = getValue(ARG_POS_X, posX_Value);
-
-    // An error occured.
-    if( status != OK )
-        return status;
-
-    // Get position(y) argument.
-    shared_ptr<Value> posY_Value;
-    status = getValue(ARG_POS_Y, posY_Value);
+uint8_t OpPictureInPicture::process(ImgFrame &frame) {
 
-    // Unexpected argument type.
-    if( status != OK )
-        return status;
+    // Get source and thumbnail image.
+    const shared_ptr<cv::Mat> source = frame.getMat(this->inputs[0]);
+    const shared_ptr<cv::Mat> thumb = frame.getMat(this->inputs[1]);
 
-    // Cast argument types.
-    const shared_ptr<cv::Mat> source = dynamic_pointer_cast<ValMat>(src_Val)->getValue();
-    const shared_ptr<cv::Mat> thumb = dynamic_pointer_cast<ValMat>(thumb_Value)->getValue();
-    uint32_t scale = dynamic_pointer_cast<ValInt>(scale_Value)->getValue();
-    uint32_t posX = dynamic_pointer_cast<ValInt>(posX_Value)->getValue();
-    uint32_t posY = dynamic_pointer_cast<ValInt>(posY_Value)->getValue();
+    // An input is not available.
+    if (!source || !thumb)
+        return ERR_UNSET_VALUE;
 
+    uint32_t scale = this->scale->getValue();
+    uint32_t posX = this->posX->getValue();
+    uint32_t posY = this->posY->getValue();
 
     // Calculate thumbs size parameters.
     uint32_t width = thumb->cols / scale;
@@ -92,13 +70,12 @@ uint8_t OpPictureInPicture::process(unordered_map<string,shared_ptr<Value>> &res
     cv::Mat resized;
     cv::resize(*thumb, resized, cv::Size(width, height), 0, 0, cv::INTER_CUBIC);
 
-    // Create and append result.
+    // Create and store result.
     shared_ptr<cv::Mat> result(new cv::Mat());
     source->copyTo(*result);
-    cv::Mat frame(*result, cv::Rect(posX, posY, width, height));
-    resized.copyTo(frame);
-    shared_ptr<ValMat> resultVal(new ValMat(result));
-    results.insert(make_pair(RES_PICTURE_IN_PICTURE, resultVal));
+    cv::Mat roi(*result, cv::Rect(posX, posY, width, height));
+    resized.copyTo(roi);
+    frame.setMat(this->result.index, result);
 
     return OK;
 
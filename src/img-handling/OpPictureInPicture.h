@@ -25,8 +25,11 @@ class OpPictureInPicture : public ImgOperator {
 public:
     OpPictureInPicture();
     virtual ~OpPictureInPicture();
+    virtual void bind(ImgFrame &frame);
 protected:
-    virtual uint8_t process(unordered_map<string,shared_ptr<Value>> &results);
+    shared_ptr<ValInt> scale, posX, posY;
+    imgSlot result;
+    virtual uint8_t process(ImgFrame &frame);
 };
 
 #endif /* OPPICTUREINPICTURE_H_ */
@@ -14,15 +14,14 @@
  */
 OpPrepare::OpPrepare() : OpComposite(OP_PREPARE) {
 
-    shared_ptr<ImgOperator> encode(new OpEncodeJPEG);
+    shared_ptr<ImgOperator> encode(new OpEncodeRegions);
     shared_ptr<ImgOperator> merge(new OpPictureInPicture);
 
     this->op_append(merge);
     this->op_append(encode);
 
-    stringstream cap;
-    cap << ARG_CAPTURE << (int)0;
-    this->connect(RES_PICTURE_IN_PICTURE, cap.str());
+    // Composed image is input of the encoder, thumbnail source stays bound to capture 1.
+    this->connect(RES_PICTURE_IN_PICTURE, 0);
 
 }
 
@@ -19,6 +19,7 @@
 #include "OpComposite.h"
 #include "ImgOperator.h"
 #include "OpEncodeJPEG.h"
+#include "OpEncodeRegions.h"
 #include "OpPictureInPicture.h"
 #include "../Value.h"
 
@@ -29,6 +29,27 @@ Config::Config(string path) : file(path) {
     this->deferred.target="localhost";
     this->deferred.port="3001";
 
+    // Network payload compression.
+    this->nwComp=1;
+
+    // Network payload acknowledgement.
+    this->nwWindow=64;
+
+    // Network transmit policy.
+    this->nwTx.mode=T_NODELAY;
+    this->nwTx.bandwidth=0;
+    this->nwTx.rtt=0;
+    this->nwTx.lowat=0;
+
+    // Network send rate budgets.
+    this->nwShapeImage.rate=0;
+    this->nwShapeImage.burst=0;
+    this->nwShapeTelemetry.rate=0;
+    this->nwShapeTelemetry.burst=0;
+
+    // Network TLS settings.
+    this->nwTls.offload=false;
+
     // Inner vehicle camera.
     this->inner.index=0;
     this->inner.fps=10;
@@ -40,6 +61,9 @@ Config::Config(string path) : file(path) {
     // Members for image compression.
     this->capPrimary=0;
     this->comp=100;
+    this->roiComp=100;
+    this->stream.bitrate=0;
+    this->stream.gop=0;
 
     // Accelerometer struct and type.
     this->acc.path="i2c-4";
@@ -156,7 +180,25 @@ bool Config::getDeferred(server &serv) {
 
     if (this->parsed.find(OPT_DEF_ADDR) != this->parsed.end() &&
             this->parsed.find(OPT_DEF_IFACE) != this->parsed.end()) {
-        serv=this->realtime;
+        serv=this->deferred;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for deferred server log.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param log The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getDeferredLog(storage &log) {
+
+    if (this->parsed.find(OPT_DEF_LOG) != this->parsed.end()) {
+        log=this->deferredLog;
         return true;
     }
 
@@ -217,6 +259,116 @@ bool Config::getPrimeCap(uint8_t &index) {
     return false;
 }
 
+/** \brief Getter for network compression.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param level The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getNetworkCompression(uint8_t &level) {
+
+    if (this->parsed.find(OPT_NW_COMP) != this->parsed.end()) {
+        level=this->nwComp;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for network window.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param window The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getNetworkWindow(uint16_t &window) {
+
+    if (this->parsed.find(OPT_NW_WINDOW) != this->parsed.end()) {
+        window=this->nwWindow;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for network statistics.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param stats The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getNetworkStats(storage &stats) {
+
+    if (this->parsed.find(OPT_NW_STATS) != this->parsed.end()) {
+        stats=this->nwStats;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for network transmit policy.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param tx The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getNetworkTransmit(transmit &tx) {
+
+    if (this->parsed.find(OPT_NW_TX) != this->parsed.end()) {
+        tx=this->nwTx;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for network send rate budgets.
+ *
+ *  Writes option to parameters.
+ *  Returns success state.
+ *
+ *  \param image The parameter to write the image budget to.
+ *  \param telemetry The parameter to write the telemetry budget to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getNetworkShaping(budget &image, budget &telemetry) {
+
+    if (this->parsed.find(OPT_NW_SHAPE) != this->parsed.end()) {
+        image=this->nwShapeImage;
+        telemetry=this->nwShapeTelemetry;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for network TLS settings.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param tls The parameter to write the TLS settings to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getNetworkSecurity(security &tls) {
+
+    if (this->parsed.find(OPT_NW_TLS) != this->parsed.end()) {
+        tls=this->nwTls;
+        return true;
+    }
+
+    return false;
+}
+
 /** \brief Getter for JPEG compression.
  *
  *  Writes option to parameter.
@@ -235,6 +387,42 @@ bool Config::getJpegCompression(uint8_t &comp) {
     return false;
 }
 
+/** \brief Getter for thumbnail region JPEG compression.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param comp The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getRoiCompression(uint8_t &comp) {
+
+    if (this->parsed.find(OPT_CAP_ROI_COMP) != this->parsed.end()) {
+        comp=this->roiComp;
+        return true;
+    }
+
+    return false;
+}
+
+/** \brief Getter for video stream encoding.
+ *
+ *  Writes option to parameter.
+ *  Returns success state.
+ *
+ *  \param enc The parameter to write the option to.
+ *  \return True on success, false in case of error.
+ */
+bool Config::getStream(encoding &enc) {
+
+    if (this->parsed.find(OPT_CAP_STREAM) != this->parsed.end()) {
+        enc=this->stream;
+        return true;
+    }
+
+    return false;
+}
+
 /** \brief Getter for accelerometer type.
  *
  *  Writes option to parameter.
@@ -601,6 +789,10 @@ void Config::process(string source) {
             else if (EQUALS(tmp[0], 0, OPT_REAL_IFACE))
                 status = procIface(tmp, this->realtime);
 
+            // Extract media channel port of real time server.
+            else if (EQUALS(tmp[0], 0, OPT_REAL_MEDIA))
+                status = procMedia(tmp, this->realtime);
+
             // Extract deferred server data.
             else if (EQUALS(tmp[0], 0, OPT_DEF_ADDR))
                 status = procSvr(tmp, this->deferred);
@@ -609,6 +801,34 @@ void Config::process(string source) {
             else if (EQUALS(tmp[0], 0, OPT_DEF_IFACE))
                 status = procIface(tmp, this->deferred);
 
+            // Extract log of deferred server.
+            else if (EQUALS(tmp[0], 0, OPT_DEF_LOG))
+                status = procStorage(tmp, this->deferredLog);
+
+            // Extract deflate level of network payloads.
+            else if (EQUALS(tmp[0], 0, OPT_NW_COMP))
+                status = procLevel(tmp, this->nwComp);
+
+            // Extract number of unacknowledged network payloads.
+            else if (EQUALS(tmp[0], 0, OPT_NW_WINDOW))
+                status = procWindow(tmp, this->nwWindow);
+
+            // Extract statistics socket and report interval.
+            else if (EQUALS(tmp[0], 0, OPT_NW_STATS))
+                status = procStats(tmp, this->nwStats);
+
+            // Extract transmit policy of server connections.
+            else if (EQUALS(tmp[0], 0, OPT_NW_TX))
+                status = procTransmit(tmp, this->nwTx);
+
+            // Extract send rate budgets.
+            else if (EQUALS(tmp[0], 0, OPT_NW_SHAPE))
+                status = procShaping(tmp, this->nwShapeImage, this->nwShapeTelemetry);
+
+            // Extract TLS settings of server connections.
+            else if (EQUALS(tmp[0], 0, OPT_NW_TLS))
+                status = procSecurity(tmp, this->nwTls);
+
             // Extract index of outer camera.
             else if (EQUALS(tmp[0], 0, OPT_CAP_OUT))
                 status = procCapture(tmp, this->outer);
@@ -625,6 +845,14 @@ void Config::process(string source) {
             else if (EQUALS(tmp[0], 0, OPT_CAP_COMP))
                 status = procCompression(tmp, this->comp);
 
+            // Extract compression rate of thumbnail region.
+            else if (EQUALS(tmp[0], 0, OPT_CAP_ROI_COMP))
+                status = procCompression(tmp, this->roiComp);
+
+            // Extract video stream encoding.
+            else if (EQUALS(tmp[0], 0, OPT_CAP_STREAM))
+                status = procStream(tmp, this->stream);
+
             // Extract gps port data.
             else if (EQUALS(tmp[0], 0, OPT_GPS_DEV))
                 status = procGPS(tmp, this->gps);
@@ -816,6 +1044,61 @@ uint8_t Config::procIface(vector<string> source, server &server) {
     return CONF_OK;
 }
 
+/** \brief Processes media channel options.
+ *
+ *  Parses the UDP port of the media channel from 'source 'and writes it to server.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param server target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procMedia(vector<string> source, server &server) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 2)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    // Convert port string to integer.
+    int64_t value=0;
+    if (!toInteger(source[1], UINT16_MAX, 1, value))
+        return CONF_ERR_INVALID;
+
+    server.media=source[1];
+
+    return CONF_OK;
+}
+
+/** \brief Processes storage options.
+ *
+ *  Parses the log directory and acquisition interval in seconds from 'source 'and writes it to log.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param log target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procStorage(vector<string> source, storage &log) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 3)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    // Only absolute paths are accepted.
+    if (source[1].empty() || source[1][0] != '/')
+        return CONF_ERR_INVALID;
+
+    // Convert interval string to integer.
+    int64_t interval=0;
+    if (!toInteger(source[2], 3600, 1, interval))
+        return CONF_ERR_INVALID;
+
+    log.path=source[1];
+    log.interval=interval;
+
+    return CONF_OK;
+}
+
 /** \brief Processes capture options.
  *
  *  Parses the capture information from 'source 'and writes it to cap.
@@ -904,6 +1187,256 @@ uint8_t Config::procCompression(vector<string> source, uint8_t &comp) {
     return CONF_OK;
 }
 
+/** \brief Processes compression level option.
+ *
+ *  Parses the deflate level option (1 fastest to 9 smallest) from 'source 'and writes it to level.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param level target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procLevel(vector<string> source, uint8_t &level) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 2)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    // Convert level string to integer.
+    int64_t value=0;
+    if (!toInteger(source[1], 9, 1, value))
+        return CONF_ERR_INVALID;
+
+    // Set new value.
+    level = value;
+
+    return CONF_OK;
+}
+
+/** \brief Processes window option.
+ *
+ *  Parses the number of unacknowledged payloads in flight from 'source 'and writes it to window.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param window target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procWindow(vector<string> source, uint16_t &window) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 2)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    // Convert window string to integer.
+    int64_t value=0;
+    if (!toInteger(source[1], UINT16_MAX, 1, value))
+        return CONF_ERR_INVALID;
+
+    // Set new value.
+    window = value;
+
+    return CONF_OK;
+}
+
+/** \brief Processes statistics option.
+ *
+ *  Parses the query socket path and the report interval in seconds from 'source 'and writes it
+ *  to stats. An interval of 0 disables reports to the server.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param stats target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procStats(vector<string> source, storage &stats) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 3)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    // Only absolute paths are accepted.
+    if (source[1].empty() || source[1][0] != '/')
+        return CONF_ERR_INVALID;
+
+    // Convert interval string to integer.
+    int64_t interval=0;
+    if (!toInteger(source[2], 3600, 0, interval))
+        return CONF_ERR_INVALID;
+
+    stats.path=source[1];
+    stats.interval=interval;
+
+    return CONF_OK;
+}
+
+/** \brief Processes transmit option.
+ *
+ *  Parses the batching mode, link bandwidth in kbit/s, round trip time in milliseconds and
+ *  the watermark of unsent bytes from 'source 'and writes it to tx.
+ *  Bandwidth, round trip time and watermark may be 0, if unknown or not wanted.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param tx target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procTransmit(vector<string> source, transmit &tx) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 5)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    transmit result;
+
+    // Convert mode to lower case for comparison robustness.
+    transform(source[1].begin(), source[1].end(), source[1].begin(), ::tolower);
+
+    // Check if given mode is known.
+    if (EQUALS(source[1], 0, TX_MODE_NODELAY))
+        result.mode=T_NODELAY;
+    else if (EQUALS(source[1], 0, TX_MODE_CORK))
+        result.mode=T_CORK;
+    else if (EQUALS(source[1], 0, TX_MODE_MORE))
+        result.mode=T_MORE;
+    else
+        return CONF_ERR_INVALID;
+
+    // Convert bandwidth string to integer.
+    int64_t value=0;
+    if (!toInteger(source[2], 10000000, 0, value))
+        return CONF_ERR_INVALID;
+
+    result.bandwidth=value;
+
+    // Convert round trip time string to integer.
+    if (!toInteger(source[3], 10000, 0, value))
+        return CONF_ERR_INVALID;
+
+    result.rtt=value;
+
+    // Convert watermark string to integer.
+    if (!toInteger(source[4], INT32_MAX, 0, value))
+        return CONF_ERR_INVALID;
+
+    result.lowat=value;
+
+    // Set new value.
+    tx = result;
+
+    return CONF_OK;
+}
+
+/** \brief Processes send rate option.
+ *
+ *  Parses rate in kbit/s and burst allowance in kB of image traffic, followed by the same
+ *  for telemetry traffic, from 'source' and writes them to image and telemetry.
+ *  A rate of 0 does not limit the class, a burst of 0 allows one second at its rate.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param image target to write the image budget to.
+ *  \param telemetry target to write the telemetry budget to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procShaping(vector<string> source, budget &image, budget &telemetry) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 5)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    // Convert rates and bursts to integers, rates up to 10 Gbit/s, bursts up to 1 GB.
+    int64_t values[4];
+    for (uint8_t index=0; index < 4; index++)
+        if (!toInteger(source[index+1], index % 2 ? 1000000 : 10000000, 0, values[index]))
+            return CONF_ERR_INVALID;
+
+    // Set new values.
+    image.rate=values[0];
+    image.burst=values[1];
+    telemetry.rate=values[2];
+    telemetry.burst=values[3];
+
+    return CONF_OK;
+}
+
+/** \brief Processes TLS option.
+ *
+ *  Parses the file of trusted certificates, or "system" for those of the system,
+ *  and whether the kernel should encrypt (0 or 1) from 'source' and writes them to tls.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param tls target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procSecurity(vector<string> source, security &tls) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 3)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    security result;
+
+    // Only absolute paths are accepted.
+    if (!source[1].compare(TLS_CA_SYSTEM))
+        result.caFile="";
+    else if (!source[1].empty() && source[1][0] == '/')
+        result.caFile=source[1];
+    else
+        return CONF_ERR_INVALID;
+
+    // Convert offload flag string to integer.
+    int64_t offload=0;
+    if (!toInteger(source[2], 1, 0, offload))
+        return CONF_ERR_INVALID;
+
+    result.offload=offload;
+
+    // Set new value.
+    tls = result;
+
+    return CONF_OK;
+}
+
+/** \brief Processes video stream option.
+ *
+ *  Parses the stream option (codec, bitrate in kbit/s, keyframe interval)
+ *  from 'source 'and writes it to enc.
+ *  Returns status indicator.
+ *
+ *  \param source Vector containing the option key-value tuple.
+ *  \param enc target to write to.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t Config::procStream(vector<string> source, encoding &enc) {
+
+    // Check if number of tokens matches.
+    if (source.size() != 4)
+        return CONF_ERR_COUNT_MISMATCH;
+
+    encoding result;
+    result.codec = source[1];
+
+    // Convert bitrate string to integer.
+    int64_t value=0;
+    if (!toInteger(source[2], 100000, 1, value))
+        return CONF_ERR_INVALID;
+
+    result.bitrate=value*1000;
+
+    // Convert keyframe interval string to integer.
+    if (!toInteger(source[3], UINT16_MAX, 1, value))
+        return CONF_ERR_INVALID;
+
+    result.gop=value;
+
+    // Set new value.
+    enc = result;
+
+    return CONF_OK;
+}
+
 /** \brief Processes accelerometer options.
  *
  *  Parses the accelerometer options from 'source 'and writes it to acc.
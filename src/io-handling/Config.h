@@ -18,12 +18,22 @@
 #define OPT_OBU_ID      "obu-id"
 #define OPT_REAL_ADDR   "rt-addr"
 #define OPT_REAL_IFACE  "rt-iface"
+#define OPT_REAL_MEDIA  "rt-media"
 #define OPT_DEF_ADDR    "def-addr"
 #define OPT_DEF_IFACE   "def-iface"
+#define OPT_DEF_LOG     "def-log"
+#define OPT_NW_COMP     "nw-comp"
+#define OPT_NW_WINDOW   "nw-window"
+#define OPT_NW_STATS    "nw-stats"
+#define OPT_NW_TX       "nw-tx"
+#define OPT_NW_SHAPE    "nw-shape"
+#define OPT_NW_TLS      "nw-tls"
 #define OPT_CAP_OUT     "cap-out"
 #define OPT_CAP_IN      "cap-in"
 #define OPT_CAP_PRIME   "cap-prime"
 #define OPT_CAP_COMP    "cap-comp"
+#define OPT_CAP_ROI_COMP "cap-roi-comp"
+#define OPT_CAP_STREAM  "cap-stream"
 #define OPT_GPS_DEV     "gps-dev"
 #define OPT_GPS_TYPE    "gps-type"
 #define OPT_ACC_DEV     "acc-dev"
@@ -34,6 +44,12 @@
 
 #define ACC_MPU6050     "mpu6050"
 
+#define TX_MODE_NODELAY "nodelay"
+#define TX_MODE_CORK    "cork"
+#define TX_MODE_MORE    "more"
+
+#define TLS_CA_SYSTEM   "system"
+
 #include "instances/IOfile.h"
 
 #include <algorithm>
@@ -66,6 +82,12 @@ typedef enum {
     T_MPU6050
 }accTypes;
 
+typedef enum {
+    T_NODELAY,
+    T_CORK,
+    T_MORE
+}txModes;
+
 typedef struct terminal {
     string path;
     uint32_t baud;
@@ -75,13 +97,42 @@ typedef struct server {
     string target;
     string port;
     string iface;
+    string media;   // UDP port of the media channel, empty if there is none.
 }server;
 
+typedef struct storage {
+    string path;
+    uint16_t interval;
+}storage;
+
+typedef struct transmit {
+    uint8_t mode;       // Batching of bursts, see txModes.
+    uint32_t bandwidth; // Link bandwidth in kbit/s, 0 if unknown.
+    uint16_t rtt;       // Round trip time in milliseconds, 0 if unknown.
+    uint32_t lowat;     // Unsent bytes the kernel may hold, 0 for no limit.
+}transmit;
+
+typedef struct budget {
+    uint32_t rate;      // Send rate in kbit/s, 0 if not limited.
+    uint32_t burst;     // Burst allowance in kB, 0 for one second at 'rate'.
+}budget;
+
+typedef struct security {
+    string caFile;      // Trusted certificates, empty for those of the system.
+    bool offload;       // Whether the kernel should encrypt, if supported.
+}security;
+
 typedef struct capture {
     uint8_t index;
     uint8_t fps;
 }capture;
 
+typedef struct encoding {
+    string codec;
+    uint32_t bitrate;
+    uint16_t gop;
+}encoding;
+
 typedef struct i2cDev {
     string path;
     uint8_t addr;
@@ -110,10 +161,19 @@ public:
     bool getTermAt(uint8_t index, terminal &term);
     bool getRealTime(server &serv);
     bool getDeferred(server &serv);
+    bool getDeferredLog(storage &log);
+    bool getNetworkCompression(uint8_t &level);
+    bool getNetworkWindow(uint16_t &window);
+    bool getNetworkStats(storage &stats);
+    bool getNetworkTransmit(transmit &tx);
+    bool getNetworkShaping(budget &image, budget &telemetry);
+    bool getNetworkSecurity(security &tls);
     bool getInnerCap(capture &cap);
     bool getOuterCap(capture &cap);
     bool getPrimeCap(uint8_t &index);
     bool getJpegCompression(uint8_t &comp);
+    bool getRoiCompression(uint8_t &comp);
+    bool getStream(encoding &enc);
     bool getAccType(uint8_t &type);
     bool getAcc(i2cDev &dev);
     bool getGPSType(uint8_t &type);
@@ -140,12 +200,36 @@ private:
     // Realtime / deferred server properties.
     server realtime, deferred;
 
+    // Store-and-forward log of the deferred server, optional.
+    storage deferredLog;
+
+    // Deflate level of network payloads, optional.
+    uint8_t nwComp;
+
+    // Unacknowledged payloads in flight, optional.
+    uint16_t nwWindow;
+
+    // Statistics query socket and report interval, optional.
+    storage nwStats;
+
+    // Transmit policy of server connections, optional.
+    transmit nwTx;
+
+    // Send rate budgets of image and telemetry traffic, optional.
+    budget nwShapeImage, nwShapeTelemetry;
+
+    // TLS settings of server connections, optional.
+    security nwTls;
+
     // Capture structures and primary capture index.
     capture outer, inner;
     uint8_t capPrimary;
 
-    // JPEG compression quality.
-    uint8_t comp;
+    // JPEG compression quality, for the whole image and the thumbnail region.
+    uint8_t comp, roiComp;
+
+    // Video stream encoding, optional.
+    encoding stream;
 
     // Accelerometer (typically i2c)
     uint8_t accType;
@@ -171,9 +255,18 @@ private:
     static uint8_t procTerm(vector<string> source, terminal &term);
     static uint8_t procSvr(vector<string> source, server &server);
     static uint8_t procIface(vector<string> source, server &server);
+    static uint8_t procMedia(vector<string> source, server &server);
+    static uint8_t procStorage(vector<string> source, storage &log);
+    static uint8_t procLevel(vector<string> source, uint8_t &level);
+    static uint8_t procWindow(vector<string> source, uint16_t &window);
+    static uint8_t procStats(vector<string> source, storage &stats);
+    static uint8_t procTransmit(vector<string> source, transmit &tx);
+    static uint8_t procShaping(vector<string> source, budget &image, budget &telemetry);
+    static uint8_t procSecurity(vector<string> source, security &tls);
     static uint8_t procCapture(vector<string> source, capture &capture);
     static uint8_t procPrimary(vector<string> source, uint8_t &prime);
     static uint8_t procCompression(vector<string> source, uint8_t &comp);
+    static uint8_t procStream(vector<string> source, encoding &enc);
     static uint8_t procAcc(vector<string> source, i2cDev &acc);
     static uint8_t procAccType(vector<string> source, uint8_t &accType);
     static uint8_t procGPS(vector<string> source, uartDev &gps);
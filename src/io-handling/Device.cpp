@@ -24,9 +24,9 @@ Device::~Device() { }
 
 /** \brief Add value to results.
  *
- *  Add 'value' with key 'key' to 'values'.
+ *  Add 'value' with key 'key' to 'values'. Values which could not be measured are NAN.
  */
-void Device::addValue(unordered_map<string, string> &values, string key, string value) {
+void Device::addValue(unordered_map<string, double> &values, string key, double value) {
 
     // Iterator to the key-th position in the map.
     auto it = values.find(key);
@@ -40,6 +40,15 @@ void Device::addValue(unordered_map<string, string> &values, string key, string
         it->second = value;
 }
 
+/** \brief Get recorded samples.
+ *
+ *  Moves the samples recorded since the last call to 'samples'.
+ *  Devices without full rate recording do not add anything.
+ *
+ *  \param samples The target to append the samples to.
+ */
+void Device::getSamples(vector<imuSample> &samples) { }
+
 /** \brief Sets termination flag.
  *
  *  Sets termination flag.
@@ -31,12 +31,24 @@
 #define OBD_FUEL_PRESS  "fuel pressure"
 #define OBD_ENG_KM      "distance"
 
+#define SAMPLE_CHANNELS 6   // Acceleration x, y, z and rotation x, y, z.
+
+#include <cmath>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include <cstdint>
 
 using namespace std;
 
+/** Timestamped motion sample, time in milliseconds since epoch. */
+typedef struct imuSample {
+    int64_t time;
+    int16_t values[SAMPLE_CHANNELS];
+}imuSample;
+
 class Device {
 public:
 
@@ -47,11 +59,12 @@ public:
     void terminate();
     bool isTerminating();
 
-    virtual void getValues(unordered_map<string, string> &values)=0;
+    virtual void getValues(unordered_map<string, double> &values)=0;
+    virtual void getSamples(vector<imuSample> &samples);
 
 protected:
 
-    static void addValue(unordered_map<string, string> &values, string key, string value);
+    static void addValue(unordered_map<string, double> &values, string key, double value);
 
 private:
 
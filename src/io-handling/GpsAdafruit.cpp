@@ -49,9 +49,9 @@ int GpsAdafruit::run() {
 
                 // Add results to list.
                 this->rw_mutex.lock();
-                this->addValue(this->values, GPS_POS_LAT, target.latVal+target.latNS);
-                this->addValue(this->values, GPS_POS_LONG, target.longVal+target.longEW);
-                this->addValue(this->values, GPS_POS_HEIGHT, target.height+target.hUnit);
+                this->addValue(this->values, GPS_POS_LAT, NmeaParser::toDegrees(target.latVal+target.latNS));
+                this->addValue(this->values, GPS_POS_LONG, NmeaParser::toDegrees(target.longVal+target.longEW));
+                this->addValue(this->values, GPS_POS_HEIGHT, NmeaParser::toNumber(target.height));
                 this->rw_mutex.unlock();
 
             }
@@ -67,7 +67,7 @@ int GpsAdafruit::run() {
  *
  *  \param values The target to write the results to.
  */
-void GpsAdafruit::getValues(unordered_map<string, string> &values) {
+void GpsAdafruit::getValues(unordered_map<string, double> &values) {
 
     this->rw_mutex.lock();
 
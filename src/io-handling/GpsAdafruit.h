@@ -51,7 +51,7 @@ public:
     virtual ~GpsAdafruit();
 
     virtual int run();
-    virtual void getValues(unordered_map<string, string> &values);
+    virtual void getValues(unordered_map<string, double> &values);
 
     uint8_t initialize();
 
@@ -77,7 +77,7 @@ private:
     IOserial device;
 
     // Last known data.
-    unordered_map<string, string> values;
+    unordered_map<string, double> values;
 
     // Data access mutex.
     mutex rw_mutex;
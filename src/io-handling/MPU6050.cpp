@@ -63,12 +63,20 @@ int MPU6050::run() {
         getMotion6(&tmp_ax, &tmp_ay, &tmp_az, &tmp_gx, &tmp_gy, &tmp_gz);
         
         this->rw_mutex.lock();
-        this->addValue(this->values, ACC_X, to_string(tmp_ax));
-        this->addValue(this->values, ACC_Y, to_string(tmp_ay));
-        this->addValue(this->values, ACC_Z, to_string(tmp_az));
-        this->addValue(this->values, GYRO_X, to_string(tmp_gx));
-        this->addValue(this->values, GYRO_Y, to_string(tmp_gy));
-        this->addValue(this->values, GYRO_Z, to_string(tmp_gz));
+        this->addValue(this->values, ACC_X, tmp_ax);
+        this->addValue(this->values, ACC_Y, tmp_ay);
+        this->addValue(this->values, ACC_Z, tmp_az);
+        this->addValue(this->values, GYRO_X, tmp_gx);
+        this->addValue(this->values, GYRO_Y, tmp_gy);
+        this->addValue(this->values, GYRO_Z, tmp_gz);
+
+        // Record sample at full rate.
+        imuSample sample = { chrono::duration_cast<chrono::milliseconds>(
+                chrono::system_clock::now().time_since_epoch()).count(),
+                { tmp_ax, tmp_ay, tmp_az, tmp_gx, tmp_gy, tmp_gz } };
+        this->samples.push_back(sample);
+        if (this->samples.size() > MPU6050_MAX_SAMPLES)
+            this->samples.pop_front();
         this->rw_mutex.unlock();
 
         usleep(10000);
@@ -78,7 +86,7 @@ int MPU6050::run() {
     return 0;
 }
 
-void MPU6050::getValues(unordered_map<string, string> &values) {
+void MPU6050::getValues(unordered_map<string, double> &values) {
 
     this->rw_mutex.lock();
 
@@ -115,6 +123,14 @@ void MPU6050::getValues(unordered_map<string, string> &values) {
     this->rw_mutex.unlock();
 }
 
+void MPU6050::getSamples(vector<imuSample> &samples) {
+
+    this->rw_mutex.lock();
+    samples.insert(samples.end(), this->samples.begin(), this->samples.end());
+    this->samples.clear();
+    this->rw_mutex.unlock();
+}
+
 void MPU6050::setAddr(uint8_t devAddr) {
     this->devAddr = devAddr;
 }
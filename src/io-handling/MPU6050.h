@@ -51,6 +51,10 @@ THE SOFTWARE.
 #include "instances/IOi2cBus.h"
 #include "Device.h"
 
+#define MPU6050_MAX_SAMPLES 1000    // Recorded samples kept until read, the oldest are dropped.
+
+#include <chrono>
+#include <deque>
 #include <mutex>
 #include <memory>
 #include <string>
@@ -426,7 +430,8 @@ public:
     bool testConnection();
 
     virtual int run();
-    virtual void getValues(unordered_map<string, string> &values);
+    virtual void getValues(unordered_map<string, double> &values);
+    virtual void getSamples(vector<imuSample> &samples);
     // void getData(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz);
 
     void setAddr(uint8_t devAddr);
@@ -483,8 +488,9 @@ private:
     int16_t gx, gy, gz;
      */
 
-    // Last known data.
-    unordered_map<string, string> values;
+    // Last known data and samples recorded since last read.
+    unordered_map<string, double> values;
+    deque<imuSample> samples;
 
     shared_ptr<IOi2cBus> bus;
 
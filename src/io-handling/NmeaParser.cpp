@@ -50,6 +50,57 @@ uint8_t NmeaParser::parseGGA(string source, gga &dataset) {
     return PARSE_OK;
 }
 
+/** \brief Converts coordinate to degrees.
+ *
+ *  Converts coordinate 'source' in NMEA format (degrees and minutes, followed by the hemisphere,
+ *  e.g. "4807.038N") to signed decimal degrees.
+ *
+ *  \param source Coordinate string.
+ *  \return Coordinate in degrees, NAN if 'source' is empty or invalid.
+ */
+double NmeaParser::toDegrees(string source) {
+
+    if (source.size() < 2)
+        return NAN;
+
+    char *parsed;
+    double value = strtod(source.c_str(), &parsed);
+    if (parsed == source.c_str())
+        return NAN;
+
+    // Split degrees and minutes.
+    double degrees = floor(value / 100);
+    degrees += (value - degrees*100) / 60;
+
+    switch (source[source.size()-1]) {
+    case 'N':
+    case 'E':
+        return degrees;
+    case 'S':
+    case 'W':
+        return -degrees;
+    default:
+        return NAN;
+    }
+}
+
+/** \brief Converts number.
+ *
+ *  Converts number 'source', which may be followed by a unit (e.g. "545.4M").
+ *
+ *  \param source Number string.
+ *  \return The number, NAN if 'source' is empty or invalid.
+ */
+double NmeaParser::toNumber(string source) {
+
+    char *parsed;
+    double value = strtod(source.c_str(), &parsed);
+    if (parsed == source.c_str())
+        return NAN;
+
+    return value;
+}
+
 /** \brief Helper method for tokenizing.
  *
  *  Tokenizes string 'source' by delimiter 'delim' and writes all tokens to 'target'
@@ -8,6 +8,8 @@
 #ifndef NMEAPARSER_H_
 #define NMEAPARSER_H_
 
+#include <cmath>
+#include <cstdlib>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -41,6 +43,8 @@ class NmeaParser {
 public:
 
     static uint8_t parseGGA(string source, gga &dataset);
+    static double toDegrees(string source);
+    static double toNumber(string source);
 
 private:
 
@@ -69,23 +69,23 @@ int OBDReader::run() {
         usleep(SLEEP_DURATION);
 
         this->rw_mutex.lock();
-        this->addValue(this->values, OBD_SPEED, speed>=0?to_string(speed):"--");
-        this->addValue(this->values, OBD_RPM, rpm>=0?to_string(rpm):"--");
-        this->addValue(this->values, OBD_ENG_LOAD, load>=0?to_string(load):"--");
-        this->addValue(this->values, OBD_COOL_TEMP, coolTemp>=0?to_string(coolTemp):"--");
-        this->addValue(this->values, OBD_AIR_FLOW, airFlow>=0?to_string(airFlow):"--");
-        this->addValue(this->values, OBD_INLET_PRESS, inletAirPress>=0?to_string(inletAirPress):"--");
-        this->addValue(this->values, OBD_INLET_TEMP, inletAirTemp>=0?to_string(inletAirTemp):"--");
-        this->addValue(this->values, OBD_FUEL_LVL, fuelLev>=0?to_string(fuelLev):"--");
-        this->addValue(this->values, OBD_FUEL_PRESS, fuelPress>=0?to_string(fuelPress):"--");
-        this->addValue(this->values, OBD_ENG_KM, dist>=0?to_string(dist):"--");
+        this->addValue(this->values, OBD_SPEED, speed>=0?speed:NAN);
+        this->addValue(this->values, OBD_RPM, rpm>=0?rpm:NAN);
+        this->addValue(this->values, OBD_ENG_LOAD, load>=0?load:NAN);
+        this->addValue(this->values, OBD_COOL_TEMP, coolTemp>=0?coolTemp:NAN);
+        this->addValue(this->values, OBD_AIR_FLOW, airFlow>=0?airFlow:NAN);
+        this->addValue(this->values, OBD_INLET_PRESS, inletAirPress>=0?inletAirPress:NAN);
+        this->addValue(this->values, OBD_INLET_TEMP, inletAirTemp>=0?inletAirTemp:NAN);
+        this->addValue(this->values, OBD_FUEL_LVL, fuelLev>=0?fuelLev:NAN);
+        this->addValue(this->values, OBD_FUEL_PRESS, fuelPress>=0?fuelPress:NAN);
+        this->addValue(this->values, OBD_ENG_KM, dist>=0?dist:NAN);
         this->rw_mutex.unlock();
     }
 
     return 0;
 }
 
-void OBDReader::getValues(unordered_map<string, string> &values) {
+void OBDReader::getValues(unordered_map<string, double> &values) {
 
     this->rw_mutex.lock();
 
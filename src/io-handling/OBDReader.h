@@ -46,7 +46,7 @@ public:
 	virtual ~OBDReader();
 
     virtual int run();
-    virtual void getValues(unordered_map<string, string> &values);
+    virtual void getValues(unordered_map<string, double> &values);
 
 	//functions for setting up the adapter
 	uint8_t reset();
@@ -73,7 +73,7 @@ private:
 	IOserial device;
 
     // Last known data.
-    unordered_map<string, string> values;
+    unordered_map<string, double> values;
 
     // Data access mutex.
     mutex rw_mutex;
@@ -0,0 +1,122 @@
+/** \brief      Batch of motion samples.
+ *
+ * \details     Collects timestamped motion samples and encodes them compactly, while they are added.
+ *              The batch begins with the number of channels per sample. Each sample follows as
+ *              the difference of its time and channel values to the previous sample (to 0 for the
+ *              first one), each difference zig-zag mapped to unsigned and written as varint with
+ *              7 bits per byte, least significant first. Steady signals so take one or two bytes
+ *              per value instead of the full width.
+ *              A batch is due once it holds enough samples or bytes, or its first sample got too old.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       SampleBatch
+ */
+
+#include "SampleBatch.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of SampleBatch instances.
+ *
+ *  \param maxCount Number of samples the batch is due at.
+ *  \param maxAge Age in milliseconds of the first sample the batch is due at.
+ */
+SampleBatch::SampleBatch(uint16_t maxCount, uint32_t maxAge) {
+
+    this->maxCount=maxCount;
+    this->maxAge=maxAge;
+    this->count=0;
+    this->data=shared_ptr<vector<uint8_t>>(new vector<uint8_t>);
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of SampleBatch instances.
+ */
+SampleBatch::~SampleBatch() { }
+
+/** \brief Appends sample.
+ *
+ *  Encodes 'sample' against the previous sample and appends it to the batch.
+ *
+ *  \param sample The sample to append.
+ */
+void SampleBatch::append(const imuSample &sample) {
+
+    // Start new batch.
+    if (!this->count) {
+        this->data->push_back(SAMPLE_CHANNELS);
+        this->previous = imuSample();
+        this->started = chrono::steady_clock::now();
+    }
+
+    appendVarint(sample.time - this->previous.time);
+    for (uint8_t channel=0; channel < SAMPLE_CHANNELS; channel++)
+        appendVarint((int64_t)sample.values[channel] - this->previous.values[channel]);
+
+    this->previous = sample;
+    this->count++;
+}
+
+/** \brief Getter for sample count.
+ *
+ *  Returns the number of samples in the batch.
+ *
+ *  \return Number of samples.
+ */
+uint16_t SampleBatch::getCount() {
+    return this->count;
+}
+
+/** \brief Checks whether the batch is due.
+ *
+ *  Returns whether the batch reached its size limits or its first sample is too old.
+ *
+ *  \return true if the batch should be sent, false otherwise.
+ */
+bool SampleBatch::isDue() {
+
+    if (!this->count)
+        return false;
+
+    if (this->count >= this->maxCount || this->data->size() >= SAMPLE_BATCH_BYTES)
+        return true;
+
+    auto age = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - this->started);
+    return age.count() >= this->maxAge;
+}
+
+/** \brief Takes encoded batch.
+ *
+ *  Returns the encoded samples and starts a new batch.
+ *
+ *  \return The encoded batch, empty if there are no samples.
+ */
+shared_ptr<vector<uint8_t>> SampleBatch::take() {
+
+    shared_ptr<vector<uint8_t>> result = this->data;
+
+    this->data=shared_ptr<vector<uint8_t>>(new vector<uint8_t>);
+    this->data->reserve(result->size());
+    this->count=0;
+
+    return result;
+}
+
+/** \brief Appends signed varint.
+ *
+ *  Zig-zag maps 'value' to unsigned, so small magnitudes get small codes, and appends it
+ *  as varint.
+ *
+ *  \param value The value to append.
+ */
+void SampleBatch::appendVarint(int64_t value) {
+
+    uint64_t code = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+
+    while (code >= 0x80) {
+        this->data->push_back((uint8_t)(code | 0x80));
+        code >>= 7;
+    }
+    this->data->push_back((uint8_t)code);
+}
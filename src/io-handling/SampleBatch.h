@@ -0,0 +1,45 @@
+/*
+ * SampleBatch.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef SAMPLEBATCH_H_
+#define SAMPLEBATCH_H_
+
+#define SAMPLE_BATCH_COUNT  100     // Samples per batch.
+#define SAMPLE_BATCH_BYTES  1400    // Encoded bytes per batch.
+#define SAMPLE_BATCH_AGE    1000    // Milliseconds.
+
+#include "Device.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <cstdint>
+
+class SampleBatch {
+public:
+    SampleBatch(uint16_t maxCount=SAMPLE_BATCH_COUNT, uint32_t maxAge=SAMPLE_BATCH_AGE);
+    virtual ~SampleBatch();
+
+    void append(const imuSample &sample);
+    uint16_t getCount();
+    bool isDue();
+    shared_ptr<vector<uint8_t>> take();
+
+private:
+    uint16_t maxCount, count;
+    uint32_t maxAge;
+
+    // Encoded samples and the sample the next one is encoded against.
+    shared_ptr<vector<uint8_t>> data;
+    imuSample previous;
+    chrono::steady_clock::time_point started;
+
+    void appendVarint(int64_t value);
+};
+
+#endif /* SAMPLEBATCH_H_ */
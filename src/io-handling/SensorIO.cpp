@@ -34,14 +34,27 @@ int SensorIO::run() {
     // Infinite run loop.
     while(!this->isTerminating()){
 
-        unordered_map<string, string> results;
+        unordered_map<string, double> results;
+        vector<imuSample> samples;
 
-        for (auto current : this->devices)
+        for (auto current : this->devices) {
             current->getValues(results);
+            current->getSamples(samples);
+        }
 
         this->io_mutex.lock();
         this->data=results;
         this->io_mutex.unlock();
+
+        // Batch full-rate samples and pass due batches to the module.
+        for (auto &sample : samples) {
+            this->batch.append(sample);
+            if (this->batch.isDue())
+                this->passBatch();
+        }
+
+        if (this->batch.isDue())
+            this->passBatch();
     }
 
     // Call terminate on all children.
@@ -56,6 +69,17 @@ int SensorIO::run() {
     return 0;
 }
 
+/** \brief Passes sample batch to module.
+ *
+ *  Takes the encoded samples of the current batch and pushes them as message to the module.
+ */
+void SensorIO::passBatch() {
+
+    shared_ptr<M2C_Samples> msg(new M2C_Samples);
+    msg->setValue(ARG_SAMPLES, shared_ptr<ValVectorUChar>(new ValVectorUChar(this->batch.take())));
+    this->in_push(msg);
+}
+
 bool SensorIO::append(shared_ptr<Device> device) {
 
     if (device) {
@@ -72,8 +96,8 @@ void SensorIO::clear() {
     this->devices.clear();
 }
 
-unordered_map<string, string> SensorIO::getData() {
-    unordered_map<string, string> result;
+unordered_map<string, double> SensorIO::getData() {
+    unordered_map<string, double> result;
     this->io_mutex.lock();
     result=this->data;
     this->io_mutex.unlock();
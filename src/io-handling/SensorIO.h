@@ -10,6 +10,7 @@
 
 #include "../Child.h"
 #include "Device.h"
+#include "SampleBatch.h"
 
 #include <mutex>
 #include <memory>
@@ -29,7 +30,7 @@ public:
 
     virtual int run();
 
-    unordered_map<string, string> getData();
+    unordered_map<string, double> getData();
 
 private:
 
@@ -37,10 +38,15 @@ private:
     mutex io_mutex;
 
     // Latest data set.
-    unordered_map<string, string> data;
+    unordered_map<string, double> data;
+
+    // Full-rate samples not yet passed to the module.
+    SampleBatch batch;
 
     vector<shared_ptr<Device>> devices;
     unordered_set<shared_ptr<thread>> threads;
+
+    void passBatch();
 };
 
 #endif /* SENSORIO_H_ */
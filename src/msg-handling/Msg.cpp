@@ -75,26 +75,27 @@ M2M_DataSet::M2M_DataSet() : Message_M2M(MSG_DATA_INCOMPLETE){
     cerr << "\033[1;31m M2M_DataSet \033[0m: created ("<<this<<")" << endl;
 
     createValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
-    createValue(ARG_POS_E, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_N, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_H, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Z, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Z, shared_ptr<ValString>(new ValString));
-
-    createValue(ARG_OBD_SPEED, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_RPM, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_KM, shared_ptr<ValString>(new ValString));
+    createValue(ARG_STREAM, shared_ptr<ValVectorUChar>(new ValVectorUChar));
+    createValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_H, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Z, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Z, shared_ptr<ValDouble>(new ValDouble));
+
+    createValue(ARG_OBD_SPEED, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_RPM, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_KM, shared_ptr<ValDouble>(new ValDouble));
 }
 
 M2M_DataSet::~M2M_DataSet() { }
@@ -111,8 +112,8 @@ M2M_Event::M2M_Event() : Message_M2M(MSG_EVENT){
 
     createValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
     createValue(ARG_EVT_TYPE, shared_ptr<ValInt>(new ValInt));
-    createValue(ARG_POS_N, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_E, shared_ptr<ValString>(new ValString));
+    createValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble));
 }
 
 M2M_Event::~M2M_Event() { }
@@ -122,26 +123,26 @@ M2M_EventDataSet::M2M_EventDataSet() : Message_M2M(MSG_EVENT_INCOMPLETE) {
     cerr << "\033[1;31m M2M_EventDataSet \033[0m: created ("<<this<<")" << endl;
 
     createValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
-    createValue(ARG_POS_E, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_N, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_H, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Z, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Z, shared_ptr<ValString>(new ValString));
-
-    createValue(ARG_OBD_SPEED, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_RPM, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_KM, shared_ptr<ValString>(new ValString));
+    createValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_H, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Z, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Z, shared_ptr<ValDouble>(new ValDouble));
+
+    createValue(ARG_OBD_SPEED, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_RPM, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_KM, shared_ptr<ValDouble>(new ValDouble));
 }
 
 M2M_EventDataSet::~M2M_EventDataSet() { }
@@ -160,6 +161,16 @@ M2M_Command::~M2M_Command() {
 }
 
 
+// ------------- Motion sample batch message class ------------- //
+
+M2M_Samples::M2M_Samples() : Message_M2M(MSG_SAMPLES) {
+
+    createValue(ARG_SAMPLES, shared_ptr<ValVectorUChar>(new ValVectorUChar));
+}
+
+M2M_Samples::~M2M_Samples() { }
+
+
 // ------------- MODULE-TO-CHILD COMMUNICATION ------------- //
 // ------------- General M2C communication class ------------- //
 
@@ -201,26 +212,27 @@ M2C_DataSet::M2C_DataSet() : Message_M2C(MSG_DATA_INCOMPLETE){
 
     cerr << "\033[1;31m M2C_DataSet \033[0m: created ("<<this<<")" << endl;
     createValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
-    createValue(ARG_POS_E, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_N, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_H, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Z, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Z, shared_ptr<ValString>(new ValString));
-
-    createValue(ARG_OBD_SPEED, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_RPM, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_KM, shared_ptr<ValString>(new ValString));
+    createValue(ARG_STREAM, shared_ptr<ValVectorUChar>(new ValVectorUChar));
+    createValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_H, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Z, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Z, shared_ptr<ValDouble>(new ValDouble));
+
+    createValue(ARG_OBD_SPEED, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_RPM, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_KM, shared_ptr<ValDouble>(new ValDouble));
 
 }
 
@@ -255,11 +267,11 @@ M2C_Event::M2C_Event() : Message_M2C(MSG_EVENT){
 
     createValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
     createValue(ARG_EVT_TYPE, shared_ptr<ValInt>(new ValInt));
-    createValue(ARG_POS_N, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_E, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Z, shared_ptr<ValString>(new ValString));
+    createValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Z, shared_ptr<ValDouble>(new ValDouble));
 }
 
 M2C_Event::~M2C_Event() { }
@@ -272,26 +284,26 @@ M2C_EventDataSet::M2C_EventDataSet() : Message_M2C(MSG_EVENT_INCOMPLETE){
 
     cerr << "\033[1;31m M2C_EventDataSet \033[0m: created ("<<this<<")" << endl;
     createValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar));
-    createValue(ARG_POS_E, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_N, shared_ptr<ValString>(new ValString));
-    createValue(ARG_POS_H, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_ACC_Z, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_X, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Y, shared_ptr<ValString>(new ValString));
-    createValue(ARG_GYRO_Z, shared_ptr<ValString>(new ValString));
-
-    createValue(ARG_OBD_SPEED, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_RPM, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValString>(new ValString));
-    createValue(ARG_OBD_ENG_KM, shared_ptr<ValString>(new ValString));
+    createValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_POS_H, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_ACC_Z, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_X, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Y, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_GYRO_Z, shared_ptr<ValDouble>(new ValDouble));
+
+    createValue(ARG_OBD_SPEED, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_RPM, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_LOAD, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_COOL_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_AIR_FLOW, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_INLET_TEMP, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_LVL, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_FUEL_PRESS, shared_ptr<ValDouble>(new ValDouble));
+    createValue(ARG_OBD_ENG_KM, shared_ptr<ValDouble>(new ValDouble));
 
 }
 
@@ -313,6 +325,36 @@ M2C_Command::M2C_Command() : Message_M2C(MSG_COMMAND) {
 M2C_Command::~M2C_Command() { }
 
 
+// ------------- Motion sample batch message class ------------- //
+
+M2C_Samples::M2C_Samples() : Message_M2C(MSG_SAMPLES) {
+
+    createValue(ARG_SAMPLES, shared_ptr<ValVectorUChar>(new ValVectorUChar));
+}
+
+M2C_Samples::~M2C_Samples() { }
+
+
+// ------------- Stream subscription message class ------------- //
+
+M2C_Subscribe::M2C_Subscribe() : Message_M2C(MSG_SUBSCRIBE) {
+
+    createValue(ARG_INTERVAL, shared_ptr<ValInt>(new ValInt));
+}
+
+M2C_Subscribe::~M2C_Subscribe() { }
+
+
+// ------------- Network statistics message class ------------- //
+
+M2C_Stats::M2C_Stats() : Message_M2C(MSG_STATS) {
+
+    createValue(ARG_STATS, shared_ptr<ValString>(new ValString));
+}
+
+M2C_Stats::~M2C_Stats() { }
+
+
 
 
 
@@ -9,8 +9,12 @@
 #define MESSAGE_H_
 
 #define ARG_ACQUIRED_DATA "Acquired"
+#define ARG_INTERVAL      "Interval"
+#define ARG_STATS         "Statistics"
 
 #define ARG_IMG     "Image"
+#define ARG_STREAM  "Stream"
+#define ARG_SAMPLES "Samples"
 #define ARG_POS_E   "Position East"
 #define ARG_POS_N   "Position North"
 #define ARG_POS_H   "Position Height"
@@ -45,6 +49,8 @@
 #define CMD_SWAP_CAM        0x01
 #define CMD_CURVE_ACTIVE    0x02
 #define CMD_CURVE_INACTIVE  0x03
+#define CMD_STREAM_ACTIVE   0x04
+#define CMD_STREAM_INACTIVE 0x05
 
 typedef enum {
     EVENT_ACC,
@@ -74,7 +80,10 @@ typedef enum {
     MSG_EVENT_INCOMPLETE,
     MSG_EVENT_COMPLETE,
     MSG_RESPAWN,
-    MSG_COMMAND
+    MSG_COMMAND,
+    MSG_SAMPLES,
+    MSG_SUBSCRIBE,
+    MSG_STATS
 }msgType;
 
 #include "../ValContainer.h"
@@ -149,6 +158,12 @@ public:
     virtual ~M2M_Command();
 };
 
+class M2M_Samples : public Message_M2M {
+public:
+    M2M_Samples();
+    virtual ~M2M_Samples();
+};
+
 class Message_M2C : public Msg {
 public:
     Message_M2C(uint8_t type);
@@ -216,4 +231,22 @@ public:
     virtual ~M2C_Command();
 };
 
+class M2C_Samples : public Message_M2C {
+public:
+    M2C_Samples();
+    virtual ~M2C_Samples();
+};
+
+class M2C_Subscribe : public Message_M2C {
+public:
+    M2C_Subscribe();
+    virtual ~M2C_Subscribe();
+};
+
+class M2C_Stats : public Message_M2C {
+public:
+    M2C_Stats();
+    virtual ~M2C_Stats();
+};
+
 #endif /* MESSAGE_H_ */
@@ -0,0 +1,144 @@
+/** \brief      Slice of a shared buffer.
+ *
+ * \details     References a contiguous range of a shared byte buffer, so large payloads can be
+ *              split into frames without copying them. The buffer is kept alive by the slice and
+ *              must not be modified while slices of it are pending.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       BufferSlice
+ */
+
+#include "BufferSlice.h"
+
+/** \brief Constructor.
+ *
+ *  Default Constructor of BufferSlice instances, referencing nothing.
+ */
+BufferSlice::BufferSlice() {
+    this->offset=0;
+    this->length=0;
+    this->summed=false;
+    this->checksum=0;
+}
+
+/** \brief Constructor.
+ *
+ *  Constructor of BufferSlice instances, referencing the whole buffer 'buffer'.
+ *
+ *  \param buffer The buffer to reference.
+ */
+BufferSlice::BufferSlice(const shared_ptr<vector<uint8_t>> &buffer) {
+    this->buffer=buffer;
+    this->offset=0;
+    this->length= buffer ? buffer->size() : 0;
+    this->summed=false;
+    this->checksum=0;
+}
+
+/** \brief Constructor.
+ *
+ *  Constructor of BufferSlice instances, referencing 'length' bytes of 'buffer', starting at 'offset'.
+ *  The range gets clipped to the buffer size.
+ *
+ *  \param buffer The buffer to reference.
+ *  \param offset Position of the first referenced byte.
+ *  \param length Number of referenced bytes.
+ */
+BufferSlice::BufferSlice(const shared_ptr<vector<uint8_t>> &buffer, size_t offset, size_t length) {
+
+    size_t size = buffer ? buffer->size() : 0;
+
+    this->buffer=buffer;
+    this->offset= offset < size ? offset : size;
+    this->length= length < size-this->offset ? length : size-this->offset;
+    this->summed=false;
+    this->checksum=0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of BufferSlice instances.
+ */
+BufferSlice::~BufferSlice() { }
+
+/** \brief Getter for slice begin.
+ *
+ *  Returns pointer to the first referenced byte.
+ *
+ *  \return Begin of the slice, NULL if empty.
+ */
+uint8_t *BufferSlice::begin() const {
+    return this->length ? &(*this->buffer)[this->offset] : 0;
+}
+
+/** \brief Getter for slice end.
+ *
+ *  Returns pointer behind the last referenced byte.
+ *
+ *  \return End of the slice, NULL if empty.
+ */
+uint8_t *BufferSlice::end() const {
+    return this->length ? begin() + this->length : 0;
+}
+
+/** \brief Getter for slice length.
+ *
+ *  Returns number of referenced bytes.
+ *
+ *  \return Length of the slice.
+ */
+size_t BufferSlice::size() const {
+    return this->length;
+}
+
+/** \brief Checks if slice is empty.
+ *
+ *  Returns whether the slice references no bytes.
+ *
+ *  \return true if empty, false otherwise.
+ */
+bool BufferSlice::empty() const {
+    return !this->length;
+}
+
+/** \brief Getter for buffer.
+ *
+ *  Returns the referenced buffer.
+ *
+ *  \return The shared buffer.
+ */
+shared_ptr<vector<uint8_t>> BufferSlice::getBuffer() const {
+    return this->buffer;
+}
+
+/** \brief Getter for checksum.
+ *
+ *  Returns the XOR checksum of the referenced bytes. It is computed once and kept,
+ *  so copies of a slice made afterwards, e.g. for retransmission, do not read the data again.
+ *
+ *  \return XOR of all referenced bytes.
+ */
+uint8_t BufferSlice::getChecksum() const {
+
+    if (!this->summed) {
+        this->checksum = Checksum::xorBytes(begin(), this->length);
+        this->summed = true;
+    }
+
+    return this->checksum;
+}
+
+/** \brief Drops leading bytes.
+ *
+ *  Removes the first 'count' bytes from the slice, e.g. after they got sent.
+ *
+ *  \param count Number of bytes to drop.
+ */
+void BufferSlice::advance(size_t count) {
+
+    count = count < this->length ? count : this->length;
+
+    this->offset += count;
+    this->length -= count;
+    this->summed = false;
+}
@@ -0,0 +1,45 @@
+/*
+ * BufferSlice.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef BUFFERSLICE_H_
+#define BUFFERSLICE_H_
+
+#include "Checksum.h"
+
+#include <memory>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+class BufferSlice {
+public:
+    BufferSlice();
+    BufferSlice(const shared_ptr<vector<uint8_t>> &buffer);
+    BufferSlice(const shared_ptr<vector<uint8_t>> &buffer, size_t offset, size_t length);
+    virtual ~BufferSlice();
+
+    uint8_t *begin() const;
+    uint8_t *end() const;
+    size_t size() const;
+    bool empty() const;
+    shared_ptr<vector<uint8_t>> getBuffer() const;
+    uint8_t getChecksum() const;
+    void advance(size_t count);
+
+private:
+    shared_ptr<vector<uint8_t>> buffer;
+    size_t offset, length;
+
+    // XOR checksum, computed on first request.
+    mutable bool summed;
+    mutable uint8_t checksum;
+};
+
+#endif /* BUFFERSLICE_H_ */
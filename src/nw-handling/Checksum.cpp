@@ -0,0 +1,73 @@
+/** \brief      Frame checksum kernel.
+ *
+ * \details     XOR reduction over byte ranges, as used for the data frame checksum.
+ *              Processes 32 bytes per step, as two 16 byte vectors, with SSE2 or NEON
+ *              where available and falls back to 64 bit words otherwise.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       Checksum
+ */
+
+#include "Checksum.h"
+
+/** \brief XOR reduction.
+ *
+ *  Combines all 'length' bytes at 'data' and 'init' by XOR.
+ *
+ *  \param data First byte.
+ *  \param length Number of bytes.
+ *  \param init Initial value, e.g. checksum of preceding data.
+ *  \return XOR of all bytes and 'init'.
+ */
+uint8_t Checksum::xorBytes(const uint8_t *data, size_t length, uint8_t init) {
+
+    size_t pos=0;
+    uint64_t word=0;
+
+#if defined(__SSE2__)
+    // Two independent accumulators to hide load latency.
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    for (; pos+32 <= length; pos+=32) {
+        acc0 = _mm_xor_si128(acc0, _mm_loadu_si128((const __m128i *)(data+pos)));
+        acc1 = _mm_xor_si128(acc1, _mm_loadu_si128((const __m128i *)(data+pos+16)));
+    }
+    acc0 = _mm_xor_si128(acc0, acc1);
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc0);
+    word = lanes[0] ^ lanes[1];
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // Two independent accumulators to hide load latency.
+    uint8x16_t acc0 = vdupq_n_u8(0);
+    uint8x16_t acc1 = vdupq_n_u8(0);
+    for (; pos+32 <= length; pos+=32) {
+        acc0 = veorq_u8(acc0, vld1q_u8(data+pos));
+        acc1 = veorq_u8(acc1, vld1q_u8(data+pos+16));
+    }
+    acc0 = veorq_u8(acc0, acc1);
+
+    uint64_t lanes[2];
+    vst1q_u8((uint8_t *)lanes, acc0);
+    word = lanes[0] ^ lanes[1];
+#endif
+
+    // Remaining 64 bit words, memcpy avoids unaligned access.
+    for (; pos+8 <= length; pos+=8) {
+        uint64_t next;
+        memcpy(&next, data+pos, 8);
+        word ^= next;
+    }
+
+    // Fold word to single byte.
+    word ^= word >> 32;
+    word ^= word >> 16;
+    word ^= word >> 8;
+    init ^= (uint8_t)word;
+
+    // Remaining bytes.
+    for (; pos < length; pos++)
+        init ^= data[pos];
+
+    return init;
+}
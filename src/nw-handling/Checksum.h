@@ -0,0 +1,26 @@
+/*
+ * Checksum.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef CHECKSUM_H_
+#define CHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+class Checksum {
+public:
+    static uint8_t xorBytes(const uint8_t *data, size_t length, uint8_t init=0);
+};
+
+#endif /* CHECKSUM_H_ */
@@ -75,6 +75,152 @@ shared_ptr<FrameProcessor> FrameProcessor::getSuccessor() {
     return this->successor;
 }
 
+/** \brief Getter for descriptor.
+ *
+ *  Returns the file descriptor data are finally sent to and received from,
+ *  as provided by the last processor in chain.
+ *
+ *  \return The descriptor, -1 if there is none.
+ */
+int32_t FrameProcessor::getDescriptor() {
+
+    if (!this->successor)
+        return -1;
+
+    return this->successor->getDescriptor();
+}
+
+/** \brief Flushes pending data.
+ *
+ *  Sends data which could not be sent immediately, as far as possible.
+ *  Processors holding data back override this method.
+ *
+ *  \return 0 if nothing is pending anymore, NW_ERR_WOULD_BLOCK if data are still pending, an error code otherwise.
+ */
+uint8_t FrameProcessor::flush() {
+
+    if (!this->successor)
+        return NW_OK;
+
+    return this->successor->flush();
+}
+
+/** \brief Reestablishes connection.
+ *
+ *  Drops the current connection and connects again, as done by the last processor in chain.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t FrameProcessor::reconnect() {
+
+    if (!this->successor)
+        return NW_ERR_NO_SUCCESSOR;
+
+    return this->successor->reconnect();
+}
+
+/** \brief Checks for congestion.
+ *
+ *  Returns whether the chain still holds data it could not pass on, so further packets
+ *  would only queue up behind them. Processors holding data back override this method.
+ *
+ *  \return true if packets would have to wait, false otherwise.
+ */
+bool FrameProcessor::isCongested() {
+
+    if (!this->successor)
+        return false;
+
+    return this->successor->isCongested();
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds the counters of the chain from here on to 'stats'. Processors counting anything
+ *  override this method and add their own counters first.
+ *
+ *  \param stats The statistics to add to.
+ */
+void FrameProcessor::collectStats(NW_Stats &stats) {
+
+    if (this->successor)
+        this->successor->collectStats(stats);
+}
+
+/** \brief Marks a burst of packets.
+ *
+ *  Tells the chain that the packets transmitted until the next call with 'corked' false belong
+ *  together, so the connection may hold them back to send them in full segments.
+ *  Delegates to the successor, the connection itself implements the batching.
+ *
+ *  \param corked true at the begin of the burst, false at its end.
+ */
+void FrameProcessor::cork(bool corked) {
+
+    if (this->successor)
+        this->successor->cork(corked);
+}
+
+/** \brief Gets time until held back data may be sent.
+ *
+ *  Returns when the chain wants to be flushed again, because it holds data back for a while,
+ *  e.g. to limit the send rate. Processors holding data back by time override this method.
+ *
+ *  \return Milliseconds until the next flush is due, -1 if nothing is held back by time.
+ */
+int32_t FrameProcessor::getDelay() {
+
+    if (!this->successor)
+        return -1;
+
+    return this->successor->getDelay();
+}
+
+/** \brief Checks for raw writes.
+ *
+ *  Returns whether data written to the descriptor directly, bypassing the chain (e.g. by sendfile),
+ *  reach the server unaltered and behind all packets transmitted before.
+ *  Processors altering the byte stream behind this one override this method.
+ *
+ *  \return true if the descriptor may be written to directly, false otherwise.
+ */
+bool FrameProcessor::acceptsRaw() {
+
+    if (!this->successor)
+        return false;
+
+    return this->successor->acceptsRaw();
+}
+
+/** \brief Sets replay of unsent packets.
+ *
+ *  Tells the chain whether packets not sent completely on a failed connection are sent again on
+ *  the next one. Processors resending packets on their own, or whose output is bound to a single
+ *  connection, disable it. Delegates to the successor, the connection itself implements the replay.
+ *
+ *  \param replay true to replay unsent packets, false to drop them.
+ */
+void FrameProcessor::setReplay(bool replay) {
+
+    if (this->successor)
+        this->successor->setReplay(replay);
+}
+
+/** \brief Passes acknowledgements of the server.
+ *
+ *  Tells the chain whether the server acknowledges received bytes at all, as negotiated on registration,
+ *  and how many bytes it received completely on the current connection. Delegates to the successor,
+ *  processors keeping sent data until acknowledged override this method.
+ *
+ *  \param supported Whether the server acknowledges received bytes.
+ *  \param received The bytes received by the server on this connection, counted modulo 2^32.
+ */
+void FrameProcessor::acknowledge(bool supported, uint32_t received) {
+
+    if (this->successor)
+        this->successor->acknowledge(supported, received);
+}
+
 /** \brief Transmit data to successor.
  *
  *  Checks if processor is initialized and calls forward method with 'packet'.
@@ -82,7 +228,7 @@ shared_ptr<FrameProcessor> FrameProcessor::getSuccessor() {
  *  \param packet The packet to transmit.
  *  \return 0 in case of success, false otherwise.
  */
-uint8_t FrameProcessor::transmit(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet) {
+uint8_t FrameProcessor::transmit(shared_ptr<deque<BufferSlice>> packet) {
 
     if (!this->initialized())
         return ERR_UNSET_VALUE;
@@ -139,7 +285,7 @@ FrontProcessor::~FrontProcessor() { }
  *  \param packet The packet to transmit.
  *  \return 0 in case of success, false otherwise.
  */
-uint8_t FrontProcessor::forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet) {
+uint8_t FrontProcessor::forward(shared_ptr<deque<BufferSlice>> packet) {
 
     if (!this->getSuccessor())
         return NW_ERR_NO_SUCCESSOR;
@@ -11,6 +11,8 @@
 #define PAYLOAD_SIZE    65536
 #define FRAME_SIZE      PAYLOAD_SIZE+9
 
+#include "BufferSlice.h"
+#include "NW_Stats.h"
 #include "../Child.h"
 #include "../ValContainer.h"
 #include "../Value.h"
@@ -35,7 +37,10 @@ typedef enum {
     NW_ERR_SEQUENCE_MISMATCH,
     NW_ERR_NO_SUCCESSOR,
     NW_ERR_NOT_ENOUGH_CHARS,
-    NW_ERR_OUT_OF_BOUNDS
+    NW_ERR_OUT_OF_BOUNDS,
+    NW_ERR_WOULD_BLOCK,
+    NW_ERR_STORAGE,
+    NW_ERR_TLS
 }networkState;
 
 using namespace std;
@@ -47,15 +52,25 @@ public:
     FrameProcessor(bool front, shared_ptr<FrameProcessor> successor);
     virtual ~FrameProcessor();
     bool isFrontType();
-    uint8_t transmit(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet);
+    uint8_t transmit(shared_ptr<deque<BufferSlice>> packet);
     uint8_t receive(shared_ptr<vector<uint8_t>> packet,
             uint8_t *&begin,
             uint8_t *&end);
     void setSuccessor(shared_ptr<FrameProcessor> successor);
     shared_ptr<FrameProcessor> getSuccessor();
+    virtual int32_t getDescriptor();
+    virtual uint8_t flush();
+    virtual uint8_t reconnect();
+    virtual bool isCongested();
+    virtual void collectStats(NW_Stats &stats);
+    virtual void cork(bool corked);
+    virtual int32_t getDelay();
+    virtual bool acceptsRaw();
+    virtual void setReplay(bool replay);
+    virtual void acknowledge(bool supported, uint32_t received);
 
 protected:
-    virtual uint8_t forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet)=0;
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet)=0;
     virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
             uint8_t *&begin,
             uint8_t *&end)=0;
@@ -75,7 +90,7 @@ public:
     virtual uint8_t pull(shared_ptr<Message_M2C> &input)=0;
 
 protected:
-    virtual uint8_t forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet);
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
     virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
             uint8_t *&begin,
             uint8_t *&end);
@@ -0,0 +1,399 @@
+/** \brief      Network event loop.
+ *
+ * \details     Drives all network communicators from a single thread. Waits for readiness of
+ *              their non-blocking sockets with epoll, passes received frames on and sends pending
+ *              output as long as the sockets accept data. New output and attached communicators
+ *              are signaled by an event descriptor, all communicators are serviced periodically,
+ *              and as soon as their next acquisition is due.
+ *              Communicators are watched by their current descriptor, which may change between
+ *              connections or be missing while a communicator is not connected.
+ *              If a query path is set, statistics of all communicators are written to each client
+ *              connecting to the local socket at that path, e.g. 'socat - UNIX-CONNECT:<path>'.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       NW_Reactor
+ */
+
+#include "NW_Reactor.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of NW_Reactor instances, creating the epoll and wake descriptors.
+ */
+NW_Reactor::NW_Reactor() {
+
+    this->epollDesc = epoll_create1(EPOLL_CLOEXEC);
+    this->wakeDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    this->queryDesc = -1;
+
+    // Watch wake descriptor.
+    if (this->epollDesc != -1 && this->wakeDesc != -1) {
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+        epoll_ctl(this->epollDesc, EPOLL_CTL_ADD, this->wakeDesc, &event);
+    }
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of NW_Reactor instances.
+ */
+NW_Reactor::~NW_Reactor() {
+
+    if (this->epollDesc != -1)
+        close(this->epollDesc);
+    if (this->wakeDesc != -1)
+        close(this->wakeDesc);
+}
+
+/** \brief Attaches communicator.
+ *
+ *  Passes 'comm' to the reactor thread, which watches it from now on.
+ *  This method is thread safe.
+ *
+ *  \param comm The communicator to attach.
+ */
+void NW_Reactor::attach(shared_ptr<NetworkCommunicator> comm) {
+
+    if (!comm)
+        return;
+
+    comm->setWakeDescriptor(this->wakeDesc);
+
+    this->changeMutex.lock();
+    this->attaching.push_back(comm);
+    this->changeMutex.unlock();
+
+    wake();
+}
+
+/** \brief Detaches communicator.
+ *
+ *  Stops watching 'comm'.
+ *  This method is thread safe.
+ *
+ *  \param comm The communicator to detach.
+ */
+void NW_Reactor::detach(shared_ptr<NetworkCommunicator> comm) {
+
+    if (!comm)
+        return;
+
+    this->changeMutex.lock();
+    this->detaching.push_back(comm);
+    this->changeMutex.unlock();
+
+    wake();
+}
+
+/** \brief Wakes reactor thread.
+ *
+ *  Interrupts waiting for readiness, e.g. because of new output.
+ */
+void NW_Reactor::wake() {
+
+    uint64_t signal=1;
+    if (write(this->wakeDesc, &signal, sizeof(signal)) == -1)
+        return; // Reactor is already signaled.
+}
+
+/** \brief Setter for query path.
+ *
+ *  Sets the path of the local socket answering statistics queries.
+ *  Must be called before the reactor runs.
+ *
+ *  \param path Absolute path of the socket, empty to disable queries.
+ */
+void NW_Reactor::setQueryPath(string path) {
+    this->queryPath=path;
+}
+
+/** \brief Run method, implemented from Child.
+ *
+ *  Waits for socket readiness and services the ready communicators, until terminate is called.
+ *
+ *  \return 0 on regular termination, -1 if the reactor could not be set up.
+ */
+int NW_Reactor::run() {
+
+    if (this->epollDesc == -1 || this->wakeDesc == -1) {
+        cerr << "\033[1;31m NW_Reactor \033[0m: setup failed" << endl;
+        return -1;
+    }
+
+    listenQueries();
+
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    auto lastTick = chrono::steady_clock::now();
+
+    // Run until terminate is called.
+    while (!this->isTerminating()) {
+
+        // Wake up for the next periodic service or the next acquisition due, whichever comes first.
+        int32_t timeout = REACTOR_TICK;
+        for (auto commIt : this->comms) {
+            int32_t due = commIt.first->getTimeout();
+            if (due >= 0 && due < timeout)
+                timeout = due;
+        }
+
+        int32_t count = epoll_wait(this->epollDesc, events, REACTOR_MAX_EVENTS, timeout);
+
+        // Apply attached and detached communicators.
+        update();
+
+        // Service ready communicators.
+        for (int32_t index=0; index < count; index++) {
+
+            // New output or changed communicators, try sending on all connections.
+            if (!events[index].data.ptr) {
+
+                uint64_t signal;
+                if (read(this->wakeDesc, &signal, sizeof(signal)) == -1)
+                    continue;
+
+                vector<NetworkCommunicator*> ready;
+                for (auto commIt : this->comms)
+                    ready.push_back(commIt.first);
+                for (NetworkCommunicator *comm : ready)
+                    service(comm, EPOLLOUT);
+
+            } else if (events[index].data.ptr == this)
+                answerQueries();
+            else
+                service((NetworkCommunicator*)events[index].data.ptr, events[index].events);
+        }
+
+        // Periodic maintenance, communicators with acquisitions due right away.
+        auto now = chrono::steady_clock::now();
+        bool periodic = chrono::duration_cast<chrono::milliseconds>(now - lastTick).count() >= REACTOR_TICK;
+        if (periodic)
+            lastTick = now;
+
+        vector<NetworkCommunicator*> ready;
+        for (auto commIt : this->comms)
+            if (periodic || commIt.first->getTimeout() == 0)
+                ready.push_back(commIt.first);
+        for (NetworkCommunicator *comm : ready) {
+
+            auto commIt = this->comms.find(comm);
+            if (commIt == this->comms.end())
+                continue;
+
+            comm->tick();
+            service(comm, 0);
+        }
+    }
+
+    // Stop watching all communicators.
+    while (!this->comms.empty())
+        release(this->comms.begin()->first);
+
+    // Remove query socket.
+    if (this->queryDesc != -1) {
+        close(this->queryDesc);
+        unlink(this->queryPath.c_str());
+        this->queryDesc = -1;
+    }
+
+    return 0;
+}
+
+/** \brief Applies communicator changes.
+ *
+ *  Starts watching attached and stops watching detached communicators.
+ */
+void NW_Reactor::update() {
+
+    this->changeMutex.lock();
+    vector<shared_ptr<NetworkCommunicator>> attached, detached;
+    attached.swap(this->attaching);
+    detached.swap(this->detaching);
+    this->changeMutex.unlock();
+
+    for (auto comm : detached)
+        release(comm.get());
+
+    for (auto comm : attached) {
+
+        if (this->comms.count(comm.get()))
+            continue;
+
+        this->comms[comm.get()] = comm;
+        watch(comm.get(), true);
+    }
+}
+
+/** \brief Services communicator.
+ *
+ *  Receives and sends on the connection of 'comm', according to 'events'.
+ *  Releases the communicator, if it terminated after its connection failed.
+ *
+ *  \param comm The communicator.
+ *  \param events Ready events.
+ */
+void NW_Reactor::service(NetworkCommunicator *comm, uint32_t events) {
+
+    auto commIt = this->comms.find(comm);
+    if (commIt == this->comms.end())
+        return;
+
+    // Keep communicator alive until serviced, even if released meanwhile.
+    shared_ptr<NetworkCommunicator> current = commIt->second;
+    uint8_t status = NW_OK;
+
+    // Receive available frames.
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        status = comm->scan();
+
+    // Send as long as the connection accepts data, wait for writability otherwise.
+    if (status == NW_OK) {
+        status = comm->print();
+        if (status == NW_OK || status == NW_ERR_WOULD_BLOCK) {
+            watch(comm, status == NW_ERR_WOULD_BLOCK);
+            status = NW_OK;
+        }
+    }
+
+    // Stop watching a failed connection until it is reestablished.
+    if (status != NW_OK) {
+        comm->fail();
+        watch(comm, false);
+    }
+
+    if (comm->isTerminating())
+        release(comm);
+}
+
+/** \brief Sets watched events.
+ *
+ *  Watches the current descriptor of 'comm' for readability and, if 'writable' is set, for writability.
+ *  Stops watching a previous descriptor of the communicator, if it changed.
+ *
+ *  \param comm The communicator.
+ *  \param writable Whether to wait for writability.
+ */
+void NW_Reactor::watch(NetworkCommunicator *comm, bool writable) {
+
+    int32_t desc = comm->getDescriptor();
+    uint32_t mask = EPOLLIN | (writable ? EPOLLOUT : 0);
+
+    auto watchIt = this->watched.find(comm);
+    if (watchIt != this->watched.end()) {
+
+        // Nothing changed.
+        if (watchIt->second.first == desc && watchIt->second.second == mask)
+            return;
+
+        // Descriptor changed, the previous one might be closed already.
+        if (watchIt->second.first != desc) {
+            epoll_ctl(this->epollDesc, EPOLL_CTL_DEL, watchIt->second.first, NULL);
+            this->watched.erase(watchIt);
+            watchIt = this->watched.end();
+        }
+    }
+
+    // Not connected at the moment.
+    if (desc == -1)
+        return;
+
+    struct epoll_event event;
+    event.events = mask;
+    event.data.ptr = comm;
+
+    if (watchIt == this->watched.end())
+        epoll_ctl(this->epollDesc, EPOLL_CTL_ADD, desc, &event);
+    else
+        epoll_ctl(this->epollDesc, EPOLL_CTL_MOD, desc, &event);
+
+    this->watched[comm] = make_pair(desc, mask);
+}
+
+/** \brief Releases communicator.
+ *
+ *  Stops watching the connection of 'comm' and drops the communicator.
+ *
+ *  \param comm The communicator.
+ */
+void NW_Reactor::release(NetworkCommunicator *comm) {
+
+    auto watchIt = this->watched.find(comm);
+    if (watchIt != this->watched.end()) {
+        epoll_ctl(this->epollDesc, EPOLL_CTL_DEL, watchIt->second.first, NULL);
+        this->watched.erase(watchIt);
+    }
+
+    auto commIt = this->comms.find(comm);
+    if (commIt != this->comms.end()) {
+        comm->setWakeDescriptor(-1);
+        this->comms.erase(commIt);
+    }
+}
+
+/** \brief Opens query socket.
+ *
+ *  Listens on the local socket at the query path, replacing a stale socket of a previous run.
+ *  Queries stay disabled if the socket can't be set up, networking works without them.
+ */
+void NW_Reactor::listenQueries() {
+
+    if (this->queryPath.empty())
+        return;
+
+    struct sockaddr_un address;
+    if (this->queryPath.size() >= sizeof(address.sun_path)) {
+        cerr << "\033[1;31m NW_Reactor \033[0m: query path too long" << endl;
+        return;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, this->queryPath.c_str(), sizeof(address.sun_path)-1);
+
+    this->queryDesc = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (this->queryDesc == -1)
+        return;
+
+    unlink(this->queryPath.c_str());
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = this;
+
+    if (bind(this->queryDesc, (struct sockaddr*)&address, sizeof(address)) == -1 ||
+            listen(this->queryDesc, REACTOR_MAX_EVENTS) == -1 ||
+            epoll_ctl(this->epollDesc, EPOLL_CTL_ADD, this->queryDesc, &event) == -1) {
+        cerr << "\033[1;31m NW_Reactor \033[0m: query socket setup failed" << endl;
+        close(this->queryDesc);
+        this->queryDesc = -1;
+    }
+}
+
+/** \brief Answers statistics queries.
+ *
+ *  Writes the statistics of each communicator, headed by its type, to all waiting clients and
+ *  closes their connections. The answer is written at once without blocking, so a slow client
+ *  gets a truncated answer instead of stalling the network.
+ */
+void NW_Reactor::answerQueries() {
+
+    int32_t client;
+    while ((client = accept4(this->queryDesc, NULL, NULL, SOCK_CLOEXEC)) != -1) {
+
+        string answer;
+        for (auto commIt : this->comms) {
+
+            NW_Stats stats;
+            commIt.first->collectStats(stats);
+
+            answer += "# comm " + to_string(commIt.first->getCommType()) + "\n";
+            answer += stats.toText();
+        }
+
+        if (send(client, answer.data(), answer.size(), MSG_DONTWAIT | MSG_NOSIGNAL) == -1)
+            cerr << "\033[1;31m NW_Reactor \033[0m: query answer failed" << endl;
+
+        close(client);
+    }
+}
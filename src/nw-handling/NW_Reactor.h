@@ -0,0 +1,66 @@
+/*
+ * NW_Reactor.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef NW_REACTOR_H_
+#define NW_REACTOR_H_
+
+#define REACTOR_TICK        100     // Milliseconds.
+#define REACTOR_MAX_EVENTS  16
+
+#include "NetworkCommunicator.h"
+#include "../Child.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+class NW_Reactor : public Child {
+public:
+    NW_Reactor();
+    virtual ~NW_Reactor();
+    virtual int run();
+    void attach(shared_ptr<NetworkCommunicator> comm);
+    void detach(shared_ptr<NetworkCommunicator> comm);
+    void wake();
+    void setQueryPath(string path);
+
+private:
+    int32_t epollDesc, wakeDesc;
+
+    // Local socket answering statistics queries, disabled if the path is empty.
+    string queryPath;
+    int32_t queryDesc;
+
+    // Communicators to add or remove, passed in from other threads.
+    mutex changeMutex;
+    vector<shared_ptr<NetworkCommunicator>> attaching, detaching;
+
+    // Driven communicators and their watched descriptors and events, only used by the reactor thread.
+    unordered_map<NetworkCommunicator*, shared_ptr<NetworkCommunicator>> comms;
+    unordered_map<NetworkCommunicator*, pair<int32_t, uint32_t>> watched;
+
+    void update();
+    void service(NetworkCommunicator *comm, uint32_t events);
+    void watch(NetworkCommunicator *comm, bool writable);
+    void release(NetworkCommunicator *comm);
+    void listenQueries();
+    void answerQueries();
+};
+
+#endif /* NW_REACTOR_H_ */
@@ -0,0 +1,187 @@
+/** \brief      Token bucket shaper.
+ *
+ * \details     Limits the send rate of a communicator, with separate budgets for image and
+ *              telemetry traffic, so a burst of image fragments can't saturate a metered link
+ *              and delay everything else on it. Each class refills its bucket at its rate up to
+ *              its burst allowance. Traffic may be sent while the bucket is not empty, and is
+ *              charged afterwards, so packets larger than the bucket still pass, overdrawing it.
+ *              The bytes charged per class are counted, so operators can check them against
+ *              the data cap of the vehicle.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       NW_Shaper
+ */
+
+#include "NW_Shaper.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of NW_Shaper instances, not limiting any class.
+ */
+NW_Shaper::NW_Shaper() {
+
+    for (uint8_t shape=0; shape < SHAPE_CLASSES; shape++) {
+        this->buckets[shape].rate=0;
+        this->buckets[shape].burst=0;
+        this->buckets[shape].tokens=0;
+        this->buckets[shape].waiting=false;
+        this->buckets[shape].bytes=0;
+        this->buckets[shape].delays=0;
+    }
+
+    this->lastRefill=chrono::steady_clock::now();
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of NW_Shaper instances.
+ */
+NW_Shaper::~NW_Shaper() { }
+
+/** \brief Sets budget of traffic class.
+ *
+ *  Limits class 'shape' to 'rate' bytes per second, with bursts of up to 'burst' bytes.
+ *  The bucket starts full.
+ *
+ *  \param shape The traffic class, see shapeClass.
+ *  \param rate Bytes per second, 0 to not limit the class.
+ *  \param burst Bucket capacity in bytes, 0 for one second at 'rate'.
+ */
+void NW_Shaper::setBudget(uint8_t shape, uint32_t rate, uint32_t burst) {
+
+    if (shape >= SHAPE_CLASSES)
+        return;
+
+    this->buckets[shape].rate=rate;
+    this->buckets[shape].burst= burst ? burst : rate;
+    this->buckets[shape].tokens=this->buckets[shape].burst;
+}
+
+/** \brief Checks whether traffic may be sent.
+ *
+ *  Returns whether class 'shape' may send right away. Traffic waiting for tokens is counted
+ *  once per wait.
+ *
+ *  \param shape The traffic class, see shapeClass.
+ *  \return true if the class is not limited or has tokens left, false otherwise.
+ */
+bool NW_Shaper::admit(uint8_t shape) {
+
+    if (shape >= SHAPE_CLASSES || !this->buckets[shape].rate)
+        return true;
+
+    refill();
+
+    tokenBucket &bucket = this->buckets[shape];
+    bool admitted = bucket.tokens > 0;
+
+    if (!admitted && !bucket.waiting)
+        bucket.delays++;
+    bucket.waiting = !admitted;
+
+    return admitted;
+}
+
+/** \brief Gets allowance of traffic class.
+ *
+ *  Returns the number of bytes class 'shape' may send right away, for streaming data
+ *  which can be sent in any amount. Once admitted, at least SHAPE_MIN_ALLOWANCE bytes are
+ *  allowed, overdrawing the bucket like a packet would, so streams are not sent in tiny pieces.
+ *
+ *  \param shape The traffic class, see shapeClass.
+ *  \return The bytes allowed, SIZE_MAX if the class is not limited.
+ */
+size_t NW_Shaper::getAllowance(uint8_t shape) {
+
+    if (shape >= SHAPE_CLASSES || !this->buckets[shape].rate)
+        return SIZE_MAX;
+
+    if (!admit(shape))
+        return 0;
+
+    return max((size_t)this->buckets[shape].tokens, (size_t)SHAPE_MIN_ALLOWANCE);
+}
+
+/** \brief Charges sent traffic.
+ *
+ *  Takes 'bytes' tokens from the bucket of class 'shape' and counts them.
+ *
+ *  \param shape The traffic class, see shapeClass.
+ *  \param bytes The bytes sent.
+ */
+void NW_Shaper::charge(uint8_t shape, size_t bytes) {
+
+    if (shape >= SHAPE_CLASSES)
+        return;
+
+    this->buckets[shape].bytes += bytes;
+
+    if (this->buckets[shape].rate)
+        this->buckets[shape].tokens -= bytes;
+}
+
+/** \brief Gets time until waiting traffic may be sent.
+ *
+ *  \param shape The traffic class, see shapeClass.
+ *  \return Milliseconds until class 'shape' has tokens again, 0 if it has some now, -1 if it does not wait.
+ */
+int32_t NW_Shaper::getDelay(uint8_t shape) {
+
+    if (shape >= SHAPE_CLASSES || !this->buckets[shape].waiting)
+        return -1;
+
+    refill();
+
+    tokenBucket &bucket = this->buckets[shape];
+    if (bucket.tokens > 0)
+        return 0;
+
+    // Round up, so the bucket is not empty anymore once the delay elapsed.
+    return (int32_t)(-bucket.tokens * 1000 / bucket.rate) + 1;
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds bytes charged, number of waits and the tokens left per class. Tokens of an
+ *  overdrawn bucket are reported as 0.
+ *
+ *  \param stats The statistics to add to.
+ */
+void NW_Shaper::collectStats(NW_Stats &stats) {
+
+    static const char *names[SHAPE_CLASSES] = { "image", "telemetry" };
+
+    refill();
+
+    for (uint8_t shape=0; shape < SHAPE_CLASSES; shape++) {
+
+        tokenBucket &bucket = this->buckets[shape];
+
+        stats.add(string("shaper.") + names[shape] + "_bytes", bucket.bytes);
+        stats.add(string("shaper.") + names[shape] + "_delays", bucket.delays);
+        if (bucket.rate)
+            stats.add(string("shaper.") + names[shape] + "_tokens", bucket.tokens > 0 ? (uint64_t)bucket.tokens : 0);
+    }
+}
+
+/** \brief Refills buckets.
+ *
+ *  Adds the tokens earned since the last refill, up to the burst allowance.
+ */
+void NW_Shaper::refill() {
+
+    auto now = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double>(now - this->lastRefill).count();
+    this->lastRefill=now;
+
+    for (uint8_t shape=0; shape < SHAPE_CLASSES; shape++) {
+
+        tokenBucket &bucket = this->buckets[shape];
+        if (!bucket.rate)
+            continue;
+
+        bucket.tokens += bucket.rate * elapsed;
+        if (bucket.tokens > bucket.burst)
+            bucket.tokens = bucket.burst;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * NW_Shaper.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef NW_SHAPER_H_
+#define NW_SHAPER_H_
+
+#define SHAPE_FRAME_OVERHEAD    9       // Frame begin, length, checksum and frame end.
+#define SHAPE_MIN_ALLOWANCE     4096    // Bytes of streamed data allowed at once, overdrawing like a packet.
+
+#include "NW_Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+typedef enum {
+    SHAPE_IMAGE,        // Image and stream fragments, uploaded logs.
+    SHAPE_TELEMETRY,    // Registration, events, telemetry, samples and statistics.
+    SHAPE_CLASSES
+}shapeClass;
+
+/** Token bucket of one traffic class. */
+typedef struct tokenBucket {
+    uint32_t rate;      // Bytes per second, 0 if not limited.
+    uint32_t burst;     // Bucket capacity in bytes.
+    double tokens;      // Bytes that may be sent right away, negative if overdrawn.
+    bool waiting;       // Whether traffic currently waits for tokens.
+    uint64_t bytes;     // Bytes charged so far.
+    uint32_t delays;    // Times traffic had to wait for tokens.
+}tokenBucket;
+
+class NW_Shaper {
+public:
+    NW_Shaper();
+    virtual ~NW_Shaper();
+    void setBudget(uint8_t shape, uint32_t rate, uint32_t burst);
+    bool admit(uint8_t shape);
+    size_t getAllowance(uint8_t shape);
+    void charge(uint8_t shape, size_t bytes);
+    int32_t getDelay(uint8_t shape);
+    void collectStats(NW_Stats &stats);
+
+private:
+    tokenBucket buckets[SHAPE_CLASSES];
+    chrono::steady_clock::time_point lastRefill;
+
+    void refill();
+};
+
+#endif /* NW_SHAPER_H_ */
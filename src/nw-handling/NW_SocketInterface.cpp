@@ -22,6 +22,25 @@ NW_SocketInterface::NW_SocketInterface(uint8_t ipFamily, uint8_t socketType, str
 
     this->socketDesc=-1;
     this->host_info_list=0;
+    this->connected=false;
+    this->corked=false;
+    this->blocked=false;
+    this->pendingBytes=0;
+    this->replay=true;
+    this->unsentOffset=0;
+
+    this->batching=TX_NODELAY;
+    this->bufferSize=0;
+    this->notSentLowat=0;
+
+    this->bytesSent=0;
+    this->bytesReceived=0;
+    this->connects=0;
+    this->sendCalls=0;
+    this->sendBlocked=0;
+    this->recvCalls=0;
+    this->sendLatency=histogram();
+    this->recvSize=histogram();
 
     this->ipFamily      = ipFamily;
     this->socketType    = socketType;
@@ -35,13 +54,37 @@ NW_SocketInterface::NW_SocketInterface(uint8_t ipFamily, uint8_t socketType, str
  *  Destructor of NW_SocketInterface instances.
  */
 NW_SocketInterface::~NW_SocketInterface() {
-    freeaddrinfo(host_info_list);
-    close(this->socketDesc);
+    if (this->host_info_list)
+        freeaddrinfo(this->host_info_list);
+    if (this->socketDesc != -1)
+        close(this->socketDesc);
+}
+
+/** \brief Setter for transmit policy.
+ *
+ *  Sets how bursts of frames are batched and how the kernel buffers are sized.
+ *  Buffers sized to the bandwidth-delay product of the link keep it busy without queueing
+ *  more than a round trip worth of data. A low watermark of unsent data keeps the rest in the
+ *  chain, where urgent frames can still overtake it.
+ *  Applies to all connections initialized afterwards.
+ *
+ *  \param batching Batching of bursts, see txBatching.
+ *  \param bufferSize Size of send and receive buffers in bytes, 0 for the system default.
+ *  \param notSentLowat Unsent bytes the kernel may hold (TCP_NOTSENT_LOWAT), 0 for no limit.
+ */
+void NW_SocketInterface::setTransmit(uint8_t batching, uint32_t bufferSize, uint32_t notSentLowat) {
+
+    this->batching=batching;
+    this->bufferSize=bufferSize;
+    this->notSentLowat=notSentLowat;
 }
 
 /** \brief Initializes the socket interface.
  *
  *  Initializes the socket interface, using the values passed to constructor.
+ *  The socket is non-blocking, so the connection might still be in progress afterwards.
+ *  The target address is resolved once and reused by later connections.
+ *  The transmit policy is applied before connecting, so the window scale fits the buffers.
  *  Returns a status indicator.
  *
  *  \return 0 in case of success, an error code otherwise.
@@ -57,9 +100,9 @@ uint8_t NW_SocketInterface::initialize() {
     host_info.ai_family = this->ipFamily;     // IP version. AF_UNSPEC recommended.
     host_info.ai_socktype = this->socketType; // SOCK_STREAM for TCP, SOCK_DGRAM for UDP.
 
-    // Generate target address information.
-    uint8_t status = getaddrinfo(this->address.c_str(), this->port.c_str(), &host_info, &(this->host_info_list));
-    if (status != 0)
+    // Generate target address information, unless already known.
+    if (!this->host_info_list &&
+            getaddrinfo(this->address.c_str(), this->port.c_str(), &host_info, &(this->host_info_list)))
         return NW_ERR_ADDR_INFO;
 
     // Now that setup is done, create socket.
@@ -70,11 +113,24 @@ uint8_t NW_SocketInterface::initialize() {
 
     // Disable buffering and reuse socket port.
     int flag = 1;
-    if (setsockopt(this->socketDesc, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(int)))
+    if (this->socketType == SOCK_STREAM &&
+            setsockopt(this->socketDesc, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(int)))
         return NW_ERR_ARGUMENT;
     if (setsockopt(this->socketDesc, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(int)) == -1)
         return NW_ERR_ARGUMENT;
 
+    // Size buffers, the kernel doubles the values for its bookkeeping.
+    int size = min(this->bufferSize, (uint32_t)INT_MAX);
+    if (size && (setsockopt(this->socketDesc, SOL_SOCKET, SO_SNDBUF, &size, sizeof(int)) == -1 ||
+            setsockopt(this->socketDesc, SOL_SOCKET, SO_RCVBUF, &size, sizeof(int)) == -1))
+        return NW_ERR_ARGUMENT;
+
+    // Limit unsent data in the kernel, the socket is writable again below the watermark.
+    int lowat = min(this->notSentLowat, (uint32_t)INT_MAX);
+    if (lowat && this->socketType == SOCK_STREAM &&
+            setsockopt(this->socketDesc, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(int)))
+        return NW_ERR_ARGUMENT;
+
     // Get interface address for binding.
     strncpy((char *)ifr.ifr_name, this->iface.c_str(), this->iface.length());
     if(ioctl(this->socketDesc, SIOCGIFADDR, &ifr))
@@ -84,47 +140,370 @@ uint8_t NW_SocketInterface::initialize() {
     if((bind(this->socketDesc, (struct sockaddr *)&ifr.ifr_addr, sizeof(sockaddr)))== -1)
         return NW_ERR_BIND;
 
-    // Last step of initialization: Connect to server.
-    status = connect(this->socketDesc, host_info_list->ai_addr, host_info_list->ai_addrlen);
-    if (this->socketDesc == -1)
-        return NW_ERR_CONNECT;
+    // Switch to non-blocking mode.
+    int flags = fcntl(this->socketDesc, F_GETFL, 0);
+    if (flags == -1 || fcntl(this->socketDesc, F_SETFL, flags | O_NONBLOCK) == -1)
+        return NW_ERR_SOCKET;
+
+    // Last step of initialization: Connect to server, completion is checked on flush.
+    this->connecting=chrono::steady_clock::now();
+    this->connects++;
+    if (connect(this->socketDesc, host_info_list->ai_addr, host_info_list->ai_addrlen) == -1) {
+        if (errno != EINPROGRESS)
+            return NW_ERR_CONNECT;
+    } else
+        this->connected=true;
 
     return NW_OK;
 }
 
+/** \brief Reestablishes connection.
+ *
+ *  Drops the current connection and initializes the socket interface again.
+ *  Packets not sent completely are sent again from their beginning on the new connection, behind
+ *  the first packet transmitted on it (the registration), so the server never gets a truncated
+ *  frame. Without replay, see setReplay, they are dropped.
+ *  The resolved address is reused, unless the connection to it could not be established.
+ *  The new socket is created before the old one is closed, so consecutive connections never share
+ *  a descriptor number.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t NW_SocketInterface::reconnect() {
+
+    int32_t previousDesc = this->socketDesc;
+    struct addrinfo *previousList = 0;
+
+    // Resolve again, if the address might be outdated.
+    if (!this->connected) {
+        previousList = this->host_info_list;
+        this->host_info_list=0;
+    }
+
+    this->socketDesc=-1;
+    this->connected=false;
+    this->corked=false;
+    this->blocked=false;
+    this->pending.clear();
+    this->pendingBytes=0;
+
+    // Keep unsent packets for replay.
+    if (this->replay)
+        for (auto &next : this->unsent)
+            this->replayed.push_back(next.packet);
+    this->unsent.clear();
+    this->unsentOffset=0;
+
+    uint8_t status = initialize();
+
+    if (previousList)
+        freeaddrinfo(previousList);
+    if (previousDesc != -1)
+        close(previousDesc);
+
+    return status;
+}
+
+/** \brief Getter for descriptor.
+ *
+ *  Returns the socket descriptor.
+ *
+ *  \return The socket descriptor, -1 if not initialized.
+ */
+int32_t NW_SocketInterface::getDescriptor() {
+    return this->socketDesc;
+}
+
+/** \brief Checks for congestion.
+ *
+ *  Returns whether the connection is still being established or the socket did not take
+ *  all pending data. Data held back for batching don't count.
+ *
+ *  \return true if packets would have to wait, false otherwise.
+ */
+bool NW_SocketInterface::isCongested() {
+    return !this->connected || this->blocked;
+}
+
+/** \brief Checks for raw writes.
+ *
+ *  Returns whether the connection is established and nothing is pending anymore,
+ *  so data written to the socket directly follow the packets sent before.
+ *
+ *  \return true if the socket may be written to directly, false otherwise.
+ */
+bool NW_SocketInterface::acceptsRaw() {
+    return this->connected && this->pending.empty() && this->replayed.empty();
+}
+
+/** \brief Sets replay of unsent packets.
+ *
+ *  Replay is enabled by default. Disabling it drops the packets kept for replay, unless already
+ *  queued again.
+ *
+ *  \param replay true to replay unsent packets on the next connection, false to drop them.
+ */
+void NW_SocketInterface::setReplay(bool replay) {
+
+    this->replay=replay;
+    if (!replay)
+        this->replayed.clear();
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds transferred bytes, call counts, the duration of send calls in microseconds
+ *  and the sizes returned by receive calls.
+ *
+ *  \param stats The statistics to add to.
+ */
+void NW_SocketInterface::collectStats(NW_Stats &stats) {
+
+    stats.add("socket.connects", this->connects);
+    stats.add("socket.bytes_sent", this->bytesSent);
+    stats.add("socket.bytes_received", this->bytesReceived);
+    stats.add("socket.send_calls", this->sendCalls);
+    stats.add("socket.send_blocked", this->sendBlocked);
+    stats.add("socket.recv_calls", this->recvCalls);
+    stats.add("socket.pending_slices", this->pending.size());
+    stats.add("socket.pending_bytes", this->pendingBytes);
+    stats.add("socket.send_latency_us", this->sendLatency);
+    stats.add("socket.recv_size", this->recvSize);
+}
+
+/** \brief Marks a burst of packets.
+ *
+ *  Batches the frames of a burst according to the transmit policy. Corked by the kernel,
+ *  partial segments are sent on uncorking. Gathered for MSG_MORE, data are sent in batches
+ *  of at least NW_BATCH_SIZE and the rest by the next flush after uncorking.
+ *  Datagram sockets and sockets without batching ignore bursts.
+ *
+ *  \param corked true at the begin of the burst, false at its end.
+ */
+void NW_SocketInterface::cork(bool corked) {
+
+    if (this->socketType != SOCK_STREAM || this->batching == TX_NODELAY || this->corked == corked)
+        return;
+
+    this->corked=corked;
+
+    if (this->socketDesc == -1)
+        return;
+
+    // Uncorking sends partial segments, setting TCP_NODELAY again pushes those held by MSG_MORE.
+    int flag = corked;
+    if (this->batching == TX_CORK)
+        setsockopt(this->socketDesc, IPPROTO_TCP, TCP_CORK, &flag, sizeof(int));
+    else if (!corked) {
+        flag = 1;
+        setsockopt(this->socketDesc, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(int));
+    }
+}
+
 /** \brief Forwards packet to network interface.
  *
- *  Forwards 'packet' to network interface (actual send process)
+ *  Forwards 'packet' to network interface (actual send process).
+ *  The packet is queued behind pending data and sent as far as the socket accepts it,
+ *  the rest is sent by later calls to flush.
+ *  Datagram sockets send the packet as a single datagram right away instead.
  *  Returns a status indicator.
  *
  *  \param packet The packet to send.
- *  \return 0 in case of success, an error code otherwise.
+ *  \return 0 in case of success, NW_ERR_WOULD_BLOCK if a datagram was not taken, an error code otherwise.
  */
-uint8_t NW_SocketInterface::forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet) {
+uint8_t NW_SocketInterface::forward(shared_ptr<deque<BufferSlice>> packet) {
+
+    if (this->socketType == SOCK_DGRAM)
+        return sendDatagram(packet);
+
+    enqueue(packet);
+
+    // Replay unsent packets of the previous connection behind the first packet of this one.
+    while (!this->replayed.empty()) {
+        enqueue(this->replayed.front());
+        this->replayed.pop_front();
+    }
+
+    // Send as far as possible, pending data are no error here.
+    uint8_t status = flush();
+    if (status == NW_ERR_WOULD_BLOCK)
+        return NW_OK;
+
+    return status;
+}
+
+/** \brief Queues packet.
+ *
+ *  Queues the non-empty slices of 'packet' behind pending data and keeps the packet for replay
+ *  until it is sent completely.
+ *
+ *  \param packet The packet to queue.
+ */
+void NW_SocketInterface::enqueue(shared_ptr<deque<BufferSlice>> &packet) {
+
+    unsentPacket next;
+    next.packet = packet;
+    next.size = 0;
+    for (auto packetIt = packet->begin(); packetIt != packet->end(); packetIt++)
+        if (!packetIt->empty()) {
+            this->pending.push_back(*packetIt);
+            this->pendingBytes += packetIt->size();
+            next.size += packetIt->size();
+        }
+
+    if (next.size)
+        this->unsent.push_back(next);
+}
+
+/** \brief Flushes pending data.
+ *
+ *  Sends pending data, if the connection is established.
+ *  All pending slices are gathered into a single sendmsg call; if the
+ *  socket accepts only part of the data, sending resumes at the first unsent byte.
+ *  Within a burst batched with MSG_MORE, data short of a batch are held until uncorked.
+ *  Returns a status indicator.
+ *
+ *  \return 0 if nothing is pending anymore, NW_ERR_WOULD_BLOCK if data are still pending, an error code otherwise.
+ */
+uint8_t NW_SocketInterface::flush() {
+
+    if (this->socketDesc == -1)
+        return NW_ERR_SOCKET;
+
+    // Check if connection got established in the meantime.
+    if (!this->connected) {
+
+        struct pollfd pollDesc;
+        pollDesc.fd = this->socketDesc;
+        pollDesc.events = POLLOUT;
+        pollDesc.revents = 0;
+
+        // Still connecting, give up once the connection could not be established in time.
+        if (poll(&pollDesc, 1, 0) == 0) {
+            auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - this->connecting);
+            return elapsed.count() > NW_CONNECT_TIMEOUT ? NW_ERR_CONNECT : NW_ERR_WOULD_BLOCK;
+        }
+
+        // Get connect result.
+        int error=0;
+        socklen_t length=sizeof(error);
+        if (getsockopt(this->socketDesc, SOL_SOCKET, SO_ERROR, &error, &length) == -1 || error)
+            return NW_ERR_CONNECT;
+
+        this->connected=true;
+    }
 
-    // Initialize local variables.
-    uint32_t bytesSent=0, lastSent=0;
+    // Send while there are pending slices, at most IOV_MAX per call.
+    // Within a batched burst, only full batches are sent.
+    bool more = this->corked && this->batching == TX_MORE;
+    while (!this->pending.empty() && (!more || this->pendingBytes >= NW_BATCH_SIZE)) {
 
-    // Iterate over packet and send its content to socket descriptor
-    auto packetIt = packet->begin();
-    while (packetIt != packet->end()) {
+        // Build io vector from pending slices.
+        vector<struct iovec> ioVector;
+        ioVector.reserve(min(this->pending.size(), (size_t)IOV_MAX));
+        for (auto pendingIt = this->pending.begin();
+                pendingIt != this->pending.end() && ioVector.size() < IOV_MAX; pendingIt++) {
 
-        bytesSent = 0;
-        vector<uint8_t> *vector = &(**(packetIt++));
+            struct iovec entry;
+            entry.iov_base = pendingIt->begin();
+            entry.iov_len = pendingIt->size();
+            ioVector.push_back(entry);
+        }
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &ioVector[0];
+        message.msg_iovlen = ioVector.size();
+
+        auto start = chrono::steady_clock::now();
+        ssize_t lastSent = sendmsg(this->socketDesc, &message, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+        NW_Stats::record(this->sendLatency,
+                chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+        this->sendCalls++;
+
+        // Socket buffer is full, continue when writable again.
+        if (lastSent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            this->sendBlocked++;
+            this->blocked=true;
+            return NW_ERR_WOULD_BLOCK;
+        }
 
-        // Send while there are unsent bytes.
-        while (bytesSent < vector->size()) {
-            lastSent = send(this->socketDesc, &((*vector)[bytesSent]), vector->size()-bytesSent, 0);
+        // An error occurred
+        if (lastSent < 1) return NW_ERR_SEND;
 
-            // An error occurred
-            if (lastSent < 1) return NW_ERR_SEND;
+        this->bytesSent += lastSent;
+        this->pendingBytes -= lastSent;
+        this->blocked=false;
 
-            // Set sent byte count.
-            bytesSent+=lastSent;
+        // Drop completely sent slices.
+        size_t sent = lastSent;
+        while (!this->pending.empty() && sent >= this->pending.front().size()) {
+            sent -= this->pending.front().size();
+            this->pending.pop_front();
         }
+
+        // Resume within partially sent slice.
+        if (sent)
+            this->pending.front().advance(sent);
+
+        // Drop completely sent packets.
+        sent = this->unsentOffset + lastSent;
+        while (!this->unsent.empty() && sent >= this->unsent.front().size) {
+            sent -= this->unsent.front().size;
+            this->unsent.pop_front();
+        }
+        this->unsentOffset = sent;
     }
+
     return NW_OK;
+}
+
+/** \brief Sends datagram.
+ *
+ *  Sends all slices of 'packet' as one datagram. Datagrams are never queued,
+ *  a datagram the socket does not take has to be sent again or dropped by the caller.
+ *
+ *  \param packet The packet to send.
+ *  \return 0 in case of success, NW_ERR_WOULD_BLOCK if the socket buffer is full, an error code otherwise.
+ */
+uint8_t NW_SocketInterface::sendDatagram(shared_ptr<deque<BufferSlice>> &packet) {
 
+    if (this->socketDesc == -1)
+        return NW_ERR_SOCKET;
+
+    vector<struct iovec> ioVector;
+    ioVector.reserve(packet->size());
+    for (auto &slice : *packet) {
+
+        struct iovec entry;
+        entry.iov_base = slice.begin();
+        entry.iov_len = slice.size();
+        ioVector.push_back(entry);
+    }
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &ioVector[0];
+    message.msg_iovlen = ioVector.size();
+
+    auto start = chrono::steady_clock::now();
+    ssize_t sent = sendmsg(this->socketDesc, &message, MSG_NOSIGNAL);
+    NW_Stats::record(this->sendLatency,
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+    this->sendCalls++;
+
+    if (sent == -1) {
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+            this->sendBlocked++;
+            return NW_ERR_WOULD_BLOCK;
+        }
+
+        return NW_ERR_SEND;
+    }
+
+    this->bytesSent += sent;
+    return NW_OK;
 }
 
 /** \brief Backwards packet from network interface.
@@ -134,7 +513,7 @@ uint8_t NW_SocketInterface::forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>
  *
  *  \param packet The target container of receiving process.
  *  \param begin The first position to write result to.
- *  \param end The end of the received data
+ *  \param end The write limit, the end of the received data afterwards.
  *  \return 0 in case of success, an error code otherwise.
  */
 uint8_t NW_SocketInterface::backward(shared_ptr<vector<uint8_t>> packet,
@@ -142,20 +521,25 @@ uint8_t NW_SocketInterface::backward(shared_ptr<vector<uint8_t>> packet,
         uint8_t *&end) {
 
     // Check if there is place left in packet.
-    if (end-(&(*packet)[0]) >= (uint32_t)packet->size())
+    if (end <= begin)
         return NW_ERR_OUT_OF_BOUNDS;
 
-    // Calculate new length to read and receive from socket descriptor.
-    uint32_t length = (&(*packet)[packet->size()])-end;
-    int32_t bytesReceived = recv(this->socketDesc, end, length, 0);
+    // Receive from socket descriptor.
+    ssize_t bytesReceived = recv(this->socketDesc, begin, end-begin, 0);
+    this->recvCalls++;
+
+    // No data available yet.
+    if (bytesReceived == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return NW_ERR_WOULD_BLOCK;
 
     // An error occurred
     if (bytesReceived < 1) return NW_ERR_RECV;
 
+    this->bytesReceived += bytesReceived;
+    NW_Stats::record(this->recvSize, bytesReceived);
+
     // Set new end.
     end=begin+bytesReceived;
 
     return NW_OK;
-
 }
-
@@ -13,10 +13,22 @@
 #define ARG_TARGET_ADDR "Target Address"
 #define ARG_TARGET_PORT "Target Port"
 
+#define NW_CONNECT_TIMEOUT      10000   // Milliseconds.
+#define NW_BATCH_SIZE           65536   // Bytes gathered before sending a burst with MSG_MORE.
+
+typedef enum {
+    TX_NODELAY,     // Each frame is sent right away.
+    TX_CORK,        // Bursts are corked by the kernel (TCP_CORK) and sent in full segments.
+    TX_MORE         // Bursts are gathered and sent in few calls flagged MSG_MORE.
+}txBatching;
+
 #include "FrameProcessor.h"
 
+#include <cerrno>
+#include <climits>
 #include <cstring>
 
+#include <chrono>
 #include <fstream>
 #include <iterator>
 #include <string>
@@ -28,18 +40,36 @@
 #include <netinet/tcp.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 
+/** Packet not sent completely yet, kept for replaying it on a new connection. */
+typedef struct unsentPacket {
+    shared_ptr<deque<BufferSlice>> packet;
+    size_t size;
+}unsentPacket;
+
 class NW_SocketInterface : public FrameProcessor {
 public:
 
     NW_SocketInterface(uint8_t ipFamily, uint8_t socketType, string address, string port, string iface);
     virtual ~NW_SocketInterface();
     uint8_t initialize();
+    void setTransmit(uint8_t batching, uint32_t bufferSize, uint32_t notSentLowat);
+    virtual int32_t getDescriptor();
+    virtual uint8_t flush();
+    virtual uint8_t reconnect();
+    virtual bool isCongested();
+    virtual void collectStats(NW_Stats &stats);
+    virtual void cork(bool corked);
+    virtual bool acceptsRaw();
+    virtual void setReplay(bool replay);
 
 protected:
-    virtual uint8_t forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet);
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
     virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
             uint8_t *&begin,
             uint8_t *&end);
@@ -55,6 +85,30 @@ private:
 
     int32_t socketDesc;
     struct addrinfo *host_info_list;
+
+    // Transmit policy, see setTransmit.
+    uint8_t batching;
+    uint32_t bufferSize, notSentLowat;
+
+    // Connection state and data not accepted by the socket yet.
+    bool connected, corked, blocked;
+    chrono::steady_clock::time_point connecting;
+    deque<BufferSlice> pending;
+    size_t pendingBytes;
+
+    // Packets of the pending data and the bytes sent of the first one, see setReplay.
+    bool replay;
+    deque<unsentPacket> unsent;
+    size_t unsentOffset;
+    deque<shared_ptr<deque<BufferSlice>>> replayed;
+
+    // Statistics.
+    uint64_t bytesSent, bytesReceived;
+    uint32_t connects, sendCalls, sendBlocked, recvCalls;
+    histogram sendLatency, recvSize;
+
+    uint8_t sendDatagram(shared_ptr<deque<BufferSlice>> &packet);
+    void enqueue(shared_ptr<deque<BufferSlice>> &packet);
 };
 
 #endif /* NW_SOCKETINTERFACE_H_ */
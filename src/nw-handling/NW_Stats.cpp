@@ -0,0 +1,97 @@
+/** \brief      Network statistics.
+ *
+ * \details     Snapshot of the counters and histograms of a communicator and its frame processors,
+ *              collected on request. Processors count in plain members on their hot paths and only
+ *              copy them here, so collecting costs nothing while nobody asks.
+ *              The text form holds one "name=value" line per counter and one
+ *              "name=bucket0,bucket1,..." line per histogram.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       NW_Stats
+ */
+
+#include "NW_Stats.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of NW_Stats instances.
+ */
+NW_Stats::NW_Stats() { }
+
+/** \brief Destructor.
+ *
+ *  Destructor of NW_Stats instances.
+ */
+NW_Stats::~NW_Stats() { }
+
+/** \brief Adds counter.
+ *
+ *  \param name Name of the counter.
+ *  \param value Its value.
+ */
+void NW_Stats::add(string name, uint64_t value) {
+    this->counters.push_back(make_pair(name, value));
+}
+
+/** \brief Adds histogram.
+ *
+ *  \param name Name of the histogram.
+ *  \param value Its buckets.
+ */
+void NW_Stats::add(string name, const histogram &value) {
+    this->histograms.push_back(make_pair(name, value));
+}
+
+/** \brief Merges statistics.
+ *
+ *  Adds all counters and histograms of 'other', their names prefixed by 'prefix'.
+ *
+ *  \param prefix Prefix of the names.
+ *  \param other The statistics to add.
+ */
+void NW_Stats::merge(string prefix, const NW_Stats &other) {
+
+    for (auto &counter : other.counters)
+        add(prefix + counter.first, counter.second);
+    for (auto &distribution : other.histograms)
+        add(prefix + distribution.first, distribution.second);
+}
+
+/** \brief Converts to text.
+ *
+ *  \return One line per counter and histogram.
+ */
+string NW_Stats::toText() {
+
+    stringstream result;
+
+    for (auto &counter : this->counters)
+        result << counter.first << "=" << counter.second << "\n";
+
+    for (auto &distribution : this->histograms) {
+        result << distribution.first << "=";
+        for (uint8_t bucket=0; bucket < STATS_BUCKETS; bucket++)
+            result << (bucket ? "," : "") << distribution.second.buckets[bucket];
+        result << "\n";
+    }
+
+    return result.str();
+}
+
+/** \brief Records value.
+ *
+ *  Counts 'value' in the bucket of 'target' it falls into.
+ *
+ *  \param target The histogram.
+ *  \param value The value.
+ */
+void NW_Stats::record(histogram &target, uint64_t value) {
+
+    uint8_t bucket=0;
+    while (value && bucket < STATS_BUCKETS-1) {
+        value >>= 1;
+        bucket++;
+    }
+
+    target.buckets[bucket]++;
+}
@@ -0,0 +1,41 @@
+/*
+ * NW_Stats.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef NW_STATS_H_
+#define NW_STATS_H_
+
+#define STATS_BUCKETS   16      // Histogram buckets, each twice as wide as the previous one.
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/** Distribution of values, bucket i counts values of i significant bits (the last one all larger ones). */
+typedef struct histogram {
+    uint32_t buckets[STATS_BUCKETS];
+}histogram;
+
+class NW_Stats {
+public:
+    NW_Stats();
+    virtual ~NW_Stats();
+    void add(string name, uint64_t value);
+    void add(string name, const histogram &value);
+    void merge(string prefix, const NW_Stats &other);
+    string toText();
+    static void record(histogram &target, uint64_t value);
+
+private:
+    vector<pair<string, uint64_t>> counters;
+    vector<pair<string, histogram>> histograms;
+};
+
+#endif /* NW_STATS_H_ */
@@ -0,0 +1,227 @@
+/** \brief      TLS client context shared by the connections to one server.
+ *
+ * \details     Holds the OpenSSL client context with the trusted certificates and the latest
+ *              session issued by the server. Sessions arrive as tickets after the handshake,
+ *              the next connection offers the latest one to skip the certificate exchange and
+ *              the key agreement. The context outlives single connections, so even a respawned
+ *              communicator resumes the session of its predecessor.
+ *              If offloading is requested, the TLS 1.3 send secret of each connection is kept,
+ *              so the record encryption can be handed to the kernel after the handshake. Once
+ *              a server requested a key update, which offloaded connections can't answer, the
+ *              following connections stay in user space.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       NW_TLSContext
+ */
+
+#include "NW_TLSContext.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of NW_TLSContext instances, to be initialized before use.
+ */
+NW_TLSContext::NW_TLSContext() {
+    this->context=0;
+    this->offload=false;
+    this->secretIndex=-1;
+    this->session=0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of NW_TLSContext instances, freeing the cached session and the context.
+ */
+NW_TLSContext::~NW_TLSContext() {
+
+    if (this->session)
+        SSL_SESSION_free(this->session);
+
+    if (this->context)
+        SSL_CTX_free(this->context);
+}
+
+/** \brief Initializes the context.
+ *
+ *  Sets up a client context for TLS 1.2 and later, verifying servers against the certificates
+ *  in 'caFile' or, if empty, against the certificates of the system.
+ *
+ *  \param caFile PEM file of trusted certificates, empty for the system defaults.
+ *  \param offload Whether connections should hand the record encryption to the kernel.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t NW_TLSContext::initialize(string caFile, bool offload) {
+
+    if (this->context)
+        return NW_ERR_ALREADY_ACTIVE;
+
+    this->context = SSL_CTX_new(TLS_client_method());
+    if (!this->context)
+        return NW_ERR_TLS;
+
+    SSL_CTX_set_min_proto_version(this->context, TLS1_2_VERSION);
+    SSL_CTX_set_verify(this->context, SSL_VERIFY_PEER, NULL);
+
+    int loaded = caFile.empty() ? SSL_CTX_set_default_verify_paths(this->context)
+            : SSL_CTX_load_verify_locations(this->context, caFile.c_str(), NULL);
+
+    if (loaded != 1) {
+        SSL_CTX_free(this->context);
+        this->context=0;
+        return NW_ERR_TLS;
+    }
+
+    // Keep issued sessions here instead of the internal cache.
+    SSL_CTX_set_app_data(this->context, this);
+    SSL_CTX_set_session_cache_mode(this->context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(this->context, storeSession);
+
+    if (offload) {
+        this->secretIndex = SSL_get_ex_new_index(0, NULL, NULL, NULL, freeSecret);
+        SSL_CTX_set_keylog_callback(this->context, logKey);
+    }
+
+    this->offload = offload && this->secretIndex != -1;
+
+    return NW_OK;
+}
+
+/** \brief Creates a connection.
+ *
+ *  Creates a client connection, offering the latest session for resumption, if any.
+ *
+ *  \return The connection, 0 if the context is not initialized or in case of an error.
+ */
+SSL *NW_TLSContext::createSession() {
+
+    if (!this->context)
+        return 0;
+
+    SSL *ssl = SSL_new(this->context);
+    if (!ssl)
+        return 0;
+
+    lock_guard<mutex> guard(this->lock);
+
+    if (this->session)
+        SSL_set_session(ssl, this->session);
+
+    return ssl;
+}
+
+/** \brief Getter for offloading.
+ *
+ *  Returns whether connections should hand the record encryption to the kernel.
+ *
+ *  \return true if the send secrets are kept for offloading, false otherwise.
+ */
+bool NW_TLSContext::isOffloading() {
+    return this->offload;
+}
+
+/** \brief Stops offloading.
+ *
+ *  Keeps the record encryption of following connections in user space, for servers
+ *  requiring post-handshake records of the client.
+ */
+void NW_TLSContext::disableOffload() {
+    this->offload=false;
+}
+
+/** \brief Getter for traffic secret.
+ *
+ *  Copies the TLS 1.3 send secret of connection 'ssl' to 'secret'.
+ *
+ *  \param ssl The connection.
+ *  \param secret The container to copy the secret to.
+ *  \return true if the secret is known, false otherwise.
+ */
+bool NW_TLSContext::getTrafficSecret(SSL *ssl, vector<uint8_t> &secret) {
+
+    if (!this->offload)
+        return false;
+
+    vector<uint8_t> *stored = (vector<uint8_t>*)SSL_get_ex_data(ssl, this->secretIndex);
+    if (!stored)
+        return false;
+
+    secret = *stored;
+    return true;
+}
+
+/** \brief Stores issued session.
+ *
+ *  Callback of OpenSSL for sessions issued by the server, replacing the cached session.
+ *
+ *  \param ssl The connection the session was issued on.
+ *  \param session The session.
+ *  \return 1, as the reference to the session is kept.
+ */
+int NW_TLSContext::storeSession(SSL *ssl, SSL_SESSION *session) {
+
+    NW_TLSContext *tls = (NW_TLSContext*)SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+
+    lock_guard<mutex> guard(tls->lock);
+
+    if (tls->session)
+        SSL_SESSION_free(tls->session);
+
+    tls->session = session;
+
+    return 1;
+}
+
+/** \brief Keeps send secret.
+ *
+ *  Key log callback of OpenSSL, storing the TLS 1.3 send secret at the connection.
+ *  Lines have the form "<label> <client random> <secret>", in hexadecimal digits.
+ *
+ *  \param ssl The connection.
+ *  \param line The key log line.
+ */
+void NW_TLSContext::logKey(const SSL *ssl, const char *line) {
+
+    if (strncmp(line, TLS_SECRET_LABEL " ", sizeof(TLS_SECRET_LABEL)))
+        return;
+
+    const char *digits = strrchr(line, ' ');
+    if (!digits)
+        return;
+
+    vector<uint8_t> *secret = new vector<uint8_t>();
+    for (digits++; digits[0] && digits[1]; digits += 2) {
+        unsigned int byte;
+        if (sscanf(digits, "%2x", &byte) != 1)
+            break;
+        secret->push_back(byte);
+    }
+
+    NW_TLSContext *tls = (NW_TLSContext*)SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    SSL *connection = const_cast<SSL*>(ssl);
+
+    freeSecret(0, SSL_get_ex_data(connection, tls->secretIndex), 0, tls->secretIndex, 0, 0);
+    SSL_set_ex_data(connection, tls->secretIndex, secret);
+}
+
+/** \brief Frees send secret.
+ *
+ *  Ex data callback of OpenSSL, wiping and freeing the send secret of a freed connection.
+ *
+ *  \param parent The connection.
+ *  \param secret The secret, may be 0.
+ *  \param data Ex data of the connection.
+ *  \param index The ex data index.
+ *  \param argl Unused.
+ *  \param argp Unused.
+ */
+void NW_TLSContext::freeSecret(void *parent, void *secret, CRYPTO_EX_DATA *data,
+        int index, long argl, void *argp) {
+
+    vector<uint8_t> *stored = (vector<uint8_t>*)secret;
+    if (!stored)
+        return;
+
+    if (!stored->empty())
+        OPENSSL_cleanse(&(*stored)[0], stored->size());
+
+    delete stored;
+}
@@ -0,0 +1,53 @@
+/*
+ * NW_TLSContext.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef NW_TLSCONTEXT_H_
+#define NW_TLSCONTEXT_H_
+
+#define TLS_SECRET_LABEL    "CLIENT_TRAFFIC_SECRET_0"   // Key log label of the TLS 1.3 send secret.
+
+#include "FrameProcessor.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+using namespace std;
+
+class NW_TLSContext {
+public:
+    NW_TLSContext();
+    virtual ~NW_TLSContext();
+    uint8_t initialize(string caFile, bool offload);
+    SSL *createSession();
+    bool isOffloading();
+    void disableOffload();
+    bool getTrafficSecret(SSL *ssl, vector<uint8_t> &secret);
+
+private:
+    SSL_CTX *context;
+    atomic<bool> offload;
+
+    // Ex data index of the send secrets kept for offloading.
+    int secretIndex;
+
+    // Latest session issued by a server, resumed by the next connection.
+    mutex lock;
+    SSL_SESSION *session;
+
+    static int storeSession(SSL *ssl, SSL_SESSION *session);
+    static void logKey(const SSL *ssl, const char *line);
+    static void freeSecret(void *parent, void *secret, CRYPTO_EX_DATA *data,
+            int index, long argl, void *argp);
+};
+
+#endif /* NW_TLSCONTEXT_H_ */
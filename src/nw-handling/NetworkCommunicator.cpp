@@ -1,6 +1,11 @@
 /** \brief      Representation of a single network communicator.
  *
  * \details     This class represents a communication session with a server.
+ *              It owns no thread, a NW_Reactor drives it as soon as its descriptor gets ready.
+ *              A failed connection of a real time communicator is reestablished with exponential,
+ *              jittered backoff, keeping the communicator and its pending messages.
+ *              Data acquisitions are either requested by the server one by one, or requested by the
+ *              communicator itself at a fixed interval, e.g. for a stream the server subscribed to.
  * \author      Daniel Wagenknecht
  * \version     2015-11-25
  * \class       NW_SocketInterface
@@ -20,6 +25,21 @@ NetworkCommunicator::NetworkCommunicator(uint8_t commType) {
 
     this->first = NULL;
     this->commID=commType;
+    this->acquireInterval=0;
+    this->lastAcquire=chrono::steady_clock::now();
+    this->acquiring=false;
+    this->streaming=false;
+    this->reportInterval=0;
+    this->lastReport=chrono::steady_clock::now();
+    this->started=chrono::steady_clock::now();
+    this->failures=0;
+    this->reconnects=0;
+    this->acquisitions=0;
+    this->wakeDesc=-1;
+    this->reconnecting=false;
+    this->backoff=RECONNECT_MIN;
+    this->reconnectAt=chrono::steady_clock::now();
+    this->jitter.seed(chrono::steady_clock::now().time_since_epoch().count());
 
     // Create first message to register on board unit
     shared_ptr<M2C_Register> reg(new M2C_Register);
@@ -51,13 +71,10 @@ uint8_t NetworkCommunicator::getCommType() {
  */
 bool NetworkCommunicator::appenProc(shared_ptr<FrameProcessor> proc) {
 
-    if (proc) return false;
-
-    // Temp variable for iterating
-    shared_ptr<FrameProcessor> temp=first;
+    if (!proc) return false;
 
     // 'first' uninitialized.
-    if(first) {
+    if(!first) {
 
         // Could 'proc' be used as front FrameProcessor?
         if(proc->isFrontType()) first=dynamic_pointer_cast<FrontProcessor>(proc);
@@ -65,6 +82,9 @@ bool NetworkCommunicator::appenProc(shared_ptr<FrameProcessor> proc) {
 
     } else {
 
+        // Temp variable for iterating
+        shared_ptr<FrameProcessor> temp=first;
+
         // Get last successor.
         while (temp->getSuccessor())
             temp = temp->getSuccessor();
@@ -77,111 +97,327 @@ bool NetworkCommunicator::appenProc(shared_ptr<FrameProcessor> proc) {
 
 }
 
-/** \brief Scans for network input.
+/** \brief Getter for descriptor.
+ *
+ *  Returns the descriptor of the underlying network connection.
+ *
+ *  \return The descriptor, -1 if there is none or the connection is to be reestablished.
+ */
+int32_t NetworkCommunicator::getDescriptor() {
+
+    if (!this->first || this->reconnecting)
+        return -1;
+
+    return this->first->getDescriptor();
+}
+
+/** \brief Setter for wake descriptor.
+ *
+ *  Sets the event descriptor to signal new output messages to.
+ *
+ *  \param wakeDesc The event descriptor.
+ */
+void NetworkCommunicator::setWakeDescriptor(int32_t wakeDesc) {
+    this->wakeDesc=wakeDesc;
+}
+
+/** \brief Setter for acquisition interval.
+ *
+ *  Lets the communicator request a data acquisition every 'interval' milliseconds by itself,
+ *  instead of waiting for the server to request it. Used by communicators which are not
+ *  connected to a server all the time, and for streams the server subscribed to.
+ *
+ *  \param interval Acquisition interval in milliseconds, 0 to disable.
+ */
+void NetworkCommunicator::setAcquireInterval(uint32_t interval) {
+    this->acquireInterval=interval;
+}
+
+/** \brief Starts or stops the stream encoder.
+ *
+ *  Sends a command to encode the video stream while the server subscribes to it, and to stop
+ *  once the subscription ends, so no frames are encoded without a receiver.
+ *
+ *  \param streaming Whether the server subscribes to the stream.
+ */
+void NetworkCommunicator::setStreaming(bool streaming) {
+
+    if (streaming == this->streaming)
+        return;
+
+    this->streaming=streaming;
+
+    shared_ptr<M2C_Command> command(new M2C_Command);
+    command->setValue(ARG_COMMAND_TYPE, shared_ptr<ValInt>(new ValInt(streaming ? CMD_STREAM_ACTIVE : CMD_STREAM_INACTIVE)));
+    in_push(command);
+}
+
+/** \brief Setter for report interval.
+ *
+ *  Lets the communicator send its statistics to the server every 'interval' milliseconds.
  *
- *  Get messages from network interface and distribute them to the other modules.
+ *  \param interval Report interval in milliseconds, 0 to disable.
  */
-int NetworkCommunicator::scan() {
+void NetworkCommunicator::setReportInterval(uint32_t interval) {
+    this->reportInterval=interval;
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds the counters of this communicator and its frame processors to 'stats'.
+ *  Counters only grow, so rates follow from two snapshots and their uptimes.
+ *  Must be called from the thread driving the communicator.
+ *
+ *  \param stats The statistics to add to.
+ */
+void NetworkCommunicator::collectStats(NW_Stats &stats) {
+
+    stats.add("comm.uptime_ms", chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now() - this->started).count());
+    stats.add("comm.failures", this->failures);
+    stats.add("comm.reconnects", this->reconnects);
+    stats.add("comm.acquisitions", this->acquisitions);
+    stats.add("comm.output_queue", this->out_count());
 
-    cerr << "\033[1;31m NetworkCommunicator \033[0m: ----- Scan started (\x1B[33m"<<this<<"\033[0m)" << endl;
+    if (this->first)
+        this->first->collectStats(stats);
+}
+
+/** \brief Puts new message to output list.
+ *
+ *  Pushes the message specified by 'field' to the output list and wakes up the reactor.
+ *  A complete data set finishes the outstanding acquisition.
+ *  This method is thread safe.
+ */
+void NetworkCommunicator::out_push(shared_ptr<Message_M2C> field) {
+
+    Child::out_push(field);
+
+    if (field && field->getType() == MSG_DATA_COMPLETE)
+        this->acquiring=false;
+
+    uint64_t signal=1;
+    int32_t desc=this->wakeDesc;
+    if (desc != -1 && write(desc, &signal, sizeof(signal)) == -1)
+        return; // Reactor is already signaled.
+}
+
+/** \brief Scans for network input.
+ *
+ *  Get all available messages from network interface and distribute them to the other modules.
+ *  Stream subscriptions are served by the communicator itself, by requesting acquisitions at the
+ *  subscribed interval.
+ *  Does not block.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t NetworkCommunicator::scan() {
 
-    // At least one FrontProcessor exists.
-    if (this->first) {
+    if (!this->first)
+        return NW_ERR_NO_SUCCESSOR;
 
-        // Run until terminate is called.
-        while (!this->isTerminating()) {
+    if (this->reconnecting)
+        return NW_OK;
 
-            shared_ptr<Message_M2C> input;
+    // Read until no more data are available.
+    while (!this->isTerminating()) {
 
-            // Read until successful receiving data or until terminate is called.
-            // Abort if limit is reached.
-            for (uint16_t count = 0; count < MAX_ATTEMPT_NW_COMM && first->pull(input)  && !this->isTerminating(); count++);
+        shared_ptr<Message_M2C> input;
+        uint8_t status = first->pull(input);
 
-            // If input is not null
-            if (input)
-                in_push(input);
-            else if (!this->isTerminating()) {
+        if (status == NW_ERR_WOULD_BLOCK)
+            return NW_OK;
+        if (status)
+            return status;
 
-                // Send respawn message.
-                shared_ptr<M2C_Respawn> respawn(new M2C_Respawn);
-                in_push(respawn);
+        // The server answers, so the connection is fine again.
+        this->backoff=RECONNECT_MIN;
 
-                this->terminate();
+        // Start or stop acquiring on the own clock, the first acquisition right away.
+        if (input && input->getType() == MSG_SUBSCRIBE) {
 
+            shared_ptr<Value> interval;
+            input->getValue(ARG_INTERVAL, interval);
+            if (interval) {
+                setAcquireInterval(dynamic_pointer_cast<ValInt>(interval)->getValue());
+                setStreaming(this->acquireInterval != 0);
             }
+
+            this->lastAcquire=chrono::steady_clock::time_point();
+            continue;
         }
+
+        // If input is not null
+        if (input)
+            in_push(input);
     }
 
-    cerr << "\033[1;31m NetworkCommunicator \033[0m: scan terminated (\x1B[33m"<<this<<"\033[0m)" << endl;
+    return NW_OK;
+}
+
+/** \brief Prints data to network connection.
+ *
+ *  Hands all pending messages to the frame processors, which queue their frames by priority,
+ *  and sends as much as the connection accepts. Frames of urgent messages thus overtake
+ *  bulk data of earlier messages, which are not sent completely yet.
+ *  While the connection is to be reestablished, messages stay in the output list.
+ *  Does not block.
+ *
+ *  \return 0 if all messages are sent, NW_ERR_WOULD_BLOCK if data are pending, an error code otherwise.
+ */
+uint8_t NetworkCommunicator::print() {
 
-    return 0;
+    if (!this->first)
+        return NW_ERR_NO_SUCCESSOR;
 
+    if (this->reconnecting)
+        return NW_OK;
+
+    while (!this->isTerminating()) {
+
+        shared_ptr<Message_M2C> msg = this->out_pop();
+        if (!msg)
+            break;
+
+        uint8_t status = first->push(msg);
+        if (status != NW_OK)
+            return status;
+    }
+
+    // Send queued frames, the most urgent first.
+    return first->flush();
 }
 
-/** \brief Prints data to network connection.
+/** \brief Periodic maintenance.
  *
- *  Pushes messages to server connection.
+ *  Called periodically by the reactor. Reestablishes a failed connection once its delay elapsed,
+ *  registering again on the new connection, which has to subscribe to streams again.
+ *  Requests a data acquisition, if the acquisition interval elapsed and the previous one is complete.
+ *  Acquisitions are skipped while the connection is congested, so a slow link drops frames
+ *  instead of queueing them. Sends statistics, if the report interval elapsed.
  */
-int NetworkCommunicator::print() {
+void NetworkCommunicator::tick() {
 
-    cerr << "\033[1;31m NetworkCommunicator \033[0m: ----- Print started (\x1B[33m"<<this<<"\033[0m)" << endl;
+    if (this->isTerminating())
+        return;
 
-    // At least one FrontProcessor exists.
-    if (this->first)
+    auto now = chrono::steady_clock::now();
 
-        // Run until terminate is called.
-        while (!this->isTerminating()) {
+    if (this->reconnecting && now >= this->reconnectAt) {
 
-            if (this->out_count()) {
+        this->reconnecting=false;
+        this->reconnects++;
+        if (this->first->reconnect()) {
+            fail();
+        } else {
 
-                while (this->out_count() && !this->isTerminating()) {
+            // Registration is sent before all pending messages.
+            shared_ptr<M2C_Register> reg(new M2C_Register);
+            out_push(reg);
+            this->acquireInterval=0;
+            setStreaming(false);
+        }
+    }
 
-                    shared_ptr<Message_M2C> msg = this->out_pop();
+    // Statistics frame, sent behind pending messages.
+    if (this->reportInterval && !this->reconnecting &&
+            chrono::duration_cast<chrono::milliseconds>(now - this->lastReport).count() >= this->reportInterval) {
 
-                    uint8_t status=NW_OK;
+        this->lastReport=now;
 
-                    // Write until successful transmitted data or until terminate is called.
-                    // Abort if limit is reached.
-                    for (uint16_t count = 0; count < MAX_ATTEMPT_NW_COMM && (status=first->push(msg))  && !this->isTerminating(); count++);
+        NW_Stats stats;
+        collectStats(stats);
 
-                    if (status && !this->isTerminating()) {
+        shared_ptr<M2C_Stats> report(new M2C_Stats);
+        report->setValue(ARG_STATS, shared_ptr<ValString>(new ValString(stats.toText())));
+        out_push(report);
+    }
 
-                        // Send respawn message.
-                        shared_ptr<M2C_Respawn> respawn(new M2C_Respawn);
-                        in_push(respawn);
+    if (!this->acquireInterval)
+        return;
 
-                        this->terminate();
+    // Wait for the previous acquisition, unless it got lost.
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(now - this->lastAcquire);
+    if (this->acquiring && elapsed.count() < ACQUIRE_TIMEOUT)
+        return;
 
-                    }
+    if (elapsed.count() < this->acquireInterval)
+        return;
 
-                }
+    this->lastAcquire=now;
 
-            } else
-                this->out_wait();
-        }
+    if (this->first && this->first->isCongested())
+        return;
 
-    cerr << "\033[1;31m NetworkCommunicator \033[0m: ----- Print terminated (\x1B[33m"<<this<<"\033[0m)" << endl;
+    this->acquiring=true;
+    this->acquisitions++;
 
-    return 0;
+    shared_ptr<M2C_DataAcquired> acquire(new M2C_DataAcquired);
+    in_push(acquire);
 }
 
-/** \brief Run method, implemented from Child.
+/** \brief Getter for timeout.
+ *
+ *  Returns the time until the next acquisition is due or the chain wants to send data it held
+ *  back, e.g. to limit the send rate, so the reactor wakes up in time.
  *
- *  Runs one thread for receiving and one for transmitting data.
+ *  \return Milliseconds until the next acquisition or send, -1 if none is scheduled.
  */
-int NetworkCommunicator::run() {
+int32_t NetworkCommunicator::getTimeout() {
 
-    shared_ptr<thread> rcvThread(new thread(&NetworkCommunicator::scan, this));
-    shared_ptr<thread> sendThread(new thread(&NetworkCommunicator::print, this));
+    if (this->isTerminating())
+        return -1;
 
-    if(rcvThread->joinable())
-        rcvThread->join();
-    if(sendThread->joinable())
-        sendThread->join();
+    // Data held back by the chain.
+    int32_t timeout = this->first && !this->reconnecting ? this->first->getDelay() : -1;
 
-    this->first.reset();
+    if (!this->acquireInterval || this->acquiring)
+        return timeout;
 
-    return 0;
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - this->lastAcquire);
+    if (elapsed.count() >= this->acquireInterval)
+        return 0;
 
+    int32_t due = this->acquireInterval - elapsed.count();
+    return timeout >= 0 && timeout < due ? timeout : due;
 }
 
+/** \brief Fails the connection.
+ *
+ *  Schedules reestablishing the connection of a real time communicator. The delay doubles with each
+ *  failure up to RECONNECT_MAX and is drawn from its upper half, so many units losing the same
+ *  server don't return all at once.
+ *  Other communicators request a respawn and terminate.
+ */
+void NetworkCommunicator::fail() {
+
+    if (this->isTerminating() || this->reconnecting)
+        return;
+
+    this->failures++;
+
+    if (this->commID == NW_TYPE_REALTIME && this->first) {
+
+        uniform_int_distribution<uint32_t> delay(this->backoff/2, this->backoff);
+        this->reconnectAt = chrono::steady_clock::now() + chrono::milliseconds(delay(this->jitter));
+        this->backoff = min(2*this->backoff, (uint32_t)RECONNECT_MAX);
+        this->reconnecting=true;
+        return;
+    }
+
+    // Send respawn message.
+    shared_ptr<M2C_Respawn> respawn(new M2C_Respawn);
+    in_push(respawn);
+
+    this->terminate();
+}
+
+/** \brief Run method, implemented from Child.
+ *
+ *  Communicators are driven by a NW_Reactor, so there is nothing to run in a separate thread.
+ *
+ *  \return 0
+ */
+int NetworkCommunicator::run() {
+    return 0;
+}
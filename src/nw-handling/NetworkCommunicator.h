@@ -8,7 +8,9 @@
 #ifndef NETWORKCOMMUNICATOR_H_
 #define NETWORKCOMMUNICATOR_H_
 
-#define MAX_ATTEMPT_NW_COMM     1000
+#define RECONNECT_MIN   500     // Milliseconds before the first reconnect attempt.
+#define RECONNECT_MAX   60000   // Upper limit of the delay between reconnect attempts.
+#define ACQUIRE_TIMEOUT 5000    // Milliseconds to wait for an acquisition before requesting the next.
 
 typedef enum {
     NW_TYPE_REALTIME,
@@ -18,11 +20,12 @@ typedef enum {
 #include "FrameProcessor.h"
 #include "../Child.h"
 
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <memory>
-#include <mutex>
-#include <queue>
-#include <thread>
+#include <random>
+
+#include <unistd.h>
 
 class NetworkCommunicator : public Child {
 public:
@@ -31,11 +34,48 @@ public:
     uint8_t getCommType();
     bool appenProc(shared_ptr<FrameProcessor> proc);
     virtual int run();
-    int print();
-    int scan();
+    virtual void out_push(shared_ptr<Message_M2C> field);
+    int32_t getDescriptor();
+    void setWakeDescriptor(int32_t wakeDesc);
+    void setAcquireInterval(uint32_t interval);
+    void setReportInterval(uint32_t interval);
+    void collectStats(NW_Stats &stats);
+    uint8_t scan();
+    uint8_t print();
+    void tick();
+    int32_t getTimeout();
+    void fail();
 private:
+    void setStreaming(bool streaming);
+
     shared_ptr<FrontProcessor> first;
     uint8_t commID;
+
+    // Interval of self-requested data acquisitions in milliseconds, 0 if disabled,
+    // and whether the last one is still outstanding.
+    uint32_t acquireInterval;
+    chrono::steady_clock::time_point lastAcquire;
+    atomic<bool> acquiring;
+
+    // Whether the server subscribed to the stream, so the stream encoder runs.
+    bool streaming;
+
+    // Reconnect state, the delay doubles with each failed attempt.
+    bool reconnecting;
+    uint32_t backoff;
+    chrono::steady_clock::time_point reconnectAt;
+    minstd_rand jitter;
+
+    // Interval of statistics frames to the server in milliseconds, 0 if disabled.
+    uint32_t reportInterval;
+    chrono::steady_clock::time_point lastReport;
+
+    // Statistics.
+    chrono::steady_clock::time_point started;
+    uint32_t failures, reconnects, acquisitions;
+
+    // Event descriptor of the driving reactor, set from the reactor thread.
+    atomic<int32_t> wakeDesc;
 };
 
 #endif /* NETWORKCOMMUNICATOR_H_ */
@@ -0,0 +1,242 @@
+/** \brief      Acknowledgement processor.
+ *
+ * \details     Numbers outgoing payloads and keeps them until the server acknowledges them, so
+ *              payloads lost with a failed connection are sent again on the next one (at least once).
+ *              A sequenced payload is sent as MSG_ID_SEQUENCED, followed by a 32 bit big endian
+ *              sequence number and the original payload. The server answers with MSG_ID_ACK and the
+ *              sequence number of the last payload received, acknowledging all payloads up to it.
+ *              Sequence numbers continue across connections, so the server drops duplicates.
+ *              At most 'window' payloads are in flight; further payloads wait in the chain before.
+ *              Sequencing starts once the server accepts FEATURE_ACK in its registration answer.
+ *              After a reconnect, payloads are held back until the server answered the new
+ *              registration, then all unacknowledged payloads are sent again in order.
+ *              Registration frames are never sequenced.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       ProcAck
+ */
+
+#include "ProcAck.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of ProcAck instances.
+ *
+ *  \param window Maximum number of unacknowledged payloads.
+ */
+ProcAck::ProcAck(uint16_t window) {
+
+    this->window=window ? window : 1;
+    this->supported=false;
+    this->accepted=false;
+    this->sequence=0;
+    this->retransmitted=0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of ProcAck instances.
+ */
+ProcAck::~ProcAck() { }
+
+/** \brief Getter for unacknowledged payloads.
+ *
+ *  Returns the number of payloads kept for retransmission.
+ *
+ *  \return Number of unacknowledged payloads.
+ */
+uint32_t ProcAck::getInFlight() {
+    return this->inFlight.size();
+}
+
+/** \brief Reestablishes connection.
+ *
+ *  Reconnects the successor. Acknowledgements have to be accepted again on the new connection,
+ *  until then payloads are held back.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcAck::reconnect() {
+
+    this->accepted=false;
+    return FrameProcessor::reconnect();
+}
+
+/** \brief Checks for congestion.
+ *
+ *  Returns whether the window of unacknowledged payloads is full or the successor is congested.
+ *  While the answer to the registration of a new connection is outstanding, payloads stay
+ *  queued before, so they are sent in order and within the window after the retransmission.
+ *
+ *  \return true if packets would have to wait, false otherwise.
+ */
+bool ProcAck::isCongested() {
+
+    if (this->supported && !this->accepted)
+        return true;
+
+    if (this->accepted && this->inFlight.size() >= this->window)
+        return true;
+
+    return FrameProcessor::isCongested();
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds the number of unacknowledged and of retransmitted payloads.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcAck::collectStats(NW_Stats &stats) {
+
+    stats.add("ack.in_flight", this->inFlight.size());
+    stats.add("ack.retransmitted", this->retransmitted);
+
+    FrameProcessor::collectStats(stats);
+}
+
+/** \brief Forwards packet to successor.
+ *
+ *  Numbers 'packet', keeps it for retransmission and sends it, if the server acknowledges payloads.
+ *  Passes it unchanged otherwise.
+ *
+ *  \param packet The packet to send.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcAck::forward(shared_ptr<deque<BufferSlice>> packet) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    // Get message id.
+    uint8_t msgId=0;
+    for (auto &slice : *packet)
+        if (!slice.empty()) {
+            msgId = *slice.begin();
+            break;
+        }
+
+    if (!this->supported || msgId == MSG_ID_REGISTER)
+        return this->getSuccessor()->transmit(packet);
+
+    inFlightPayload next;
+    next.sequence = this->sequence++;
+    next.packet = packet;
+    this->inFlight.push_back(next);
+
+    // Wait for the answer to the registration of a new connection.
+    if (!this->accepted)
+        return NW_OK;
+
+    return send(this->inFlight.back());
+}
+
+/** \brief Backwards packet from successor.
+ *
+ *  Receives the next payload from successor. Acknowledgements are consumed, registration answers
+ *  are checked for the server accepting acknowledgements and passed on like all other payloads.
+ *
+ *  \param packet Container for the payload, passed to the successor.
+ *  \param begin Begin of the payload.
+ *  \param end End of the payload.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcAck::backward(shared_ptr<vector<uint8_t>> packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    while (true) {
+
+        uint8_t status = this->getSuccessor()->receive(packet, begin, end);
+        if (status != NW_OK || begin == end)
+            return status;
+
+        switch (*begin) {
+        case MSG_ID_ACK:
+        {
+            if (end - begin >= ACK_HEADER)
+                acknowledge(((uint32_t)*(begin+1) << 24) | ((uint32_t)*(begin+2) << 16) |
+                        ((uint32_t)*(begin+3) << 8) | *(begin+4));
+            continue;
+        }
+        case MSG_ID_REGISTER:
+        {
+            // Server answers registration with the features it accepts.
+            this->accepted = end - begin > 3 && (*(begin+3) & FEATURE_ACK);
+
+            // Unacknowledged payloads are sent again here, the connection must not replay them.
+            FrameProcessor::setReplay(!this->accepted);
+
+            if (this->accepted) {
+                this->supported=true;
+                status = retransmit();
+            } else if (this->supported) {
+
+                // Server does not acknowledge anymore, send held payloads unchanged.
+                this->supported=false;
+                for (auto &next : this->inFlight)
+                    if ((status = this->getSuccessor()->transmit(next.packet)))
+                        break;
+                this->inFlight.clear();
+            }
+
+            return status;
+        }
+        default:
+            return NW_OK;
+        }
+    }
+}
+
+/** \brief Sends sequenced payload.
+ *
+ *  Sends 'payload' behind its message id and sequence number. The kept payload is not changed.
+ *
+ *  \param payload The payload to send.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcAck::send(inFlightPayload &payload) {
+
+    shared_ptr<vector<uint8_t>> header(new vector<uint8_t>(ACK_HEADER));
+    (*header)[0] = MSG_ID_SEQUENCED;
+    (*header)[1] = payload.sequence >> 24;
+    (*header)[2] = payload.sequence >> 16;
+    (*header)[3] = payload.sequence >> 8;
+    (*header)[4] = payload.sequence;
+
+    shared_ptr<deque<BufferSlice>> packet(new deque<BufferSlice>(*payload.packet));
+    packet->push_front(header);
+
+    return this->getSuccessor()->transmit(packet);
+}
+
+/** \brief Sends all unacknowledged payloads again.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcAck::retransmit() {
+
+    for (auto &next : this->inFlight) {
+        uint8_t status = send(next);
+        if (status != NW_OK)
+            return status;
+        this->retransmitted++;
+    }
+
+    return NW_OK;
+}
+
+/** \brief Releases acknowledged payloads.
+ *
+ *  Drops all payloads up to 'sequence', allowing for wrapped sequence numbers.
+ *
+ *  \param sequence Sequence number of the last payload received by the server.
+ */
+void ProcAck::acknowledge(uint32_t sequence) {
+
+    while (!this->inFlight.empty() && (int32_t)(sequence - this->inFlight.front().sequence) >= 0)
+        this->inFlight.pop_front();
+}
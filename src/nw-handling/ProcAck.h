@@ -0,0 +1,58 @@
+/*
+ * ProcAck.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef PROCACK_H_
+#define PROCACK_H_
+
+#define ACK_WINDOW      64      // Default number of unacknowledged payloads in flight.
+#define ACK_HEADER      5       // Message id and sequence number, fits into FRAGMENT_HEADROOM.
+
+#include "FrameProcessor.h"
+#include "ProcPayload.h"
+
+#include <deque>
+
+/** Payload sent but not acknowledged yet. */
+typedef struct inFlightPayload {
+    uint32_t sequence;
+    shared_ptr<deque<BufferSlice>> packet;
+}inFlightPayload;
+
+class ProcAck : public FrameProcessor {
+public:
+    ProcAck(uint16_t window=ACK_WINDOW);
+    virtual ~ProcAck();
+    virtual uint8_t reconnect();
+    virtual bool isCongested();
+    virtual void collectStats(NW_Stats &stats);
+    uint32_t getInFlight();
+
+protected:
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
+    virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
+            uint8_t *&begin,
+            uint8_t *&end);
+
+private:
+    uint16_t window;
+
+    // Whether the server acknowledges payloads at all and on the current connection.
+    bool supported, accepted;
+
+    // Sequence number of the next payload.
+    uint32_t sequence;
+
+    // Payloads kept for retransmission, oldest first.
+    deque<inFlightPayload> inFlight;
+    uint64_t retransmitted;
+
+    uint8_t send(inFlightPayload &payload);
+    uint8_t retransmit();
+    void acknowledge(uint32_t sequence);
+};
+
+#endif /* PROCACK_H_ */
@@ -0,0 +1,231 @@
+/** \brief      Payload compression processor.
+ *
+ * \details     Compresses outgoing payloads with deflate and decompresses incoming ones. Sits
+ *              between ProcPayload and ProcDataFrame. A compressed payload keeps its message id
+ *              as first byte, marked by COMPRESS_FLAG, followed by the deflated rest of the payload.
+ *              Each payload is compressed on its own, so lost or reordered frames don't affect others.
+ *              Registration frames, image and stream fragments (already compressed) and small
+ *              payloads are passed unchanged, as are payloads which would not get smaller.
+ *              Compression starts as soon as the server accepts FEATURE_COMPRESS in its
+ *              registration answer, unless set up without negotiation.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       ProcCompress
+ */
+
+#include "ProcCompress.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of ProcCompress instances, compressing with deflate level 'level'.
+ *  If 'negotiate' is false, compression is used right away, e.g. for stored frames.
+ *
+ *  \param level Deflate level, 1 (fastest) to 9 (smallest).
+ *  \param negotiate Whether to wait for the server to accept compression.
+ */
+ProcCompress::ProcCompress(uint8_t level, bool negotiate) {
+
+    this->level=level;
+    this->negotiate=negotiate;
+    this->enabled=!negotiate;
+    this->ready=false;
+    this->bytesIn=0;
+    this->bytesOut=0;
+
+    this->deflater = z_stream();
+    this->inflater = z_stream();
+    this->inflated = shared_ptr<vector<uint8_t>>(new vector<uint8_t>(PAYLOAD_SIZE));
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of ProcCompress instances.
+ */
+ProcCompress::~ProcCompress() {
+
+    if (this->ready) {
+        deflateEnd(&this->deflater);
+        inflateEnd(&this->inflater);
+    }
+}
+
+/** \brief Initializes the compression streams.
+ *
+ *  Allocates the deflate and inflate streams, which are reused for all payloads.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcCompress::initialize() {
+
+    if (this->ready)
+        return NW_ERR_ALREADY_ACTIVE;
+
+    if (deflateInit(&this->deflater, this->level) != Z_OK)
+        return NW_ERR_UNKNOWN;
+
+    if (inflateInit(&this->inflater) != Z_OK) {
+        deflateEnd(&this->deflater);
+        return NW_ERR_UNKNOWN;
+    }
+
+    this->ready=true;
+    return NW_OK;
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds the sizes of compressed payloads before and after compression.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcCompress::collectStats(NW_Stats &stats) {
+
+    stats.add("compress.bytes_in", this->bytesIn);
+    stats.add("compress.bytes_out", this->bytesOut);
+
+    FrameProcessor::collectStats(stats);
+}
+
+/** \brief Forwards packet to successor.
+ *
+ *  Compresses 'packet' if compression is in use and worth it, and forwards the result to successor.
+ *  Returns a status indicator.
+ *
+ *  \param packet The packet to send.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcCompress::forward(shared_ptr<deque<BufferSlice>> packet) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    // Get payload length.
+    size_t length=0;
+    for (auto &slice : *packet)
+        length += slice.size();
+
+    if (!this->enabled || !this->ready || !isCompressible(packet, length))
+        return this->getSuccessor()->transmit(packet);
+
+    // Compress everything behind the message id.
+    shared_ptr<vector<uint8_t>> output(new vector<uint8_t>(1 + deflateBound(&this->deflater, length-1)));
+    deflateReset(&this->deflater);
+    this->deflater.next_out = &(*output)[1];
+    this->deflater.avail_out = output->size()-1;
+
+    bool first=true;
+    for (auto &slice : *packet) {
+
+        this->deflater.next_in = slice.begin();
+        this->deflater.avail_in = slice.size();
+
+        // Skip message id.
+        if (first && this->deflater.avail_in) {
+            (*output)[0] = *this->deflater.next_in | COMPRESS_FLAG;
+            this->deflater.next_in++;
+            this->deflater.avail_in--;
+            first=false;
+        }
+
+        if (this->deflater.avail_in && deflate(&this->deflater, Z_NO_FLUSH) != Z_OK)
+            return this->getSuccessor()->transmit(packet);
+    }
+
+    if (deflate(&this->deflater, Z_FINISH) != Z_STREAM_END)
+        return this->getSuccessor()->transmit(packet);
+
+    // Send original if compression does not pay off.
+    size_t compressed = 1 + this->deflater.total_out;
+    if (compressed >= length)
+        return this->getSuccessor()->transmit(packet);
+
+    shared_ptr<deque<BufferSlice>> result(new deque<BufferSlice>);
+    result->push_back(BufferSlice(output, 0, compressed));
+
+    this->bytesIn += length;
+    this->bytesOut += compressed;
+
+    return this->getSuccessor()->transmit(result);
+}
+
+/** \brief Backwards packet from successor.
+ *
+ *  Receives the next payload from successor and decompresses it, if it is compressed.
+ *  Decompressed payloads are valid until the next call.
+ *  Registration answers are checked for the server accepting compression.
+ *  Returns a status indicator.
+ *
+ *  \param packet Container for the payload, passed to the successor.
+ *  \param begin Begin of the payload.
+ *  \param end End of the payload.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcCompress::backward(shared_ptr<vector<uint8_t>> packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    uint8_t status = this->getSuccessor()->receive(packet, begin, end);
+    if (status != NW_OK || begin == end)
+        return status;
+
+    // Server answers registration with the features it accepts.
+    if (*begin == MSG_ID_REGISTER) {
+        if (this->negotiate)
+            this->enabled = end - begin > 3 && (*(begin+3) & FEATURE_COMPRESS);
+        return NW_OK;
+    }
+
+    if (!(*begin & COMPRESS_FLAG))
+        return NW_OK;
+
+    if (!this->ready)
+        return NW_ERR_UNKNOWN;
+
+    // Decompress behind the message id.
+    (*this->inflated)[0] = *begin & ~COMPRESS_FLAG;
+
+    inflateReset(&this->inflater);
+    this->inflater.next_in = begin+1;
+    this->inflater.avail_in = end-begin-1;
+    this->inflater.next_out = &(*this->inflated)[1];
+    this->inflater.avail_out = this->inflated->size()-1;
+
+    // Payloads never exceed the frame limit, so a single call has to finish.
+    if (inflate(&this->inflater, Z_FINISH) != Z_STREAM_END)
+        return NW_ERR_OUT_OF_BOUNDS;
+
+    begin = &(*this->inflated)[0];
+    end = begin + 1 + this->inflater.total_out;
+
+    return NW_OK;
+}
+
+/** \brief Checks whether payload is worth compressing.
+ *
+ *  Registration frames are needed for negotiation, image and stream fragments are already
+ *  compressed, and small payloads don't gain enough for the compression header.
+ *
+ *  \param packet The payload to check.
+ *  \param length The payload length.
+ *  \return true if the payload should be compressed, false otherwise.
+ */
+bool ProcCompress::isCompressible(shared_ptr<deque<BufferSlice>> &packet, size_t length) {
+
+    if (length < COMPRESS_MIN_SIZE)
+        return false;
+
+    // Get message id and data type, the third byte.
+    uint8_t header[3];
+    size_t count=0;
+    for (auto sliceIt = packet->begin(); sliceIt != packet->end() && count < 3; sliceIt++)
+        for (uint8_t *byte = sliceIt->begin(); byte != sliceIt->end() && count < 3; byte++)
+            header[count++] = *byte;
+
+    if (header[0] == MSG_ID_REGISTER || (header[0] & COMPRESS_FLAG))
+        return false;
+
+    return header[2] != DATA_TYPE_IMG && header[2] != DATA_TYPE_STREAM;
+}
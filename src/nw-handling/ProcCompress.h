@@ -0,0 +1,51 @@
+/*
+ * ProcCompress.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef PROCCOMPRESS_H_
+#define PROCCOMPRESS_H_
+
+#define COMPRESS_FLAG       0x80    // Set in the message id of compressed payloads.
+#define COMPRESS_MIN_SIZE   64      // Smaller payloads are passed unchanged.
+
+#include "FrameProcessor.h"
+#include "ProcPayload.h"
+
+#include <zlib.h>
+
+class ProcCompress : public FrameProcessor {
+public:
+    ProcCompress(uint8_t level, bool negotiate=true);
+    virtual ~ProcCompress();
+    uint8_t initialize();
+    virtual void collectStats(NW_Stats &stats);
+
+protected:
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
+    virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
+            uint8_t *&begin,
+            uint8_t *&end);
+
+private:
+    uint8_t level;
+
+    // Whether compression waits for the server to accept it and whether it is in use.
+    bool negotiate, enabled;
+
+    // Streams are reset per payload, so each payload decompresses on its own.
+    z_stream deflater, inflater;
+    bool ready;
+
+    // Decompressed payload, valid until the next receive.
+    shared_ptr<vector<uint8_t>> inflated;
+
+    // Statistics of compressed payloads.
+    uint64_t bytesIn, bytesOut;
+
+    bool isCompressible(shared_ptr<deque<BufferSlice>> &packet, size_t length);
+};
+
+#endif /* PROCCOMPRESS_H_ */
@@ -12,7 +12,19 @@
  *
  *  Default Constructor of ProcDataFrame instances.
  */
-ProcDataFrame::ProcDataFrame() {}
+ProcDataFrame::ProcDataFrame() {
+
+    this->ring = shared_ptr<vector<uint8_t>>(new vector<uint8_t>(RING_SIZE));
+    this->ringHead = 0;
+    this->ringCount = 0;
+    this->state = PARSE_BEGIN;
+    this->pl_Length = 0;
+
+    this->framesSent = 0;
+    this->framesReceived = 0;
+    this->resyncBytes = 0;
+    this->checksumErrors = 0;
+}
 
 /** \brief Destructor.
  *
@@ -20,6 +32,39 @@ ProcDataFrame::ProcDataFrame() {}
  */
 ProcDataFrame::~ProcDataFrame() {}
 
+/** \brief Reestablishes connection.
+ *
+ *  Discards received bytes of the previous connection, so a truncated frame
+ *  is not completed with data of the new one, and reconnects the successor.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcDataFrame::reconnect() {
+
+    this->ringHead = 0;
+    this->ringCount = 0;
+    this->state = PARSE_BEGIN;
+
+    return FrameProcessor::reconnect();
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds frame counts, bytes skipped while searching for a frame begin and
+ *  frame candidates dropped for a wrong checksum or frame end.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcDataFrame::collectStats(NW_Stats &stats) {
+
+    stats.add("frame.sent", this->framesSent);
+    stats.add("frame.received", this->framesReceived);
+    stats.add("frame.resync_bytes", this->resyncBytes);
+    stats.add("frame.checksum_errors", this->checksumErrors);
+
+    FrameProcessor::collectStats(stats);
+}
+
 /** \brief Forwards packet to successor.
  *
  *  Forwards 'packet' to successor.
@@ -28,27 +73,29 @@ ProcDataFrame::~ProcDataFrame() {}
  *  \param packet The packet to send.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ProcDataFrame::forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet) {
+uint8_t ProcDataFrame::forward(shared_ptr<deque<BufferSlice>> packet) {
 
     // Initialize variables.
-    uint16_t p_Length = 0;
+    uint32_t p_Length = 0;
     uint8_t checksum = CHECKSUM_INIT;
 
-    // Iterate over dque 'packet' to generate checksum and payload length.
+    // Iterate over deque 'packet' to generate checksum and payload length.
     auto packetIt = packet->begin();
     while (packetIt != packet->end()) {
 
         // increase payload length
-        p_Length += (*packetIt)->size();
+        p_Length += packetIt->size();
 
-        // Iterate over each element of the current data vector to generate checksum.
-        auto vectorIt = (*packetIt)->begin();
-        while (vectorIt != (*packetIt)->end())
-            checksum ^= *vectorIt++;
+        // Combine checksum of the current slice.
+        checksum ^= packetIt->getChecksum();
 
         packetIt++;
     }
 
+    // Payload length has to fit into the two length bytes.
+    if (p_Length > UINT16_MAX)
+        return NW_ERR_OUT_OF_BOUNDS;
+
     // Generate payload length.
     uint8_t p_Length_H = p_Length >> 8;
     uint8_t p_Length_L = p_Length % 256;
@@ -71,6 +118,8 @@ uint8_t ProcDataFrame::forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> pa
     packet->push_back(tail);
 
     uint8_t status = this->getSuccessor()->transmit(packet);
+    if (status == NW_OK)
+        this->framesSent++;
 
     return status;
 
@@ -79,11 +128,15 @@ uint8_t ProcDataFrame::forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> pa
 /** \brief Backwards packet from successor.
  *
  *  Backwards packet from successor and assuring frame completeness before returning.
+ *  Received bytes are kept in the receive ring, the frame parser resumes where it stopped
+ *  on the previous call, so bytes are neither copied nor scanned twice.
+ *  The payload is returned in place, if it is contiguous in the ring, and copied to 'packet' otherwise.
+ *  In place payloads are valid until the next call.
  *  Returns a status indicator
  *
- *  \param packet The target container of receiving process.
- *  \param begin The first position to write result to.
- *  \param end The end of the received data
+ *  \param packet Container for payloads wrapping around the ring end.
+ *  \param begin Begin of the payload.
+ *  \param end End of the payload.
  *  \return 0 in case of success, an error code otherwise.
  */
 uint8_t ProcDataFrame::backward(shared_ptr<vector<uint8_t>> packet,
@@ -93,209 +146,256 @@ uint8_t ProcDataFrame::backward(shared_ptr<vector<uint8_t>> packet,
     // Do until maximum attempt is reached.
     for (uint16_t attempt=0; attempt<MAX_ATTEMPT; attempt++) {
 
-        begin=&(*packet)[0];
-        end=begin;
+        // Advance parser with pending bytes, done if a complete frame was found.
+        if (parse())
+            break;
 
-        // Set up packet.
-        while (tail.size() > 0 && end != &(*packet->end())) {
+        // Receive new bytes directly into free space of the ring.
+        uint8_t status = pushRing();
+        if (status != NW_OK)
+            return status;
+    }
 
-            *(end) = tail.front();
-            end++;
-            tail.pop_front();
-        }
+    // No complete frame found.
+    if (this->state != PARSE_DONE)
+        return NW_ERR_UNKNOWN;
 
-        uint8_t status = NW_ERR_UNKNOWN;
+    this->framesReceived++;
 
-        // Check if enough bytes are pending, receive new ones otherwise.
-        // 9 bytes are minimum for complete frame.
-        if ( end-begin < 9 ){
+    // Set begin and end pointer, ignoring leading and tailing frame bytes.
+    size_t first = (this->ringHead + 5) % RING_SIZE;
+    if (first + this->pl_Length <= RING_SIZE) {
 
-            uint8_t *tmpPtr=end;
-            status = this->getSuccessor()->receive(packet, tmpPtr, end);
+        // Payload is contiguous.
+        begin = &(*this->ring)[first];
+        end = begin + this->pl_Length;
 
-            // Still not enough bytes.
-            if ( status != NW_OK || end-begin < 9 ) {
+    } else {
 
-                // Add pending data to tail.
-                tail.insert(tail.begin(), begin, end);
-                continue;
-            }
-        }
+        // Payload wraps around, join both parts.
+        size_t split = RING_SIZE - first;
+        packet->resize(max(packet->size(), (size_t)this->pl_Length));
+        memcpy(&(*packet)[0], &(*this->ring)[first], split);
+        memcpy(&(*packet)[split], &(*this->ring)[0], this->pl_Length - split);
 
-        // Pull frame begin from data
-        status = pullFrameBegin(packet, begin, end);
-        if ( status != NW_OK ) {
+        begin = &(*packet)[0];
+        end = begin + this->pl_Length;
+    }
 
-            // Add pending data to tail.
-            tail.insert(tail.begin(), begin, end);
-            continue;
-        }
+    // Release frame from ring, the memory stays valid until the next receive.
+    popRing(this->pl_Length + 9);
+    this->state = PARSE_BEGIN;
 
-        // Get possible payload length.
-        uint32_t pl_Length=((uint32_t)(*packet)[3]) << 8;
-        pl_Length += (*packet)[4];
+    return NW_OK;
+}
 
-        // Now that the packet length could be estimated, check if it matches.
-        // Packet size is sum of
-        //   length(frame begin)        = 3
-        // + length(payload length)     = 2
-        // + length(payload)            = variable
-        // + length(checksum)           = 1
-        // + length(frame end)          = 3
-        if( end-begin < pl_Length+9 ) {
+/** \brief Receives into ring.
+ *
+ *  Receives from successor into the contiguous free space behind the pending bytes.
+ *  Returns a status indicator.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcDataFrame::pushRing() {
 
-            uint8_t *tmpPtr=end;
-            status = this->getSuccessor()->receive(packet, tmpPtr, end);
+    // Ring is full, which can't happen with valid frames.
+    if (this->ringCount == RING_SIZE)
+        return NW_ERR_OUT_OF_BOUNDS;
 
-            // Still not enough bytes.
-            if ( status != NW_OK || end-begin < pl_Length+9 ) {
+    // Start at the beginning if empty, to keep frames contiguous.
+    if (!this->ringCount)
+        this->ringHead = 0;
 
-                // Add pending data to tail.
-                tail.insert(tail.begin(), begin, end);
-                continue;
-            }
-        }
+    // Get contiguous free space.
+    size_t write = (this->ringHead + this->ringCount) % RING_SIZE;
+    size_t limit = (write >= this->ringHead) ? RING_SIZE : this->ringHead;
 
-        // Generate checksum with payload.
-        uint8_t checksum=0;
-        pullPayload(packet, pl_Length, checksum, begin, end);
+    uint8_t *begin = &(*this->ring)[write];
+    uint8_t *end = &(*this->ring)[0] + limit;
 
-        // In case calculated and received checksum match.
-        if( (*packet)[pl_Length + 5] == checksum ) {
+    uint8_t status = this->getSuccessor()->receive(this->ring, begin, end);
+    if (status != NW_OK)
+        return status;
 
-            // Get frame end candidate.
-            status = pullFrameEnd(packet, pl_Length, begin, end);
+    this->ringCount += end - begin;
 
-            if( status != NW_OK ) {
+    return NW_OK;
+}
 
-                // Add pending data to tail without first byte.
-                tail.insert(tail.begin(), begin+1, end);
-                continue;
-            }
+/** \brief Releases bytes from ring.
+ *
+ *  Drops the first 'count' pending bytes.
+ *
+ *  \param count Number of bytes to drop.
+ */
+void ProcDataFrame::popRing(size_t count) {
+
+    count = min(count, this->ringCount);
+    this->ringHead = (this->ringHead + count) % RING_SIZE;
+    this->ringCount -= count;
+}
+
+/** \brief Getter for pending byte.
+ *
+ *  Returns the pending byte at position 'index', relative to the first pending byte.
+ *
+ *  \param index Position of the byte.
+ *  \return The byte.
+ */
+uint8_t ProcDataFrame::atRing(size_t index) {
+    return (*this->ring)[(this->ringHead + index) % RING_SIZE];
+}
+
+/** \brief Advances frame parser.
+ *
+ *  Processes the pending bytes as far as possible, continuing in the state of the last call.
+ *  Returns whether a complete and valid frame is found at the beginning of the ring.
+ *
+ *  \return true if a frame is complete, false if more bytes are needed.
+ */
+bool ProcDataFrame::parse() {
+
+    while (true) {
+
+        switch (this->state) {
+
+        case PARSE_BEGIN:
+
+            // Search for frame begin.
+            if (pullFrameBegin() != NW_OK)
+                return false;
+
+            this->state = PARSE_LENGTH;
+            break;
+
+        case PARSE_LENGTH:
+
+            // Get payload length.
+            if (pullPayloadLength() != NW_OK)
+                return false;
 
-            // Copy currently unused tail of this packet.
-            if( end-begin > pl_Length+9 )
-                tail.insert(tail.begin(), begin + pl_Length + 9, end);
+            this->state = PARSE_PAYLOAD;
+            break;
 
-            // Set begin and end pointer,
-            // ignoring leading and tailing frame bytes.
-            begin+=5;
-            end=begin + pl_Length;
-            return NW_OK;
+        case PARSE_PAYLOAD:
+        {
+            // Packet size is sum of
+            //   length(frame begin)        = 3
+            // + length(payload length)     = 2
+            // + length(payload)            = variable
+            // + length(checksum)           = 1
+            // + length(frame end)          = 3
+            if (this->ringCount < this->pl_Length + 9)
+                return false;
 
-        } else {
+            // Generate checksum with payload.
+            uint8_t checksum=CHECKSUM_INIT;
+            pullPayload(checksum);
 
-            // Add pending data to tail without first byte.
-            tail.insert(tail.begin(), begin+1, end);
-            continue;
+            // In case calculated and received checksum and frame end match, frame is complete.
+            bool ended = pullFrameEnd() == NW_OK;
+            if (ended && atRing(this->pl_Length + 5) == checksum) {
+                this->state = PARSE_DONE;
+                return true;
+            }
+
+            // A frame with corrupted payload is dropped as a whole, otherwise its frame end would be
+            // taken for the begin of a frame with a bogus length, stalling all frames behind it.
+            // Anything else is not a frame, resume search behind the first byte of this candidate.
+            this->checksumErrors++;
+            popRing(ended ? this->pl_Length + 9 : 1);
+            this->state = PARSE_BEGIN;
+            break;
         }
-    }
 
-    return NW_ERR_UNKNOWN;
+        case PARSE_DONE:
+        default:
+            return true;
+        }
+    }
 }
 
 /** \brief Searches for frame begin
  *
- *  Searches for frame begin sequence in packet 'packet'.
+ *  Searches for frame begin sequence in the pending bytes, dropping all bytes in front of it.
  *
- *  \param packet The target container of receiving process.
- *  \param begin The first position in the data frame.
- *  \param end The last position of the data.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ProcDataFrame::pullFrameBegin(shared_ptr<vector<uint8_t>> packet,
-        uint8_t *&begin,
-        uint8_t *&end) {
+uint8_t ProcDataFrame::pullFrameBegin() {
+
+    size_t pending = this->ringCount;
+    uint8_t status = NW_ERR_NOT_ENOUGH_CHARS;
 
     // Do until either frame begin is found or an error occurs.
-    while ( begin+2 < end ) {
+    while ( this->ringCount > 2 ) {
 
         // Search for frame begin sequence.
-        if ( *begin == FRAME_BEGIN1 ) // 1st of 3 matches.
-            if ( *(begin+1) == FRAME_BEGIN2 ) // 2nd of 3 matches.
-                if ( *(begin+2) == FRAME_BEGIN3 ) // 3rd of 3 matches - probably found frame begin
-                    return NW_OK; // Successfully found frame begin candidate.
-                else // Not enough matches, ignore first 3 bytes.
-                    begin+=3;
-            else // Not enough matches, ignore first 2 bytes (3rd one yet unchecked).
-                begin+=2;
+        if ( atRing(0) == FRAME_BEGIN1 ) // 1st of 3 matches.
+            if ( atRing(1) == FRAME_BEGIN2 ) // 2nd of 3 matches.
+                if ( atRing(2) == FRAME_BEGIN3 ) { // 3rd of 3 matches - probably found frame begin
+                    status = NW_OK; // Successfully found frame begin candidate.
+                    break;
+                } else // Not enough matches, ignore first 3 bytes.
+                    popRing(3);
+            else // Not enough matches, ignore first byte (2nd one could start the frame).
+                popRing(1);
         else // Not enough matches, ignore first byte (2nd and 3rd one yet unchecked).
-            begin+=1;
+            popRing(1);
     }
 
-    return NW_ERR_NOT_ENOUGH_CHARS;
+    // Count skipped bytes.
+    this->resyncBytes += pending - this->ringCount;
+
+    return status;
 }
 
 /** \brief Calculates payload length.
  *
- *  Calculates the payload length of data frame candidate 'packet' and writes it into pl_Length.
+ *  Calculates the payload length of the frame candidate and writes it into pl_Length.
  *
- *  \param packet The target container of receiving process.
- *  \param pl_Length The target to write the payload length to.
- *  \param begin The first position in the data frame.
- *  \param end The last position of the data.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ProcDataFrame::pullPayloadLength(shared_ptr<vector<uint8_t>> packet,
-        uint32_t &pl_Length,
-        shared_ptr<uint8_t> &begin,
-        shared_ptr<uint8_t> &end) {
+uint8_t ProcDataFrame::pullPayloadLength() {
+
+    if (this->ringCount < 5)
+        return NW_ERR_NOT_ENOUGH_CHARS;
 
     // Get payload length.
-    pl_Length = ((uint32_t)packet->at(3)) << 8;
-    pl_Length += packet->at(4);
+    this->pl_Length = ((uint32_t)atRing(3)) << 8;
+    this->pl_Length += atRing(4);
 
     return NW_OK;
-
 }
 
 /** \brief Processes data content.
  *
- *  Iterates over data in 'packet' of length 'pl_Length' and writes calculated checksum to 'checksum'.
+ *  Calculates the checksum of the payload of the frame candidate and writes it to 'checksum'.
  *
- *  \param packet The target container of receiving process.
- *  \param pl_Length The payload length to calculate the checksum for.
- *  \param pl_Length The variable containing the checksum after this operation.
- *  \param begin The first position in the data frame.
- *  \param end The last position of the data.
+ *  \param checksum The variable containing the checksum after this operation.
  */
-void ProcDataFrame::pullPayload(shared_ptr<vector<uint8_t>> packet,
-        uint32_t pl_Length,
-        uint8_t &checksum,
-        uint8_t *&begin,
-        uint8_t *&end) {
+void ProcDataFrame::pullPayload(uint8_t &checksum) {
 
-    // Initialize pointer for going through buffer.
-    uint8_t *ptr=begin+5;
+    size_t first = (this->ringHead + 5) % RING_SIZE;
+    size_t split = min((size_t)this->pl_Length, RING_SIZE - first);
 
-    // Generate checksum.
-    while ( ptr != begin +pl_Length+5 ) {
-
-        checksum ^= *ptr;
-        ptr++;
-    }
+    // Generate checksum, in two parts if the payload wraps around.
+    checksum = Checksum::xorBytes(&(*this->ring)[first], split, checksum);
+    checksum = Checksum::xorBytes(&(*this->ring)[0], this->pl_Length - split, checksum);
 }
 
 /** \brief Checks frame end.
  *
- *  Searches for frame end sequence in packet 'packet' at the expected position.
+ *  Searches for frame end sequence of the frame candidate at the expected position.
  *  Returns a status indicator.
  *
- *  \param packet The target container of receiving process.
- *  \param pl_Length The payload length of this frame candidate.
- *  \param begin The first position in the data frame.
- *  \param end The last position of the data.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ProcDataFrame::pullFrameEnd(shared_ptr<vector<uint8_t>> packet,
-        uint32_t pl_Length,
-        uint8_t *&begin,
-        uint8_t *&end) {
+uint8_t ProcDataFrame::pullFrameEnd() {
 
     // Search for frame end sequence.
-    if ( (*packet)[pl_Length+6] == FRAME_END1 ) // 1st of 3 matches.
-        if ( (*packet)[pl_Length+7] == FRAME_END2 ) // 2nd of 3 matches.
-            if ( (*packet)[pl_Length+8] == FRAME_END3 ) // 3rd of 3 matches - probably found frame end
+    if ( atRing(this->pl_Length+6) == FRAME_END1 ) // 1st of 3 matches.
+        if ( atRing(this->pl_Length+7) == FRAME_END2 ) // 2nd of 3 matches.
+            if ( atRing(this->pl_Length+8) == FRAME_END3 ) // 3rd of 3 matches - probably found frame end
                 return NW_OK; // Successfully found frame end.
 
     return NW_ERR_SEQUENCE_MISMATCH;
@@ -18,43 +18,56 @@
 #define FRAME_END3       FRAME_BEGIN3
 #define CHECKSUM_INIT   0x00
 
+#define RING_SIZE       (2*(FRAME_SIZE))
+
+#include "Checksum.h"
 #include "FrameProcessor.h"
 
+#include <algorithm>
+#include <cstring>
+
+typedef enum {
+    PARSE_BEGIN,
+    PARSE_LENGTH,
+    PARSE_PAYLOAD,
+    PARSE_DONE
+}frameParseState;
+
 class ProcDataFrame : public FrameProcessor {
 public:
     ProcDataFrame();
     virtual ~ProcDataFrame();
+    virtual uint8_t reconnect();
+    virtual void collectStats(NW_Stats &stats);
 
 protected:
-    virtual uint8_t forward(shared_ptr<deque<shared_ptr<vector<uint8_t>>>> packet);
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
     virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
             uint8_t *&begin,
             uint8_t *&end);
 
 private:
-    uint8_t pullFrameBegin(shared_ptr<vector<uint8_t>> packet,
-            uint8_t             *&begin,
-            uint8_t             *&end);
-    uint8_t pullPayloadLength(shared_ptr<vector<uint8_t>> packet,
-            uint32_t            &pl_Length,
-            shared_ptr<uint8_t> &begin,
-            shared_ptr<uint8_t> &end);
-    void pullPayload(shared_ptr<vector<uint8_t>> packet,
-            uint32_t pl_Length,
-            uint8_t  &checksum,
-            uint8_t  *&begin,
-            uint8_t  *&end);
-    uint8_t pullFrameEnd(shared_ptr<vector<uint8_t>> packet,
-            uint32_t pl_Length,
-            uint8_t  *&begin,
-            uint8_t  *&end);
-    deque<shared_ptr<vector<uint8_t>>> pending;
-
-    uint8_t pullFrameBegin(shared_ptr<deque<uint8_t>> packet);
-    uint8_t pullPayloadLength(shared_ptr<deque<uint8_t>> packet, uint32_t* pl_Length);
-    uint8_t pullPayload(shared_ptr<deque<uint8_t>> packet, uint32_t pl_Length, uint8_t* checksum);
-    uint8_t pullFrameEnd(shared_ptr<deque<uint8_t>> packet, uint32_t pl_Length);
-    deque<uint8_t> tail;
+
+    // Receive ring, holding pending bytes from 'ringHead' on.
+    shared_ptr<vector<uint8_t>> ring;
+    size_t ringHead, ringCount;
+
+    // Parser state and payload length of the current frame candidate.
+    uint8_t state;
+    uint32_t pl_Length;
+
+    // Statistics.
+    uint64_t framesSent, framesReceived, resyncBytes;
+    uint32_t checksumErrors;
+
+    uint8_t pushRing();
+    void popRing(size_t count);
+    uint8_t atRing(size_t index);
+    bool parse();
+    uint8_t pullFrameBegin();
+    uint8_t pullPayloadLength();
+    void pullPayload(uint8_t &checksum);
+    uint8_t pullFrameEnd();
 };
 
 #endif /* PROCDATAFRAME_H_ */
@@ -0,0 +1,163 @@
+/** \brief      Datagram frame processor.
+ *
+ * \details     Sends each payload as a datagram of its own, for realtime media over an unreliable
+ *              transport. Each datagram starts with a 32 bit sequence number, so the receiver
+ *              detects lost datagrams, followed by a 16 bit frame id, so fragments of different
+ *              images are never mixed up. A new frame starts with the fragment of index 1, as
+ *              emitted by ProcPayload with a 16 bit fragment count and index behind the data type.
+ *              All numbers are big endian.
+ *              Datagrams the socket does not take are retried on flush, until they are older than
+ *              the deadline and dropped. Stale media are worthless, so the stream degrades instead
+ *              of stalling.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       ProcDatagram
+ */
+
+#include "ProcDatagram.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of ProcDatagram instances.
+ *
+ *  \param deadline Milliseconds a datagram may wait for sending before it is dropped.
+ */
+ProcDatagram::ProcDatagram(uint32_t deadline) {
+
+    this->deadline=deadline;
+    this->sequence=0;
+    this->frame=0;
+    this->dropped=0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of ProcDatagram instances.
+ */
+ProcDatagram::~ProcDatagram() { }
+
+/** \brief Getter for dropped datagrams.
+ *
+ *  Returns the number of datagrams dropped, since they could not be sent in time.
+ *
+ *  \return Number of dropped datagrams.
+ */
+uint32_t ProcDatagram::getDropped() {
+    return this->dropped;
+}
+
+/** \brief Checks for congestion.
+ *
+ *  Datagrams are dropped instead of held back, so packets never have to wait.
+ *
+ *  \return false.
+ */
+bool ProcDatagram::isCongested() {
+    return false;
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds the number of datagrams sent and dropped.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcDatagram::collectStats(NW_Stats &stats) {
+
+    stats.add("datagram.sent", this->sequence - this->pending.size() - this->dropped);
+    stats.add("datagram.dropped", this->dropped);
+
+    FrameProcessor::collectStats(stats);
+}
+
+/** \brief Forwards packet to successor.
+ *
+ *  Prepends sequence number and frame id to 'packet' and sends it, or queues it if the
+ *  socket does not take it.
+ *
+ *  \param packet The packet to send.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcDatagram::forward(shared_ptr<deque<BufferSlice>> packet) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    // Fragment index follows message id, device id, data type and fragment count,
+    // the first fragment starts a new frame.
+    uint8_t header[DATAGRAM_MEDIA_HEADER] = { 0 };
+    size_t count=0;
+    for (auto sliceIt = packet->begin(); sliceIt != packet->end() && count < DATAGRAM_MEDIA_HEADER; sliceIt++)
+        for (uint8_t *byte = sliceIt->begin(); byte != sliceIt->end() && count < DATAGRAM_MEDIA_HEADER; byte++)
+            header[count++] = *byte;
+
+    if (count == DATAGRAM_MEDIA_HEADER && ((header[5] << 8) | header[6]) == 1)
+        this->frame++;
+
+    shared_ptr<vector<uint8_t>> prefix(new vector<uint8_t>(DATAGRAM_HEADER));
+    (*prefix)[0] = this->sequence >> 24;
+    (*prefix)[1] = this->sequence >> 16;
+    (*prefix)[2] = this->sequence >> 8;
+    (*prefix)[3] = this->sequence;
+    (*prefix)[4] = this->frame >> 8;
+    (*prefix)[5] = this->frame;
+    this->sequence++;
+
+    packet->push_front(prefix);
+
+    pendingDatagram next;
+    next.queued = chrono::steady_clock::now();
+    next.packet = packet;
+    this->pending.push_back(next);
+
+    return flush();
+}
+
+/** \brief Flushes pending datagrams.
+ *
+ *  Drops datagrams older than the deadline and sends the others, as far as the socket takes them.
+ *  Send errors drop the datagram, media losses are no reason to fail the connection.
+ *
+ *  \return 0
+ */
+uint8_t ProcDatagram::flush() {
+
+    auto now = chrono::steady_clock::now();
+
+    while (!this->pending.empty()) {
+
+        pendingDatagram &next = this->pending.front();
+
+        if (chrono::duration_cast<chrono::milliseconds>(now - next.queued).count() > this->deadline) {
+            this->pending.pop_front();
+            this->dropped++;
+            continue;
+        }
+
+        uint8_t status = this->getSuccessor()->transmit(next.packet);
+        if (status == NW_ERR_WOULD_BLOCK)
+            break;
+
+        if (status != NW_OK)
+            this->dropped++;
+
+        this->pending.pop_front();
+    }
+
+    return NW_OK;
+}
+
+/** \brief Backwards packet from successor.
+ *
+ *  Datagrams are only sent, so nothing is received.
+ *
+ *  \param packet The container for the next packet content.
+ *  \param begin Begin of the data.
+ *  \param end End of the data.
+ *  \return NW_ERR_WOULD_BLOCK.
+ */
+uint8_t ProcDatagram::backward(shared_ptr<vector<uint8_t>> packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+    return NW_ERR_WOULD_BLOCK;
+}
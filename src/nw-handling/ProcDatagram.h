@@ -0,0 +1,53 @@
+/*
+ * ProcDatagram.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef PROCDATAGRAM_H_
+#define PROCDATAGRAM_H_
+
+#define DATAGRAM_DEADLINE   500     // Milliseconds a datagram may wait for sending.
+#define DATAGRAM_HEADER     6       // Sequence number and frame id.
+#define DATAGRAM_MEDIA_HEADER   7   // Media fragment header up to the fragment index, see ProcPayload.
+
+#include "FrameProcessor.h"
+
+#include <chrono>
+#include <deque>
+
+/** Datagram waiting for sending. */
+typedef struct pendingDatagram {
+    chrono::steady_clock::time_point queued;
+    shared_ptr<deque<BufferSlice>> packet;
+}pendingDatagram;
+
+class ProcDatagram : public FrameProcessor {
+public:
+    ProcDatagram(uint32_t deadline=DATAGRAM_DEADLINE);
+    virtual ~ProcDatagram();
+    virtual uint8_t flush();
+    virtual bool isCongested();
+    virtual void collectStats(NW_Stats &stats);
+    uint32_t getDropped();
+
+protected:
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
+    virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
+            uint8_t *&begin,
+            uint8_t *&end);
+
+private:
+    uint32_t deadline;
+
+    // Sequence number of the next datagram and id of the current fragmented frame.
+    uint32_t sequence;
+    uint16_t frame;
+
+    // Datagrams not taken by the socket yet, oldest first.
+    deque<pendingDatagram> pending;
+    uint32_t dropped;
+};
+
+#endif /* PROCDATAGRAM_H_ */
@@ -11,11 +11,26 @@
 /** \brief Constructor.
  *
  *  Constructor of ProcPayload instances, initializing the needed fields.
+ *  Telemetry is encoded according to protocol version 'protocol', until the server selects
+ *  another one in answer to the registration.
  *
  *  \param devID Device ID of this obu, which gets sent in each frame.
+ *  \param protocol Initial protocol version.
+ *  \param features Optional features offered to the server on registration.
  */
-ProcPayload::ProcPayload(uint8_t devID) {
+ProcPayload::ProcPayload(uint8_t devID, uint8_t protocol, uint8_t features) {
     this->devID=devID;
+    this->protocol=protocol;
+    this->features=features;
+    this->streaming=false;
+    this->rcvBuffer=shared_ptr<vector<uint8_t>>(new vector<uint8_t>(PAYLOAD_SIZE));
+
+    this->messagesPushed=0;
+    this->messagesPulled=0;
+    this->messagesShared=0;
+    this->mediaOversize=0;
+    for (uint8_t priority=0; priority < PRIORITY_COUNT; priority++)
+        this->packetsSent[priority]=0;
 }
 
 /** \brief Destructor.
@@ -26,7 +41,10 @@ ProcPayload::~ProcPayload() { }
 
 /** \brief Pushes output to chain of transmission..
  *
- *  Converts message 'output' into packets for sending and transmits them to successor.
+ *  Converts message 'output' into packets for sending and queues them by priority.
+ *  The packets are transmitted to successor on flush.
+ *  If the message carries a SharedPayload, it is encoded only once per encoding and the
+ *  packets are shared with all other communicators it was pushed to.
  *  Returns status indicator.
  *
  *  \param output The message to convert and send.
@@ -35,98 +53,349 @@ ProcPayload::~ProcPayload() { }
 uint8_t ProcPayload::push(shared_ptr<Message_M2C> output) {
 
     uint8_t status=NW_OK;
-    queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> outBuffer;
+    queue< shared_ptr< deque<BufferSlice>>> outBuffer;
 
     if (output) {
 
-        // Switch output type .
-        switch (output->getType()) {
-
-        case MSG_REGISTER:
-        {
-            // Build packets to transmit.
-            status = packRegister(outBuffer);
+        // Reuse packets already encoded by another communicator.
+        shared_ptr<Value> encoded_Value;
+        shared_ptr<SharedPayload> encoded;
+        if (output->getValue(ARG_ENCODED, encoded_Value) == OK)
+            encoded = dynamic_pointer_cast<SharedPayload>(encoded_Value);
+
+        if (encoded && encoded->lookup(getEncoding(), outBuffer))
+            this->messagesShared++;
+        else {
+
+            // Switch output type .
+            switch (output->getType()) {
+
+            case MSG_REGISTER:
+                status = packRegister(outBuffer);
+                break;
+
+            case MSG_DATA_COMPLETE:
+                status = packAcquiredData(outBuffer,
+                        dynamic_pointer_cast<M2C_DataSet>(output));
+                break;
+
+            case MSG_EVENT:
+                status = packEvent(outBuffer,
+                        dynamic_pointer_cast<M2C_Event>(output));
+                break;
+
+            case MSG_SAMPLES:
+                status = packSamples(outBuffer,
+                        dynamic_pointer_cast<M2C_Samples>(output));
+                break;
+
+            case MSG_STATS:
+                status = packStats(outBuffer,
+                        dynamic_pointer_cast<M2C_Stats>(output));
+                break;
+
+            default:
+                break;
+            }
 
             // An error occurred.
             if( status != OK ) return status;
 
-            // Transmit all pending packets.
-            for (uint16_t count = 0; count < MAX_ATTEMPT_PROC_PL && outBuffer.size(); count++) {
-                status = transmit(outBuffer.front());
-                outBuffer.pop();
-            }
+            // Let other communicators with the same encoding reuse the packets.
+            if (encoded)
+                encoded->store(getEncoding(), outBuffer);
+        }
 
-            // Sending failed.
-            if (status) return status;
+        this->messagesPushed++;
 
-        } break;
+        // Queue all packets of the message with the priority of its first packet, so a data set
+        // never overtakes its own image fragments. Fragments taking the media channel are sent
+        // apart from the chain anyway, there each packet is queued by its own priority.
+        uint8_t priority = outBuffer.empty() ? PRIORITY_CONTROL : getPriority(outBuffer.front());
+        while (outBuffer.size()) {
+            this->pending[this->media ? getPriority(outBuffer.front()) : priority].push(outBuffer.front());
+            outBuffer.pop();
+        }
+    }
 
-        case MSG_DATA_COMPLETE:
-        {
-            // Build packets to transmit.
-            status = packAcquiredData(outBuffer,
-                    dynamic_pointer_cast<M2C_DataSet>(output));
+    return NW_OK;
+}
 
-            // An error occurred.
-            if( status != OK ) return status;
+/** \brief Setter for media channel.
+ *
+ *  Sends image and stream fragments over the chain 'media' instead of the successor,
+ *  e.g. as datagrams. Registration, events and telemetry stay on the successor, so a data set
+ *  may arrive before its image fragments. Media fragments count fragments and their index in
+ *  16 bit, big endian, instead of 8 bit.
+ *
+ *  \param media First processor of the media chain.
+ */
+void ProcPayload::setMediaChannel(shared_ptr<FrameProcessor> media) {
+    this->media=media;
+}
 
-            // Transmit all pending packets.
-            for (uint16_t count = 0; count < MAX_ATTEMPT_PROC_PL && outBuffer.size(); count++) {
-                status = transmit(outBuffer.front());
-                outBuffer.pop();
-            }
+/** \brief Setter for shaper.
+ *
+ *  Limits the send rate of image fragments and of all other packets to the budgets of 'shaper'.
+ *  Packets over budget stay queued, other classes pass them. Registration is never held back.
+ *
+ *  \param shaper The shaper, empty to not limit the send rate.
+ */
+void ProcPayload::setShaper(shared_ptr<NW_Shaper> shaper) {
+    this->shaper=shaper;
+}
 
-            // Sending failed.
-            if (status) return status;
+/** \brief Checks for congestion.
+ *
+ *  Image fragments waiting for the shaper congest the chain as well, so no further
+ *  acquisitions queue up behind them.
+ *
+ *  \return true if packets would have to wait, false otherwise.
+ */
+bool ProcPayload::isCongested() {
 
-        } break;
+    if (this->shaper && !this->pending[PRIORITY_BULK].empty() && this->shaper->getDelay(SHAPE_IMAGE) > 0)
+        return true;
 
-        case MSG_EVENT:
-        {
-            // Build packets to transmit.
-            status = packEvent(outBuffer,
-                    dynamic_pointer_cast<M2C_Event>(output));
+    return FrameProcessor::isCongested();
+}
 
-            // An error occurred.
-            if( status != OK ) return status;
+/** \brief Gets time until held back data may be sent.
+ *
+ *  Returns when the shaper grants tokens to the next class with packets waiting for them,
+ *  or when the rest of the chain wants to be flushed, whichever comes first.
+ *  While the chain is congested, packets wait for it instead.
+ *
+ *  \return Milliseconds until the next flush is due, -1 if nothing is held back by time.
+ */
+int32_t ProcPayload::getDelay() {
 
-            // Transmit all pending packets.
-            for (uint16_t count = 0; count < MAX_ATTEMPT_PROC_PL && outBuffer.size(); count++) {
-                status = transmit(outBuffer.front());
-                outBuffer.pop();
-            }
+    int32_t delay = FrameProcessor::getDelay();
 
-            // Sending failed.
-            if (status) return status;
+    if (!this->shaper || FrameProcessor::isCongested())
+        return delay;
 
-        } break;
+    for (uint8_t priority=PRIORITY_CONTROL+1; priority < PRIORITY_COUNT; priority++) {
 
-        default:
-            break;
+        if (this->pending[priority].empty())
+            continue;
+
+        int32_t due = this->shaper->getDelay(getShapeClass(priority));
+        if (due >= 0 && (delay < 0 || due < delay))
+            delay = due;
+    }
+
+    return delay;
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds message counts, packets sent and queued per priority and the statistics of the
+ *  media channel, if any.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcPayload::collectStats(NW_Stats &stats) {
+
+    static const char *names[PRIORITY_COUNT] = { "control", "event", "telemetry", "bulk" };
+
+    stats.add("payload.messages_pushed", this->messagesPushed);
+    stats.add("payload.messages_pulled", this->messagesPulled);
+    stats.add("payload.messages_shared", this->messagesShared);
+    stats.add("payload.media_oversize", this->mediaOversize);
+    for (uint8_t priority=0; priority < PRIORITY_COUNT; priority++) {
+        stats.add(string("payload.sent_") + names[priority], this->packetsSent[priority]);
+        stats.add(string("payload.queued_") + names[priority], this->pending[priority].size());
+    }
+
+    if (this->media) {
+        NW_Stats media;
+        this->media->collectStats(media);
+        stats.merge("media.", media);
+    }
+
+    if (this->shaper)
+        this->shaper->collectStats(stats);
+
+    FrameProcessor::collectStats(stats);
+}
+
+/** \brief Flushes pending packets.
+ *
+ *  Transmits queued packets to successor, the most urgent first. A packet is only transmitted
+ *  once the chain passed on everything before, so urgent packets overtake bulk data queued
+ *  earlier at the next packet boundary. Packets of the same priority keep their order.
+ *  If a media channel is set, image and stream fragments are sent there right away.
+ *  Packets held back by a congested chain are only reported as pending, if the connection
+ *  has to become writable first, not if they wait e.g. for acknowledgements. Registration
+ *  is never held back, the chain may wait for its answer.
+ *  The packets of one call are marked as a burst, so the connection may batch them.
+ *  If a shaper is set, packets over budget stay queued until their class has tokens again.
+ *
+ *  \return 0 if the connection has nothing pending, NW_ERR_WOULD_BLOCK if data are still pending, an error code otherwise.
+ */
+uint8_t ProcPayload::flush() {
+
+    // Media fragments take their own channel, they never wait for the chain.
+    if (this->media) {
+        while (!this->pending[PRIORITY_BULK].empty() && isAdmitted(PRIORITY_BULK)) {
+            charge(PRIORITY_BULK, this->pending[PRIORITY_BULK].front());
+            this->media->transmit(this->pending[PRIORITY_BULK].front());
+            this->pending[PRIORITY_BULK].pop();
+            this->packetsSent[PRIORITY_BULK]++;
         }
+        this->media->flush();
+    }
+
+    uint8_t status = FrameProcessor::flush();
+    cork(true);
+
+    while (status == NW_OK || status == NW_ERR_WOULD_BLOCK) {
+
+        // Find most urgent packet within its budget.
+        uint8_t priority=0;
+        while (priority < PRIORITY_COUNT && (this->pending[priority].empty() || !isAdmitted(priority)))
+            priority++;
+
+        // Nothing to send anymore, keep packets until the chain is free again.
+        if (priority == PRIORITY_COUNT || (priority != PRIORITY_CONTROL && FrameProcessor::isCongested()))
+            break;
+
+        shared_ptr<deque<BufferSlice>> packet = this->pending[priority].front();
+        this->pending[priority].pop();
 
+        // Later processors extend the packet, so charge it before.
+        charge(priority, packet);
+
+        status = transmit(packet);
+        if (status == NW_OK) {
+            this->packetsSent[priority]++;
+            status = FrameProcessor::flush();
+        }
     }
 
-    return NW_OK;
+    // Send the rest of the burst.
+    cork(false);
+    if (status == NW_OK || status == NW_ERR_WOULD_BLOCK)
+        status = FrameProcessor::flush();
+
+    return status;
+}
+
+/** \brief Reconnects.
+ *
+ *  Features are negotiated per connection, so stream fragments wait for the next registration answer.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcPayload::reconnect() {
+
+    this->streaming=false;
+    return FrameProcessor::reconnect();
+}
+
+/** \brief Gets encoding key.
+ *
+ *  Packets of the same message are equal for all instances with the same device id and
+ *  protocol version, which either both send media fragments over a media channel or not,
+ *  and both send stream fragments or not.
+ *
+ *  \return The key identifying the encoding of this instance.
+ */
+uint32_t ProcPayload::getEncoding() {
+    return this->devID | this->protocol << 8 | (this->media ? 1 << 16 : 0) | (this->streaming ? 1 << 17 : 0);
+}
+
+/** \brief Gets traffic class of priority.
+ *
+ *  \param priority The packet priority.
+ *  \return The shaper class, SHAPE_IMAGE for image and stream fragments, SHAPE_TELEMETRY otherwise.
+ */
+uint8_t ProcPayload::getShapeClass(uint8_t priority) {
+    return priority == PRIORITY_BULK ? SHAPE_IMAGE : SHAPE_TELEMETRY;
+}
+
+/** \brief Checks whether packets of a priority are within budget.
+ *
+ *  \param priority The packet priority.
+ *  \return true if no shaper is set, the packet is a registration or its class has tokens left, false otherwise.
+ */
+bool ProcPayload::isAdmitted(uint8_t priority) {
+    return !this->shaper || priority == PRIORITY_CONTROL || this->shaper->admit(getShapeClass(priority));
+}
+
+/** \brief Charges packet to the shaper.
+ *
+ *  Charges the payload length of 'packet' and the frame around it to the class of 'priority'.
+ *
+ *  \param priority The packet priority.
+ *  \param packet The packet to be sent.
+ */
+void ProcPayload::charge(uint8_t priority, const shared_ptr<deque<BufferSlice>> &packet) {
+
+    if (!this->shaper)
+        return;
+
+    size_t length=SHAPE_FRAME_OVERHEAD;
+    for (auto &slice : *packet)
+        length += slice.size();
+
+    this->shaper->charge(getShapeClass(priority), length);
+}
+
+/** \brief Gets packet priority.
+ *
+ *  Classifies 'packet' by its message id and data type. Registration comes first, events
+ *  before telemetry, and image and stream fragments last.
+ *
+ *  \param packet The packet to classify.
+ *  \return The priority, 0 being most urgent.
+ */
+uint8_t ProcPayload::getPriority(const shared_ptr<deque<BufferSlice>> &packet) {
+
+    // Get message id and data type, the third byte.
+    uint8_t header[3] = { 0, 0, 0 };
+    size_t count=0;
+    for (auto sliceIt = packet->begin(); sliceIt != packet->end() && count < 3; sliceIt++)
+        for (uint8_t *byte = sliceIt->begin(); byte != sliceIt->end() && count < 3; byte++)
+            header[count++] = *byte;
+
+    switch (header[0]) {
+    case MSG_ID_REGISTER:
+        return PRIORITY_CONTROL;
+    case MSG_ID_EVENT:
+        return PRIORITY_EVENT;
+    default:
+        if (header[2] == DATA_TYPE_IMG || header[2] == DATA_TYPE_STREAM)
+            return PRIORITY_BULK;
+        return PRIORITY_TELEMETRY;
+    }
 }
 
 /** \brief Packs frame for obu registration.
  *
  *  Builds frame for obu registration and writes it to 'packets'.
+ *  Besides the device id, the frame holds the protocol version in use and the highest
+ *  version supported, so the server may select a newer one, followed by the optional
+ *  features offered, if any.
  *  Returns status indicator.
  *
  *  \param packets The data container to write the frame to.
  *  \return 0 in case of success, an error code otherwise.
  */
-uint8_t ProcPayload::packRegister(queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> &packets) {
+uint8_t ProcPayload::packRegister(queue< shared_ptr< deque<BufferSlice>>> &packets) {
 
     // Initialize data containers.
-    shared_ptr<deque<shared_ptr<vector<uint8_t>>>> regBlock(new deque<shared_ptr<vector<uint8_t>>>);
+    shared_ptr<deque<BufferSlice>> regBlock(new deque<BufferSlice>);
     shared_ptr<vector<uint8_t>> reg(new vector<uint8_t>);
 
     // Write message id and device id to packet.
     reg->push_back(MSG_ID_REGISTER);
     reg->push_back(this->devID);
+    reg->push_back(this->protocol);
+    reg->push_back(PROTOCOL_VERSION);
+    if (this->features)
+        reg->push_back(this->features);
 
     // Add packet to list.
     regBlock->push_back(reg);
@@ -145,7 +414,7 @@ uint8_t ProcPayload::packRegister(queue< shared_ptr< deque< shared_ptr<vector<ui
  *  \return 0 in case of success, an error code otherwise.
  */
 uint8_t ProcPayload::packAcquiredData(
-        queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> &packets,
+        queue< shared_ptr< deque<BufferSlice>>> &packets,
         shared_ptr<M2C_DataSet> data) {
 
     shared_ptr<Value> img_Value;
@@ -250,70 +519,41 @@ uint8_t ProcPayload::packAcquiredData(
 
     // Get argument values.
     shared_ptr<vector<uint8_t>> img = (dynamic_pointer_cast<ValVectorUChar>(img_Value))->getValue();
-    string posE = (dynamic_pointer_cast<ValString>(posE_Value))->getValue();
-    string posN = (dynamic_pointer_cast<ValString>(posN_Value))->getValue();
-    string posH = (dynamic_pointer_cast<ValString>(posH_Value))->getValue();
-    string accX = (dynamic_pointer_cast<ValString>(accX_Value))->getValue();
-    string accY = (dynamic_pointer_cast<ValString>(accY_Value))->getValue();
-    string accZ = (dynamic_pointer_cast<ValString>(accZ_Value))->getValue();
-    string gyroX = (dynamic_pointer_cast<ValString>(gyroX_Value))->getValue();
-    string gyroY = (dynamic_pointer_cast<ValString>(gyroY_Value))->getValue();
-    string gyroZ = (dynamic_pointer_cast<ValString>(gyroZ_Value))->getValue();
-
-    string speed = (dynamic_pointer_cast<ValString>(speed_Value))->getValue();
-    string rpm = (dynamic_pointer_cast<ValString>(rpm_Value))->getValue();
-    string engLoad = (dynamic_pointer_cast<ValString>(engLoadValue))->getValue();
-    string coolTemp = (dynamic_pointer_cast<ValString>(coolTemp_Value))->getValue();
-    string airFlow = (dynamic_pointer_cast<ValString>(airFlow_Value))->getValue();
-    string inletPress = (dynamic_pointer_cast<ValString>(inletPress_Value))->getValue();
-    string inletTemp = (dynamic_pointer_cast<ValString>(inletTemp_Value))->getValue();
-    string fuelLvl = (dynamic_pointer_cast<ValString>(fuelLvl_Value))->getValue();
-    string fuelPress = (dynamic_pointer_cast<ValString>(fuelPress_Value))->getValue();
-    string engKM = (dynamic_pointer_cast<ValString>(engKM_Value))->getValue();
+    double posE = (dynamic_pointer_cast<ValDouble>(posE_Value))->getValue();
+    double posN = (dynamic_pointer_cast<ValDouble>(posN_Value))->getValue();
+    double posH = (dynamic_pointer_cast<ValDouble>(posH_Value))->getValue();
+    double accX = (dynamic_pointer_cast<ValDouble>(accX_Value))->getValue();
+    double accY = (dynamic_pointer_cast<ValDouble>(accY_Value))->getValue();
+    double accZ = (dynamic_pointer_cast<ValDouble>(accZ_Value))->getValue();
+    double gyroX = (dynamic_pointer_cast<ValDouble>(gyroX_Value))->getValue();
+    double gyroY = (dynamic_pointer_cast<ValDouble>(gyroY_Value))->getValue();
+    double gyroZ = (dynamic_pointer_cast<ValDouble>(gyroZ_Value))->getValue();
+
+    double speed = (dynamic_pointer_cast<ValDouble>(speed_Value))->getValue();
+    double rpm = (dynamic_pointer_cast<ValDouble>(rpm_Value))->getValue();
+    double engLoad = (dynamic_pointer_cast<ValDouble>(engLoadValue))->getValue();
+    double coolTemp = (dynamic_pointer_cast<ValDouble>(coolTemp_Value))->getValue();
+    double airFlow = (dynamic_pointer_cast<ValDouble>(airFlow_Value))->getValue();
+    double inletPress = (dynamic_pointer_cast<ValDouble>(inletPress_Value))->getValue();
+    double inletTemp = (dynamic_pointer_cast<ValDouble>(inletTemp_Value))->getValue();
+    double fuelLvl = (dynamic_pointer_cast<ValDouble>(fuelLvl_Value))->getValue();
+    double fuelPress = (dynamic_pointer_cast<ValDouble>(fuelPress_Value))->getValue();
+    double engKM = (dynamic_pointer_cast<ValDouble>(engKM_Value))->getValue();
 
     // If all values are set, begin building packet.
-    if (img) {
-
-        auto imgIt = img->begin();
-        uint8_t frameNumber=1;
-
-        // Due to restrictions in protocol, each submitted frame can have at most
-        // 65532 bytes of length. First step is to split the image data into parts
-        // of that length.
-        while (imgIt != img->end()) {
-
-            // Next data block.
-            shared_ptr<deque<shared_ptr<vector<uint8_t>>>> nextImgBlock(new deque<shared_ptr<vector<uint8_t>>>);
-            shared_ptr<vector<uint8_t>> content(new vector<uint8_t>);
-
-            // Get iterator for end of block.
-            auto blockEnd = imgIt;
-            if (img->end() - imgIt >= PAYLOAD_SIZE-6)
-                blockEnd = imgIt + PAYLOAD_SIZE-6;
-            else
-                blockEnd = img->end();
-
-            // Create data frame.
-            content->push_back(MSG_ID_IMAGE);
-            content->push_back(this->devID);
-            content->push_back(DATA_TYPE_IMG);
-            content->push_back(1 + img->size() / (PAYLOAD_SIZE-6));
-            content->push_back(frameNumber++);
-            content->insert(content->end(), imgIt, blockEnd);
-
-            nextImgBlock->push_back(content);
-
-            packets.push(nextImgBlock);
-
-            // Set next iterator position.
-            imgIt = blockEnd;
-        }
-
+    if (img)
+        insertFragments(packets, img, MSG_ID_IMAGE, DATA_TYPE_IMG);
+
+    // Video stream, only present if a stream encoder is set up and only sent if the server accepted it.
+    shared_ptr<Value> stream_Value;
+    if (this->streaming && data->getValue(ARG_STREAM, stream_Value) == OK && stream_Value) {
+        shared_ptr<vector<uint8_t>> stream = (dynamic_pointer_cast<ValVectorUChar>(stream_Value))->getValue();
+        if (stream && stream->size())
+            insertFragments(packets, stream, MSG_ID_IMAGE, DATA_TYPE_STREAM);
     }
 
-
     // Now the last frame gets built, containing the telemetry data.
-    shared_ptr<deque<shared_ptr<vector<uint8_t>>>> telemetryBlock(new deque<shared_ptr<vector<uint8_t>>>);
+    shared_ptr<deque<BufferSlice>> telemetryBlock(new deque<BufferSlice>);
     shared_ptr<vector<uint8_t>> telemetry(new vector<uint8_t>);
 
     telemetry->push_back(MSG_ID_TELEMETRY);
@@ -348,6 +588,124 @@ uint8_t ProcPayload::packAcquiredData(
     return NW_OK;
 }
 
+/** \brief Packs frames for motion sample batches.
+ *
+ *  Builds frames for the encoded sample batch in 'data' and writes them to 'packets'.
+ *  Batches are only known to servers speaking the binary protocol, for others they are dropped.
+ *
+ *  \param packets The data container to write the frames to.
+ *  \param data The sample batch message.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcPayload::packSamples(
+        queue< shared_ptr< deque<BufferSlice>>> &packets,
+        shared_ptr<M2C_Samples> data) {
+
+    shared_ptr<Value> samples_Value;
+    uint8_t status = data->getValue(ARG_SAMPLES, samples_Value);
+    if( status != OK )
+        return NW_ERR_ARGUMENT; // An argument error occurred.
+
+    shared_ptr<vector<uint8_t>> samples = (dynamic_pointer_cast<ValVectorUChar>(samples_Value))->getValue();
+
+    if (samples && this->protocol >= PROTOCOL_BINARY)
+        insertFragments(packets, samples, MSG_ID_SAMPLES, DATA_TYPE_SAMPLES);
+
+    return NW_OK;
+}
+
+/** \brief Packs frames for statistics.
+ *
+ *  Builds frames holding the statistics text of 'data' and writes them to 'packets'.
+ *  Returns status indicator.
+ *
+ *  \param packets The data container to write the frames to.
+ *  \param data The statistics to send.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcPayload::packStats(
+        queue< shared_ptr< deque<BufferSlice>>> &packets,
+        shared_ptr<M2C_Stats> data) {
+
+    shared_ptr<Value> stats_Value;
+    uint8_t status = data->getValue(ARG_STATS, stats_Value);
+    if( status != OK )
+        return NW_ERR_ARGUMENT; // An argument error occurred.
+
+    string text = (dynamic_pointer_cast<ValString>(stats_Value))->getValue();
+    shared_ptr<vector<uint8_t>> stats(new vector<uint8_t>(text.begin(), text.end()));
+
+    insertFragments(packets, stats, MSG_ID_STATS, DATA_TYPE_OTHER);
+
+    return NW_OK;
+}
+
+/** \brief Helper method to insert fragmented data.
+ *
+ *  Splits 'data' into frames of message type 'msgId' and data type 'dataType' and adds them to 'packets'.
+ *  The frames reference slices of 'data' instead of copying it, so it must not be modified afterwards.
+ *  Fragments for the media channel always fit the path MTU. They count fragments in 16 bit,
+ *  data needing more than MEDIA_FRAGMENTS_MAX of them are skipped and counted.
+ *
+ *  \param packets The data container to write the frames to.
+ *  \param data The data to split.
+ *  \param msgId The message identifier.
+ *  \param dataType The data type identifier.
+ */
+void ProcPayload::insertFragments(
+        queue< shared_ptr< deque<BufferSlice>>> &packets,
+        shared_ptr<vector<uint8_t>> &data,
+        uint8_t msgId,
+        uint8_t dataType) {
+
+    size_t offset=0;
+    uint16_t frameNumber=1;
+
+    // Due to restrictions in protocol, each submitted frame can have at most
+    // 65532 bytes of length. First step is to split the data into parts
+    // of that length, leaving room for a sequence header. Media sent as datagrams
+    // are split into parts fitting the path MTU instead.
+    bool media = this->media && msgId != MSG_ID_EVENT && (dataType == DATA_TYPE_IMG || dataType == DATA_TYPE_STREAM);
+    size_t fragment = media ? MEDIA_PAYLOAD_SIZE : PAYLOAD_SIZE-6-FRAGMENT_HEADROOM;
+    size_t fragmentCount = (data->size() + fragment-1) / fragment;
+
+    // Larger datagrams would be fragmented by IP, losing the whole one with any piece.
+    if (media && fragmentCount > MEDIA_FRAGMENTS_MAX) {
+        this->mediaOversize++;
+        return;
+    }
+
+    while (offset < data->size()) {
+
+        // Next data block.
+        shared_ptr<deque<BufferSlice>> nextBlock(new deque<BufferSlice>);
+        shared_ptr<vector<uint8_t>> header(new vector<uint8_t>);
+
+        // Get length of block.
+        size_t length = min(data->size() - offset, fragment);
+
+        // Create data frame, referencing the block.
+        header->push_back(msgId);
+        header->push_back(this->devID);
+        header->push_back(dataType);
+        if (media) {
+            header->push_back(fragmentCount >> 8);
+            header->push_back(fragmentCount);
+            header->push_back(frameNumber >> 8);
+        } else
+            header->push_back(fragmentCount);
+        header->push_back(frameNumber++);
+
+        nextBlock->push_back(header);
+        nextBlock->push_back(BufferSlice(data, offset, length));
+
+        packets.push(nextBlock);
+
+        // Set next block position.
+        offset += length;
+    }
+}
+
 /** \brief Helper method to insert telemetry data.
  *
  *  Writes data from 'data' with its length and the identifier 'identifier' to 'packet'.
@@ -366,6 +724,95 @@ void ProcPayload::insertTelemetry(
     packet->insert(packet->end(), data.begin(), data.end());
 }
 
+/** \brief Helper method to insert numeric telemetry data.
+ *
+ *  Writes the field 'data' with identifier 'identifier' to 'packet', encoded according to
+ *  the protocol version in use. ASCII fields keep the format of the sensor output, binary
+ *  fields are fixed width big endian integers without a length: coordinates are int32 in
+ *  1e-7 degrees, the height is int32 in centimeters, all other fields are int16.
+ *  Missing values (NAN) are sent as "--" in ASCII and omitted in binary.
+ *
+ *  \param packet The data container to write the frame to.
+ *  \param data The telemetry value.
+ *  \param identifier The data identifier.
+ */
+void ProcPayload::insertTelemetry(
+        shared_ptr<vector<uint8_t>> &packet,
+        double data,
+        uint8_t identifier) {
+
+    if (this->protocol == PROTOCOL_BINARY) {
+
+        if (std::isnan(data))
+            return;
+
+        packet->push_back(identifier);
+
+        switch (identifier) {
+        case FIELD_TYPE_POS_N:
+        case FIELD_TYPE_POS_E:
+            insertInteger(packet, llround(data * SCALE_DEGREES), 4);
+            break;
+        case FIELD_TYPE_POS_T:
+            insertInteger(packet, llround(data * SCALE_HEIGHT), 4);
+            break;
+        default:
+            insertInteger(packet, llround(data), 2);
+            break;
+        }
+
+        return;
+    }
+
+    char text[32] = "--";
+
+    if (!std::isnan(data)) {
+        switch (identifier) {
+        case FIELD_TYPE_POS_N:
+        case FIELD_TYPE_POS_E:
+        {
+            // Degrees and minutes, followed by the hemisphere.
+            double degrees = fabs(data);
+            int32_t whole = floor(degrees);
+            snprintf(text, sizeof(text), "%0*d%07.4f%c",
+                    identifier == FIELD_TYPE_POS_N ? 2 : 3, whole, (degrees - whole) * 60,
+                    identifier == FIELD_TYPE_POS_N ? (data < 0 ? 'S' : 'N') : (data < 0 ? 'W' : 'E'));
+            break;
+        }
+        case FIELD_TYPE_POS_T:
+            snprintf(text, sizeof(text), "%.1fM", data);
+            break;
+        default:
+            snprintf(text, sizeof(text), "%lld", llround(data));
+            break;
+        }
+    }
+
+    string field(text);
+    insertTelemetry(packet, field, identifier);
+}
+
+/** \brief Helper method to insert integers.
+ *
+ *  Writes the lowest 'width' bytes of 'data' to 'packet', most significant byte first.
+ *  Values exceeding the range of 'width' bytes are saturated.
+ *
+ *  \param packet The data container to write to.
+ *  \param data The integer.
+ *  \param width Number of bytes to write.
+ */
+void ProcPayload::insertInteger(
+        shared_ptr<vector<uint8_t>> &packet,
+        int64_t data,
+        uint8_t width) {
+
+    int64_t limit = ((int64_t)1 << (width*8 - 1)) - 1;
+    data = max(-limit-1, min(limit, data));
+
+    for (int8_t shift = (width-1)*8; shift >= 0; shift -= 8)
+        packet->push_back((uint8_t)(data >> shift));
+}
+
 /** \brief Packs event frame.
  *
  *  Builds frame for event signals, using data 'data' and writing it to 'packets.'
@@ -376,7 +823,7 @@ void ProcPayload::insertTelemetry(
  *  \return 0 in case of success, an error code otherwise.
  */
 uint8_t ProcPayload::packEvent(
-        queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> &packets,
+        queue< shared_ptr< deque<BufferSlice>>> &packets,
         shared_ptr<M2C_Event> data) {
 
     shared_ptr<Value> img_Value;
@@ -396,48 +843,12 @@ uint8_t ProcPayload::packEvent(
 
     // Get argument values.
     shared_ptr<vector<uint8_t>> img = (dynamic_pointer_cast<ValVectorUChar>(img_Value))->getValue();
-    string posE = (dynamic_pointer_cast<ValString>(posE_Value))->getValue();
-    string posN = (dynamic_pointer_cast<ValString>(posN_Value))->getValue();
+    double posE = (dynamic_pointer_cast<ValDouble>(posE_Value))->getValue();
+    double posN = (dynamic_pointer_cast<ValDouble>(posN_Value))->getValue();
 
     // If all values are set, begin building packet.
-    if (img) {
-
-        auto imgIt = img->begin();
-        uint8_t frameNumber=1;
-
-        // Due to restrictions in protocol, each submitted frame can have at most
-        // 65532 bytes of length. First step is to split the image data into parts
-        // of that length.
-        while (imgIt != img->end()) {
-
-            // Next data block.
-            shared_ptr<deque<shared_ptr<vector<uint8_t>>>> nextImgBlock(new deque<shared_ptr<vector<uint8_t>>>);
-            shared_ptr<vector<uint8_t>> content(new vector<uint8_t>);
-
-            // Get iterator for end of block.
-            auto blockEnd = imgIt;
-            if (img->end() - imgIt >= PAYLOAD_SIZE-6)
-                blockEnd = imgIt + PAYLOAD_SIZE-6;
-            else
-                blockEnd = img->end();
-
-            // Create data frame.
-            content->push_back(MSG_ID_EVENT);
-            content->push_back(this->devID);
-            content->push_back(DATA_TYPE_IMG);
-            content->push_back(1 + img->size() / (PAYLOAD_SIZE-6));
-            content->push_back(frameNumber++);
-            content->insert(content->end(), imgIt, blockEnd);
-
-            nextImgBlock->push_back(content);
-
-            packets.push(nextImgBlock);
-
-            // Set next iterator position.
-            imgIt = blockEnd;
-        }
-
-    }
+    if (img)
+        insertFragments(packets, img, MSG_ID_EVENT, DATA_TYPE_IMG);
 
     string time("0");
 
@@ -450,7 +861,7 @@ uint8_t ProcPayload::packEvent(
     uint8_t eventType = (dynamic_pointer_cast<ValInt>(evt_Value))->getValue();
 
     // Now the event frame gets built.
-    shared_ptr<deque<shared_ptr<vector<uint8_t>>>> eventBlock(new deque<shared_ptr<vector<uint8_t>>>);
+    shared_ptr<deque<BufferSlice>> eventBlock(new deque<BufferSlice>);
     shared_ptr<vector<uint8_t>> event(new vector<uint8_t>);
 
     event->push_back(MSG_ID_EVENT);
@@ -470,7 +881,10 @@ uint8_t ProcPayload::packEvent(
 
     insertTelemetry(event, posN, FIELD_TYPE_POS_N);
     insertTelemetry(event, posE, FIELD_TYPE_POS_E);
-    insertTelemetry(event, time, FIELD_TYPE_POS_T);
+
+    // The event time is not measured, only the ASCII protocol carries a placeholder.
+    if (this->protocol == PROTOCOL_ASCII)
+        insertTelemetry(event, time, FIELD_TYPE_POS_T);
 
     // Add packet to list.
     eventBlock->push_back(event);
@@ -482,6 +896,8 @@ uint8_t ProcPayload::packEvent(
 /** \brief Pulls input from chain of reception.
  *
  *  Receives data from successor and builds message for parent module.
+ *  Payloads are passed to the unpack methods from their message id on, as seen by all other
+ *  processors. Payloads too short for their message id are rejected.
  *  Returns status indicator.
  *
  *  \param output The message to convert and send.
@@ -489,8 +905,8 @@ uint8_t ProcPayload::packEvent(
  */
 uint8_t ProcPayload::pull(shared_ptr<Message_M2C> &input) {
 
-    // Create new receive buffer, reserving FRAME_SIZE bytes.
-    shared_ptr<vector<uint8_t>> packet(new vector<uint8_t>(FRAME_SIZE));
+    // Reuse receive buffer, only needed for payloads the successor can't return in place.
+    shared_ptr<vector<uint8_t>> packet=this->rcvBuffer;
     uint8_t *begin=&(*packet)[0], *end=begin;
 
     // Receive from successor.
@@ -498,7 +914,11 @@ uint8_t ProcPayload::pull(shared_ptr<Message_M2C> &input) {
     if( status != NW_OK )
         return status; // An error occurred.
 
-    uint8_t msgID = *begin++;
+    if (begin == end)
+        return NW_ERR_NOT_ENOUGH_CHARS;
+
+    uint8_t msgID = *begin;
+    this->messagesPulled++;
 
     // Switch incoming message type.
     switch (msgID) {
@@ -514,6 +934,27 @@ uint8_t ProcPayload::pull(shared_ptr<Message_M2C> &input) {
 
     } break;
 
+    case MSG_ID_REGISTER:
+    {
+        // Server answers registration with the protocol version to use, nothing to pass on.
+        status = unpackRegister(packet, begin, end);
+
+        if( status != NW_OK ) return status; // An error occurred.
+
+        // Tell the chain, whether uploads are acknowledged.
+        FrameProcessor::acknowledge(end - begin > 3 && (*(begin+3) & FEATURE_LOG_ACK), 0);
+
+    } break;
+
+    case MSG_ID_LOG_ACK:
+    {
+        // Acknowledged upload, handled by the chain, nothing to pass on.
+        status = unpackLogAck(packet, begin, end);
+
+        if( status != NW_OK ) return status; // An error occurred.
+
+    } break;
+
     case MSG_ID_COMMAND:
     {
         // Create and set up command message.
@@ -526,6 +967,18 @@ uint8_t ProcPayload::pull(shared_ptr<Message_M2C> &input) {
 
     } break;
 
+    case MSG_ID_SUBSCRIBE:
+    {
+        // Create stream subscription message.
+        shared_ptr<M2C_Subscribe> data;
+        status = unpackSubscribe(data, packet, begin, end);
+
+        input = dynamic_pointer_cast<Message_M2C>(data);
+
+        if( status != NW_OK ) return status; // An error occurred.
+
+    } break;
+
     default:
         break;
     }
@@ -540,7 +993,7 @@ uint8_t ProcPayload::pull(shared_ptr<Message_M2C> &input) {
  *
  *  \param data The target message
  *  \param packet The packet to unpack.
- *  \param begin Packet begin.
+ *  \param begin Packet begin, at the message id.
  *  \param end packet end.
  *  \return 0 in case of success, an error code otherwise.
  */
@@ -549,8 +1002,65 @@ uint8_t ProcPayload::unpackAcquiredData(shared_ptr<M2C_DataAcquired> &data,
         uint8_t *&begin,
         uint8_t *&end) {
 
+    if (end - begin < 3)
+        return NW_ERR_NOT_ENOUGH_CHARS;
+
     data = shared_ptr<M2C_DataAcquired>(new M2C_DataAcquired);
-    data->setValue(ARG_ACQUIRED_DATA, shared_ptr<ValInt>( new ValInt(*(begin+1))));
+    data->setValue(ARG_ACQUIRED_DATA, shared_ptr<ValInt>( new ValInt(*(begin+2))));
+
+    return NW_OK;
+}
+
+/** \brief Unpacks registration answer.
+ *
+ *  Unpacks the protocol version selected by the server and uses it from now on,
+ *  as far as it is supported. The answer holds message id, device id, protocol version and
+ *  the features accepted by the server, which are picked up by the processors implementing them.
+ *  Stream fragments are sent from now on, if the server accepted FEATURE_STREAM.
+ *  Returns status indicator.
+ *
+ *  \param packet The packet to unpack.
+ *  \param begin Packet begin, at the message id.
+ *  \param end packet end.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcPayload::unpackRegister(shared_ptr<vector<uint8_t>> &packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (end - begin < 3)
+        return NW_ERR_NOT_ENOUGH_CHARS;
+
+    uint8_t version = *(begin+2);
+    if (version >= PROTOCOL_ASCII)
+        this->protocol = min(version, (uint8_t)PROTOCOL_VERSION);
+
+    // Stream fragments are only sent, if offered and accepted.
+    this->streaming = (this->features & FEATURE_STREAM) && end - begin > 3 && (*(begin+3) & FEATURE_STREAM);
+
+    return NW_OK;
+}
+
+/** \brief Unpacks upload acknowledgement.
+ *
+ *  Unpacks the number of bytes the server received completely on this connection (32 bit, big endian)
+ *  and passes it to the processors keeping uploaded data until acknowledged.
+ *  Returns status indicator.
+ *
+ *  \param packet The packet to unpack.
+ *  \param begin Packet begin, at the message id.
+ *  \param end packet end.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcPayload::unpackLogAck(shared_ptr<vector<uint8_t>> &packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (end - begin < 5)
+        return NW_ERR_NOT_ENOUGH_CHARS;
+
+    uint32_t received = ((uint32_t)*(begin+1) << 24) | (*(begin+2) << 16) | (*(begin+3) << 8) | *(begin+4);
+    FrameProcessor::acknowledge(true, received);
 
     return NW_OK;
 }
@@ -562,7 +1072,7 @@ uint8_t ProcPayload::unpackAcquiredData(shared_ptr<M2C_DataAcquired> &data,
  *
  *  \param data The target message
  *  \param packet The packet to unpack.
- *  \param begin Packet begin.
+ *  \param begin Packet begin, at the message id.
  *  \param end packet end.
  *  \return 0 in case of success, an error code otherwise.
  */
@@ -571,8 +1081,37 @@ uint8_t ProcPayload::unpackCommand(shared_ptr<M2C_Command> &data,
         uint8_t *&begin,
         uint8_t *&end) {
 
+    if (end - begin < 3)
+        return NW_ERR_NOT_ENOUGH_CHARS;
+
     data = shared_ptr<M2C_Command>(new M2C_Command);
-    data->setValue(ARG_COMMAND_TYPE, shared_ptr<ValInt>( new ValInt(*(begin+1))));
+    data->setValue(ARG_COMMAND_TYPE, shared_ptr<ValInt>( new ValInt(*(begin+2))));
+
+    return NW_OK;
+}
+
+/** \brief Unpacks stream subscription frame.
+ *
+ *  Unpacks frame for stream subscription and writes the requested acquisition interval
+ *  in milliseconds (16 bit, big endian) to 'data'. An interval of 0 ends the subscription.
+ *  Returns status indicator.
+ *
+ *  \param data The target message
+ *  \param packet The packet to unpack.
+ *  \param begin Packet begin, at the message id.
+ *  \param end packet end.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcPayload::unpackSubscribe(shared_ptr<M2C_Subscribe> &data,
+        shared_ptr<vector<uint8_t>> &packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (end - begin < 4)
+        return NW_ERR_NOT_ENOUGH_CHARS;
+
+    data = shared_ptr<M2C_Subscribe>(new M2C_Subscribe);
+    data->setValue(ARG_INTERVAL, shared_ptr<ValInt>( new ValInt((*(begin+2) << 8) | *(begin+3))));
 
     return NW_OK;
 }
@@ -10,19 +10,25 @@
 
 #define ARG_DEV_ID  "Device"
 
-#define MAX_ATTEMPT_PROC_PL     100
-
 #define MSG_ID_REGISTER     0x01
 #define MSG_ID_ACQUIRE      0x02
 #define MSG_ID_IMAGE        0x03
 #define MSG_ID_TELEMETRY    MSG_ID_IMAGE
 #define MSG_ID_EVENT        0x04
 #define MSG_ID_COMMAND      0x05
+#define MSG_ID_SAMPLES      0x06
+#define MSG_ID_SEQUENCED    0x07
+#define MSG_ID_ACK          0x08
+#define MSG_ID_SUBSCRIBE    0x09
+#define MSG_ID_STATS        0x0A
+#define MSG_ID_LOG_ACK      0x0B
 
 #define DATA_TYPE_IMG        0x00
 #define DATA_TYPE_TELEMETRY  0x01
 #define DATA_TYPE_EVENT_DATA DATA_TYPE_TELEMETRY
 #define DATA_TYPE_OTHER      0x02
+#define DATA_TYPE_STREAM     0x03
+#define DATA_TYPE_SAMPLES    0x04
 
 #define FIELD_TYPE_POS_N    0x00
 #define FIELD_TYPE_POS_E    0x01
@@ -50,8 +56,34 @@
 
 #define COMMAND_ID_SWAP 0x01
 
+#define PROTOCOL_ASCII      0x01    // Telemetry fields as ASCII strings.
+#define PROTOCOL_BINARY     0x02    // Telemetry fields as fixed width binary numbers.
+#define PROTOCOL_VERSION    PROTOCOL_BINARY
+
+#define PRIORITY_CONTROL    0       // Registration.
+#define PRIORITY_EVENT      1       // Events, including their images.
+#define PRIORITY_TELEMETRY  2       // Telemetry and sample batches.
+#define PRIORITY_BULK       3       // Image and stream fragments, with the data set they belong to.
+#define PRIORITY_COUNT      4
+
+#define MEDIA_PAYLOAD_SIZE  1200    // Fragment bytes per datagram of the media channel.
+#define MEDIA_FRAGMENTS_MAX UINT16_MAX  // Fragments per image on the media channel, counted in 16 bit.
+#define FRAGMENT_HEADROOM   5       // Payload bytes left for headers of later processors, see ProcAck.
+
+#define FEATURE_COMPRESS    0x01    // Payloads may be deflate compressed, see ProcCompress.
+#define FEATURE_ACK         0x02    // Payloads are sequenced and acknowledged, see ProcAck.
+#define FEATURE_LOG_ACK     0x04    // Uploaded bytes of the segment log are acknowledged, see ProcSegmentLog.
+#define FEATURE_STREAM      0x08    // Video stream fragments are sent while subscribed, see OpEncodeStream.
+
+#define SCALE_DEGREES       10000000    // Binary coordinates in 1e-7 degrees.
+#define SCALE_HEIGHT        100         // Binary height in centimeters.
+
 #include "FrameProcessor.h"
+#include "NW_Shaper.h"
+#include "SharedPayload.h"
 
+#include <cmath>
+#include <cstdio>
 #include <queue>
 
 using namespace std;
@@ -59,36 +91,100 @@ using namespace std;
 class ProcPayload : public FrontProcessor {
 public:
 
-    ProcPayload(uint8_t devID);
+    ProcPayload(uint8_t devID, uint8_t protocol=PROTOCOL_ASCII, uint8_t features=0);
     virtual ~ProcPayload();
     virtual uint8_t push(shared_ptr<Message_M2C> output);
     virtual uint8_t pull(shared_ptr<Message_M2C> &input);
+    virtual uint8_t flush();
+    virtual uint8_t reconnect();
+    void setMediaChannel(shared_ptr<FrameProcessor> media);
+    void setShaper(shared_ptr<NW_Shaper> shaper);
+    virtual bool isCongested();
+    virtual int32_t getDelay();
+    virtual void collectStats(NW_Stats &stats);
 
 private:
 
     uint8_t devID;
+    uint8_t protocol;
+    uint8_t features;
+
+    // Whether the server accepted FEATURE_STREAM on this connection.
+    bool streaming;
     timeval step1, step2;
-    uint8_t packRegister(queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> &packets);
+    shared_ptr<vector<uint8_t>> rcvBuffer;
+
+    // Packets waiting for transmission, one queue per priority.
+    queue< shared_ptr< deque<BufferSlice>>> pending[PRIORITY_COUNT];
+
+    // Optional chain for image and stream fragments.
+    shared_ptr<FrameProcessor> media;
+
+    // Optional send rate limit.
+    shared_ptr<NW_Shaper> shaper;
+
+    // Statistics.
+    uint64_t messagesPushed, messagesPulled, messagesShared, mediaOversize;
+    uint64_t packetsSent[PRIORITY_COUNT];
+
+    static uint8_t getPriority(const shared_ptr<deque<BufferSlice>> &packet);
+    uint32_t getEncoding();
+    static uint8_t getShapeClass(uint8_t priority);
+    bool isAdmitted(uint8_t priority);
+    void charge(uint8_t priority, const shared_ptr<deque<BufferSlice>> &packet);
+    uint8_t packRegister(queue< shared_ptr< deque<BufferSlice>>> &packets);
     uint8_t packAcquiredData(
-            queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> &packets,
+            queue< shared_ptr< deque<BufferSlice>>> &packets,
             shared_ptr<M2C_DataSet> data);
     uint8_t packEvent(
-            queue< shared_ptr< deque< shared_ptr<vector<uint8_t>>>>> &packets,
+            queue< shared_ptr< deque<BufferSlice>>> &packets,
             shared_ptr<M2C_Event> data);
+    uint8_t packSamples(
+            queue< shared_ptr< deque<BufferSlice>>> &packets,
+            shared_ptr<M2C_Samples> data);
+    uint8_t packStats(
+            queue< shared_ptr< deque<BufferSlice>>> &packets,
+            shared_ptr<M2C_Stats> data);
+    void insertFragments(
+            queue< shared_ptr< deque<BufferSlice>>> &packets,
+            shared_ptr<vector<uint8_t>> &data,
+            uint8_t msgId,
+            uint8_t dataType);
     void insertTelemetry(
             shared_ptr<vector<uint8_t>> &packet,
             string &data,
             uint8_t identifier);
+    void insertTelemetry(
+            shared_ptr<vector<uint8_t>> &packet,
+            double data,
+            uint8_t identifier);
+    static void insertInteger(
+            shared_ptr<vector<uint8_t>> &packet,
+            int64_t data,
+            uint8_t width);
+
+    uint8_t unpackRegister(shared_ptr<vector<uint8_t>> &packet,
+            uint8_t *&begin,
+            uint8_t *&end);
 
     uint8_t unpackAcquiredData(shared_ptr<M2C_DataAcquired> &data,
             shared_ptr<vector<uint8_t>> &packet,
             uint8_t *&begin,
             uint8_t *&end);
 
+    uint8_t unpackLogAck(shared_ptr<vector<uint8_t>> &packet,
+            uint8_t *&begin,
+            uint8_t *&end);
+
     uint8_t unpackCommand(shared_ptr<M2C_Command> &data,
             shared_ptr<vector<uint8_t>> &packet,
             uint8_t *&begin,
             uint8_t *&end);
+
+    uint8_t unpackSubscribe(shared_ptr<M2C_Subscribe> &data,
+            shared_ptr<vector<uint8_t>> &packet,
+            uint8_t *&begin,
+            uint8_t *&end);
 };
 
 #endif /* PROCPAYLOAD_H_ */
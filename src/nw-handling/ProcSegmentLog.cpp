@@ -0,0 +1,799 @@
+/** \brief      Store-and-forward frame processor.
+ *
+ * \details     Appends all outgoing frames to an append-only log of memory-mapped segment files
+ *              on local storage, instead of sending them immediately. Whenever the log holds data,
+ *              the connection to the server is (re)established from time to time and the log is
+ *              uploaded in large batches directly from the segment files, or through the
+ *              successors if they encrypt in user space. The acknowledged upload position is kept
+ *              in a mapped cursor file, so uploads resume where they stopped, even after restarts.
+ *              Acknowledged segments are deleted, the oldest segments are dropped if the log
+ *              exceeds its size limit.
+ *              Registrations are not stored, each upload connection starts with the latest one,
+ *              so the server knows the device and its features before the first stored frame.
+ *              The upload starts once the server answered the registration. If it accepts
+ *              FEATURE_LOG_ACK, it acknowledges the bytes it received on the connection and
+ *              unacknowledged data are sent again on the next one, so data may arrive twice
+ *              but are not lost. Otherwise data accepted by the socket count as uploaded, and a
+ *              broken connection may lose the tail of a frame.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       ProcSegmentLog
+ */
+
+#include "ProcSegmentLog.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of ProcSegmentLog instances, storing segments in directory 'path'.
+ *
+ *  \param path Directory of the segment files.
+ */
+ProcSegmentLog::ProcSegmentLog(string path) {
+
+    this->path=path;
+
+    this->writeDesc=-1;
+    this->writeMap=NULL;
+    this->writeHeader=NULL;
+
+    this->readDesc=-1;
+    this->readSegment=0;
+    this->readEnd=0;
+
+    this->cursorDesc=-1;
+    this->cursor=NULL;
+
+    this->sent.segment=0;
+    this->sent.offset=0;
+
+    this->bytesStored=0;
+    this->bytesUploaded=0;
+    this->bytesAcknowledged=0;
+
+    // Try to connect on first flush.
+    this->uplink=false;
+    this->registered=false;
+    this->acknowledged=false;
+    this->linkBase=0;
+    this->linkSent=0;
+    this->linkAcked=0;
+    this->lastAttempt=chrono::steady_clock::now() - chrono::milliseconds(UPLOAD_RETRY);
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of ProcSegmentLog instances.
+ */
+ProcSegmentLog::~ProcSegmentLog() {
+
+    closeWriter();
+    closeReader();
+
+    if (this->cursor)
+        munmap(this->cursor, sizeof(logCursor));
+    if (this->cursorDesc != -1)
+        close(this->cursorDesc);
+}
+
+/** \brief Initializes the segment log.
+ *
+ *  Creates the log directory if needed, maps the cursor file and continues the segments found
+ *  in the directory. The connection itself is established on flush, as soon as data are stored.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::initialize() {
+
+    if (mkdir(this->path.c_str(), 0755) == -1 && errno != EEXIST)
+        return NW_ERR_STORAGE;
+
+    // Map upload cursor, a new cursor file is zero filled.
+    string cursorPath = this->path + "/" + CURSOR_FILE;
+    this->cursorDesc = open(cursorPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (this->cursorDesc == -1)
+        return NW_ERR_STORAGE;
+
+    struct stat info;
+    if (fstat(this->cursorDesc, &info) == -1)
+        return NW_ERR_STORAGE;
+    if (info.st_size < (off_t)sizeof(logCursor) && ftruncate(this->cursorDesc, sizeof(logCursor)) == -1)
+        return NW_ERR_STORAGE;
+
+    void *map = mmap(NULL, sizeof(logCursor), PROT_READ | PROT_WRITE, MAP_SHARED, this->cursorDesc, 0);
+    if (map == MAP_FAILED)
+        return NW_ERR_STORAGE;
+    this->cursor = (logCursor*)map;
+
+    // Collect existing segments, named by their hexadecimal sequence number.
+    DIR *dir = opendir(this->path.c_str());
+    if (!dir)
+        return NW_ERR_STORAGE;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+
+        string name = entry->d_name;
+        if (name.length() != SEGMENT_NAME_LENGTH + sizeof(SEGMENT_SUFFIX)-1 ||
+                name.compare(SEGMENT_NAME_LENGTH, string::npos, SEGMENT_SUFFIX))
+            continue;
+
+        char *parsed;
+        uint64_t segment = strtoull(name.substr(0, SEGMENT_NAME_LENGTH).c_str(), &parsed, 16);
+        if (*parsed == '\0')
+            this->segments.push_back(segment);
+    }
+    closedir(dir);
+
+    sort(this->segments.begin(), this->segments.end());
+
+    // Continue writing to the newest segment, start a new one if there is none or it is unusable.
+    uint8_t status = NW_ERR_STORAGE;
+    if (!this->segments.empty())
+        status = openWriter(this->segments.back(), false);
+
+    if (status) {
+        uint64_t next = this->segments.empty() ? this->cursor->segment : this->segments.back()+1;
+        if ((status = openWriter(next, true)))
+            return status;
+        this->segments.push_back(next);
+    }
+
+    // Uploads always continue at the oldest segment, others are uploaded completely.
+    if (this->cursor->segment != this->segments.front() ||
+            this->cursor->offset < sizeof(segmentHeader)) {
+        this->cursor->segment = this->segments.front();
+        this->cursor->offset = sizeof(segmentHeader);
+    }
+    this->sent = *this->cursor;
+
+    return NW_OK;
+}
+
+/** \brief Getter for descriptor.
+ *
+ *  Returns the descriptor of the upload connection.
+ *
+ *  \return The descriptor, -1 if not connected.
+ */
+int32_t ProcSegmentLog::getDescriptor() {
+
+    if (!this->uplink)
+        return -1;
+
+    return FrameProcessor::getDescriptor();
+}
+
+/** \brief Checks for congestion.
+ *
+ *  The log stores packets regardless of the upload, so packets never have to wait.
+ *
+ *  \return false.
+ */
+bool ProcSegmentLog::isCongested() {
+    return false;
+}
+
+/** \brief Gets time until held back data may be sent.
+ *
+ *  Returns when the shaper allows the upload to continue, if it waits for tokens.
+ *
+ *  \return Milliseconds until the next flush is due, -1 if nothing is held back by time.
+ */
+int32_t ProcSegmentLog::getDelay() {
+
+    if (this->shaper && this->uplink && !isUploaded()) {
+        int32_t due = this->shaper->getDelay(SHAPE_IMAGE);
+        if (due >= 0)
+            return due;
+    }
+
+    return FrameProcessor::getDelay();
+}
+
+/** \brief Setter for shaper.
+ *
+ *  Limits the upload rate to the image budget of 'shaper', as stored data are sent in bulk.
+ *
+ *  \param shaper The shaper, empty to not limit the upload rate.
+ */
+void ProcSegmentLog::setShaper(shared_ptr<NW_Shaper> shaper) {
+    this->shaper=shaper;
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds stored, uploaded and acknowledged bytes and the number of segments on disk. Uploads bypass
+ *  the socket interface, so its byte counters only hold data of other frames.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcSegmentLog::collectStats(NW_Stats &stats) {
+
+    stats.add("log.bytes_stored", this->bytesStored);
+    stats.add("log.bytes_uploaded", this->bytesUploaded);
+    stats.add("log.bytes_acknowledged", this->bytesAcknowledged);
+    stats.add("log.segments", this->segments.size());
+
+    if (this->shaper)
+        this->shaper->collectStats(stats);
+
+    FrameProcessor::collectStats(stats);
+}
+
+/** \brief Stores packet.
+ *
+ *  Appends the frame 'packet' to the segment written to, or to a new one if it does not fit.
+ *  The segment header is updated once the frame is in place, so only complete frames are uploaded.
+ *  Registration frames are kept for the next upload connection instead.
+ *
+ *  \param packet The packet to store.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::forward(shared_ptr<deque<BufferSlice>> packet) {
+
+    if (isRegistration(packet)) {
+        this->registration = packet;
+        return NW_OK;
+    }
+
+    size_t length=0;
+    for (auto packetIt = packet->begin(); packetIt != packet->end(); packetIt++)
+        length += packetIt->size();
+
+    if (length > SEGMENT_SIZE - sizeof(segmentHeader))
+        return NW_ERR_OUT_OF_BOUNDS;
+
+    // Start next segment if needed.
+    uint8_t status;
+    if (this->writeMap && this->writeHeader->end + length > SEGMENT_SIZE && (status = rotate()))
+        return status;
+
+    if (!this->writeMap)
+        return NW_ERR_STORAGE;
+
+    uint8_t *target = this->writeMap + this->writeHeader->end;
+    for (auto packetIt = packet->begin(); packetIt != packet->end(); packetIt++) {
+        memcpy(target, packetIt->begin(), packetIt->size());
+        target += packetIt->size();
+    }
+
+    // Commit frame.
+    this->writeHeader->end += length;
+    this->bytesStored += length;
+
+    return NW_OK;
+}
+
+/** \brief Backwards packet from upload connection.
+ *
+ *  Receives from the upload connection, if established. A broken connection is no error,
+ *  it is reestablished on a later flush.
+ *
+ *  \param packet The target container of receiving process.
+ *  \param begin The first position to write result to.
+ *  \param end The write limit, the end of the received data afterwards.
+ *  \return 0 in case of success, NW_ERR_WOULD_BLOCK if no data are available, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::backward(shared_ptr<vector<uint8_t>> packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (!this->uplink)
+        return NW_ERR_WOULD_BLOCK;
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    uint8_t status = this->getSuccessor()->receive(packet, begin, end);
+    if (status && status != NW_ERR_WOULD_BLOCK) {
+        disconnect();
+        return NW_ERR_WOULD_BLOCK;
+    }
+
+    return status;
+}
+
+/** \brief Uploads stored data.
+ *
+ *  Uploads the log, as long as the connection accepts data. Connects first, if the log holds
+ *  data and the last attempt is long enough ago, and registers on the new connection.
+ *  Stored data are no pending data of the chain, so a missing connection is no error.
+ *
+ *  \return 0 if nothing is to be sent now, NW_ERR_WOULD_BLOCK if the connection is busy, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::flush() {
+
+    if (!this->writeMap || !this->cursor)
+        return NW_ERR_STORAGE;
+
+    if (!this->uplink) {
+
+        // Log uploaded completely.
+        if (isUploaded() || !this->registration)
+            return NW_OK;
+
+        auto now = chrono::steady_clock::now();
+        if (chrono::duration_cast<chrono::milliseconds>(now - this->lastAttempt).count() < UPLOAD_RETRY)
+            return NW_OK;
+
+        this->lastAttempt = now;
+
+        // Unacknowledged data are sent again from the cursor, not replayed by the connection.
+        FrameProcessor::setReplay(false);
+        if (this->reconnect())
+            return NW_OK;
+
+        this->uplink = true;
+        this->registered = false;
+        this->acknowledged = false;
+        this->sent = *this->cursor;
+        this->linkSent = 0;
+        this->linkAcked = 0;
+
+        this->linkBase = 0;
+        for (auto packetIt = this->registration->begin(); packetIt != this->registration->end(); packetIt++)
+            this->linkBase += packetIt->size();
+
+        if (sendRegistration()) {
+            disconnect();
+            return NW_OK;
+        }
+    }
+
+    // Complete connection setup, then upload.
+    uint8_t status = FrameProcessor::flush();
+    if (status == NW_OK)
+        status = upload();
+
+    if (status == NW_ERR_WOULD_BLOCK)
+        return status;
+
+    if (status)
+        disconnect();
+
+    return NW_OK;
+}
+
+/** \brief Acknowledges uploaded data.
+ *
+ *  The registration answer tells whether the server acknowledges uploads and starts the upload.
+ *  Later acknowledgements move the cursor to the stored bytes received by the server, which
+ *  counts the registration as well. Acknowledgements beyond the data sent are ignored.
+ *
+ *  \param supported Whether the server acknowledges received bytes.
+ *  \param received The bytes received by the server on this connection, counted modulo 2^32.
+ */
+void ProcSegmentLog::acknowledge(bool supported, uint32_t received) {
+
+    if (!this->uplink)
+        return;
+
+    if (!this->registered) {
+        this->registered = true;
+        this->acknowledged = supported;
+        return;
+    }
+
+    if (!this->acknowledged)
+        return;
+
+    uint64_t length = (uint32_t)(received - this->linkBase - (uint32_t)this->linkAcked);
+    if (length > this->linkSent - this->linkAcked)
+        return;
+
+    this->bytesAcknowledged += length;
+    commit(length);
+}
+
+/** \brief Uploads segments.
+ *
+ *  Sends stored data from the sent position on, straight from the segment files to the socket.
+ *  If the successors alter the byte stream, the data are read and transmitted through them instead.
+ *  Waits for the registration answer first. Data count as uploaded once acknowledged, or right away
+ *  if the server does not acknowledge. If a shaper is set, the upload pauses while it is over budget.
+ *
+ *  \return 0 if everything is uploaded or the upload pauses, NW_ERR_WOULD_BLOCK if the socket is full, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::upload() {
+
+    int32_t socketDesc = FrameProcessor::getDescriptor();
+    if (socketDesc == -1)
+        return NW_ERR_SOCKET;
+
+    if (!this->registered)
+        return NW_OK;
+
+    // Encrypting successors need the data in user space.
+    bool raw = FrameProcessor::acceptsRaw();
+
+    while (true) {
+
+        int32_t sourceDesc = this->writeDesc;
+        uint64_t end = this->writeHeader->end;
+
+        // Sealed segment, continue with the next one once sent.
+        if (this->sent.segment != this->segments.back()) {
+
+            if (this->readDesc == -1 || this->readSegment != this->sent.segment)
+                openReader(this->sent.segment);
+
+            sourceDesc = this->readDesc;
+            end = this->readDesc == -1 ? 0 : this->readEnd;
+
+            if (this->sent.offset >= end) {
+                closeReader();
+
+                // Nothing left to acknowledge, e.g. of an unreadable segment.
+                if (this->linkSent == this->linkAcked)
+                    commit(0);
+
+                this->sent.segment = *upper_bound(this->segments.begin(), this->segments.end(), this->sent.segment);
+                this->sent.offset = sizeof(segmentHeader);
+                continue;
+            }
+        }
+
+        if (this->sent.offset >= end)
+            return NW_OK;
+
+        // Continue once the shaper has tokens again.
+        size_t allowance = this->shaper ? this->shaper->getAllowance(SHAPE_IMAGE) : SIZE_MAX;
+        if (!allowance)
+            return NW_OK;
+
+        size_t length = min(min(end - this->sent.offset, (uint64_t)UPLOAD_BATCH), (uint64_t)allowance);
+        ssize_t count;
+
+        if (raw) {
+            off_t offset = this->sent.offset;
+            count = sendfile(socketDesc, sourceDesc, &offset, length);
+
+            // Socket buffer is full, continue when writable again.
+            if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return NW_ERR_WOULD_BLOCK;
+
+        } else {
+
+            // Wait for the socket or, e.g. during a handshake, for the server.
+            if (FrameProcessor::isCongested())
+                return FrameProcessor::flush();
+
+            count = relay(sourceDesc, this->sent.offset, min(length, (size_t)RELAY_BATCH));
+        }
+
+        if (count < 1)
+            return NW_ERR_SEND;
+
+        this->sent.offset += count;
+        this->linkSent += count;
+        this->bytesUploaded += count;
+
+        if (!this->acknowledged)
+            commit(count);
+
+        if (this->shaper)
+            this->shaper->charge(SHAPE_IMAGE, count);
+    }
+}
+
+/** \brief Moves the cursor.
+ *
+ *  Moves the cursor by 'length' uploaded bytes and deletes the sealed segments it leaves.
+ *
+ *  \param length The number of bytes uploaded.
+ */
+void ProcSegmentLog::commit(uint64_t length) {
+
+    this->linkAcked += length;
+
+    while (this->cursor->segment != this->segments.back()) {
+
+        uint64_t end = getEnd(this->cursor->segment);
+        if (this->cursor->offset + length < end)
+            break;
+
+        length -= min(length, end - min(end, this->cursor->offset));
+
+        if (this->readDesc != -1 && this->readSegment == this->cursor->segment)
+            closeReader();
+
+        unlink(segmentPath(this->cursor->segment).c_str());
+        this->segments.pop_front();
+
+        this->cursor->segment = this->segments.front();
+        this->cursor->offset = sizeof(segmentHeader);
+    }
+
+    this->cursor->offset += length;
+}
+
+/** \brief Transmits stored data through the chain.
+ *
+ *  Reads 'length' bytes at 'offset' of the segment file 'sourceDesc' and transmits them to the successor.
+ *
+ *  \param sourceDesc The segment file.
+ *  \param offset The position to read from.
+ *  \param length The number of bytes to read.
+ *  \return The number of bytes transmitted, -1 in case of an error.
+ */
+ssize_t ProcSegmentLog::relay(int32_t sourceDesc, uint64_t offset, size_t length) {
+
+    shared_ptr<vector<uint8_t>> data(new vector<uint8_t>(length));
+
+    ssize_t count = pread(sourceDesc, &(*data)[0], length, offset);
+    if (count < 1)
+        return -1;
+
+    shared_ptr<deque<BufferSlice>> packet(new deque<BufferSlice>);
+    packet->push_back(BufferSlice(data, 0, count));
+
+    uint8_t status = this->getSuccessor()->transmit(packet);
+    if (status && status != NW_ERR_WOULD_BLOCK)
+        return -1;
+
+    return count;
+}
+
+/** \brief Registers on the upload connection.
+ *
+ *  Transmits a copy of the latest registration frame through the successors, ahead of all stored data.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::sendRegistration() {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    shared_ptr<deque<BufferSlice>> packet(new deque<BufferSlice>(*this->registration));
+
+    uint8_t status = this->getSuccessor()->transmit(packet);
+    if (status == NW_ERR_WOULD_BLOCK)
+        return NW_OK;
+
+    return status;
+}
+
+/** \brief Checks for registration frame.
+ *
+ *  \param packet The frame, as built by ProcDataFrame.
+ *  \return true if the frame holds a registration, false otherwise.
+ */
+bool ProcSegmentLog::isRegistration(const shared_ptr<deque<BufferSlice>> &packet) {
+
+    // Find the message id behind the frame header.
+    size_t position = FRAME_HEADER_SIZE;
+    for (auto packetIt = packet->begin(); packetIt != packet->end(); packetIt++) {
+
+        if (position < packetIt->size())
+            return *(packetIt->begin() + position) == MSG_ID_REGISTER;
+
+        position -= packetIt->size();
+    }
+
+    return false;
+}
+
+/** \brief Marks the upload connection as broken.
+ *
+ *  Stops using the connection, it is reestablished after UPLOAD_RETRY milliseconds.
+ */
+void ProcSegmentLog::disconnect() {
+    this->uplink=false;
+    this->lastAttempt=chrono::steady_clock::now();
+}
+
+/** \brief Path of segment file.
+ *
+ *  Returns the file path of segment 'segment'.
+ *
+ *  \param segment Sequence number of the segment.
+ *  \return The file path.
+ */
+string ProcSegmentLog::segmentPath(uint64_t segment) {
+
+    char name[SEGMENT_NAME_LENGTH+1];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)segment);
+
+    return this->path + "/" + name + SEGMENT_SUFFIX;
+}
+
+/** \brief Maps segment for writing.
+ *
+ *  Maps segment 'segment' for writing. A new segment has its space allocated completely,
+ *  so running out of storage is detected here and not when writing to the mapping.
+ *
+ *  \param segment Sequence number of the segment.
+ *  \param create Whether to create a new segment or to continue an existing one.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::openWriter(uint64_t segment, bool create) {
+
+    closeWriter();
+
+    string file = segmentPath(segment);
+    this->writeDesc = open(file.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (this->writeDesc == -1)
+        return NW_ERR_STORAGE;
+
+    struct stat info;
+    if ((create && posix_fallocate(this->writeDesc, 0, SEGMENT_SIZE)) ||
+            fstat(this->writeDesc, &info) == -1 || info.st_size < SEGMENT_SIZE) {
+        closeWriter();
+        if (create)
+            unlink(file.c_str());
+        return NW_ERR_STORAGE;
+    }
+
+    void *map = mmap(NULL, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, this->writeDesc, 0);
+    if (map == MAP_FAILED) {
+        closeWriter();
+        return NW_ERR_STORAGE;
+    }
+
+    this->writeMap = (uint8_t*)map;
+    this->writeHeader = (segmentHeader*)map;
+
+    if (create) {
+        this->writeHeader->magic = SEGMENT_MAGIC;
+        this->writeHeader->reserved = 0;
+        this->writeHeader->end = sizeof(segmentHeader);
+    }
+
+    // Reject foreign or damaged segments.
+    if (this->writeHeader->magic != SEGMENT_MAGIC ||
+            this->writeHeader->end < sizeof(segmentHeader) ||
+            this->writeHeader->end > SEGMENT_SIZE) {
+        closeWriter();
+        return NW_ERR_STORAGE;
+    }
+
+    return NW_OK;
+}
+
+/** \brief Unmaps segment written to.
+ *
+ *  Flushes and unmaps the segment written to.
+ */
+void ProcSegmentLog::closeWriter() {
+
+    if (this->writeMap) {
+        msync(this->writeMap, SEGMENT_SIZE, MS_ASYNC);
+        munmap(this->writeMap, SEGMENT_SIZE);
+    }
+    if (this->writeDesc != -1)
+        close(this->writeDesc);
+
+    this->writeDesc=-1;
+    this->writeMap=NULL;
+    this->writeHeader=NULL;
+}
+
+/** \brief Opens sealed segment for uploading.
+ *
+ *  Opens segment 'segment' for reading and gets the end of its data.
+ *
+ *  \param segment Sequence number of the segment.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::openReader(uint64_t segment) {
+
+    closeReader();
+
+    this->readDesc = open(segmentPath(segment).c_str(), O_RDONLY | O_CLOEXEC);
+    if (this->readDesc == -1)
+        return NW_ERR_STORAGE;
+
+    segmentHeader header;
+    if (pread(this->readDesc, &header, sizeof(header), 0) != sizeof(header) ||
+            header.magic != SEGMENT_MAGIC) {
+        closeReader();
+        return NW_ERR_STORAGE;
+    }
+
+    this->readSegment = segment;
+    this->readEnd = min(header.end, (uint64_t)SEGMENT_SIZE);
+
+    return NW_OK;
+}
+
+/** \brief Gets end of segment.
+ *
+ *  Returns the offset behind the last stored byte of segment 'segment'.
+ *
+ *  \param segment Sequence number of the segment.
+ *  \return The end of the data, 0 if the segment is unreadable.
+ */
+uint64_t ProcSegmentLog::getEnd(uint64_t segment) {
+
+    if (segment == this->segments.back())
+        return this->writeHeader->end;
+
+    if (this->readDesc != -1 && this->readSegment == segment)
+        return this->readEnd;
+
+    int32_t desc = open(segmentPath(segment).c_str(), O_RDONLY | O_CLOEXEC);
+    if (desc == -1)
+        return 0;
+
+    segmentHeader header;
+    uint64_t end = 0;
+    if (pread(desc, &header, sizeof(header), 0) == sizeof(header) && header.magic == SEGMENT_MAGIC)
+        end = min(header.end, (uint64_t)SEGMENT_SIZE);
+
+    close(desc);
+    return end;
+}
+
+/** \brief Closes segment read from.
+ *
+ *  Closes the sealed segment read from while uploading.
+ */
+void ProcSegmentLog::closeReader() {
+
+    if (this->readDesc != -1)
+        close(this->readDesc);
+
+    this->readDesc=-1;
+}
+
+/** \brief Starts next segment.
+ *
+ *  Seals the segment written to and continues with a new one. Drops the oldest segments
+ *  if the log exceeds SEGMENT_MAX_COUNT segments or storage runs out.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcSegmentLog::rotate() {
+
+    uint64_t next = this->segments.back()+1;
+
+    uint8_t status;
+    while ((status = openWriter(next, true)) && this->segments.size() > 1)
+        dropOldest();
+
+    if (status)
+        return status;
+
+    this->segments.push_back(next);
+    while (this->segments.size() > SEGMENT_MAX_COUNT)
+        dropOldest();
+
+    return NW_OK;
+}
+
+/** \brief Drops oldest segment.
+ *
+ *  Deletes the oldest segment, even if it is not uploaded yet. Dropping data not acknowledged yet
+ *  ends the upload connection, as later acknowledgements no longer match the log.
+ */
+void ProcSegmentLog::dropOldest() {
+
+    uint64_t oldest = this->segments.front();
+
+    if (this->readDesc != -1 && this->readSegment == oldest)
+        closeReader();
+
+    unlink(segmentPath(oldest).c_str());
+    this->segments.pop_front();
+
+    if (this->cursor->segment <= oldest) {
+        this->cursor->segment = this->segments.front();
+        this->cursor->offset = sizeof(segmentHeader);
+
+        if (this->uplink)
+            disconnect();
+    }
+
+    if (this->sent.segment <= oldest)
+        this->sent = *this->cursor;
+}
+
+/** \brief Checks whether the log is uploaded.
+ *
+ *  \return true if the acknowledged upload reached the end of the segment written to, false otherwise.
+ */
+bool ProcSegmentLog::isUploaded() {
+    return this->cursor->segment == this->segments.back() &&
+            this->cursor->offset >= this->writeHeader->end;
+}
@@ -0,0 +1,130 @@
+/*
+ * ProcSegmentLog.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef PROCSEGMENTLOG_H_
+#define PROCSEGMENTLOG_H_
+
+#define SEGMENT_SIZE        (16*1024*1024)  // Bytes per segment file, header included.
+#define SEGMENT_MAX_COUNT   64              // Oldest segments are dropped beyond.
+#define SEGMENT_MAGIC       0x4C53424FU     // "OBSL"
+#define SEGMENT_SUFFIX      ".seg"
+#define SEGMENT_NAME_LENGTH 16              // Hexadecimal digits of segment file names.
+#define CURSOR_FILE         "cursor"
+#define FRAME_HEADER_SIZE   5               // Frame begin and payload length, see ProcDataFrame.
+
+#define UPLOAD_BATCH        (1024*1024)     // Bytes per sendfile call.
+#define RELAY_BATCH         16384           // Bytes per packet, if uploaded through the chain.
+#define UPLOAD_RETRY        30000           // Milliseconds.
+
+#include "FrameProcessor.h"
+#include "NW_Shaper.h"
+#include "ProcPayload.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Header at the beginning of each segment file. */
+typedef struct segmentHeader {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t end;       // Offset behind the last stored byte.
+}segmentHeader;
+
+/** Upload position. The acknowledged one is persisted in the cursor file. */
+typedef struct logCursor {
+    uint64_t segment;
+    uint64_t offset;
+}logCursor;
+
+class ProcSegmentLog : public FrameProcessor {
+public:
+    ProcSegmentLog(string path);
+    virtual ~ProcSegmentLog();
+    uint8_t initialize();
+    virtual int32_t getDescriptor();
+    virtual uint8_t flush();
+    virtual bool isCongested();
+    virtual int32_t getDelay();
+    virtual void collectStats(NW_Stats &stats);
+    virtual void acknowledge(bool supported, uint32_t received);
+    void setShaper(shared_ptr<NW_Shaper> shaper);
+
+protected:
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
+    virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
+            uint8_t *&begin,
+            uint8_t *&end);
+
+private:
+    string path;
+
+    // Sequence numbers of the segments on disk, oldest first. The last one is written to.
+    deque<uint64_t> segments;
+
+    // Statistics.
+    uint64_t bytesStored, bytesUploaded, bytesAcknowledged;
+
+    // Mapped segment written to.
+    int32_t writeDesc;
+    uint8_t *writeMap;
+    segmentHeader *writeHeader;
+
+    // Sealed segment read from while uploading.
+    int32_t readDesc;
+    uint64_t readSegment, readEnd;
+
+    // Mapped upload position, acknowledged by the server.
+    int32_t cursorDesc;
+    logCursor *cursor;
+
+    // Upload position of the current connection, ahead of the cursor by the bytes not acknowledged yet.
+    logCursor sent;
+
+    // Latest registration frame, sent ahead of the log on each upload connection.
+    shared_ptr<deque<BufferSlice>> registration;
+
+    // Upload connection state. The upload starts once the registration is answered.
+    bool uplink, registered, acknowledged;
+
+    // Bytes of the registration, sent and acknowledged stored bytes on the current connection.
+    uint32_t linkBase;
+    uint64_t linkSent, linkAcked;
+    chrono::steady_clock::time_point lastAttempt;
+
+    // Optional upload rate limit.
+    shared_ptr<NW_Shaper> shaper;
+
+    string segmentPath(uint64_t segment);
+    uint8_t openWriter(uint64_t segment, bool create);
+    void closeWriter();
+    uint8_t openReader(uint64_t segment);
+    uint64_t getEnd(uint64_t segment);
+    void closeReader();
+    uint8_t rotate();
+    void dropOldest();
+    bool isUploaded();
+    uint8_t upload();
+    void commit(uint64_t length);
+    ssize_t relay(int32_t sourceDesc, uint64_t offset, size_t length);
+    uint8_t sendRegistration();
+    static bool isRegistration(const shared_ptr<deque<BufferSlice>> &packet);
+    void disconnect();
+};
+
+#endif /* PROCSEGMENTLOG_H_ */
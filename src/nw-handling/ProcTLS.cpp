@@ -0,0 +1,616 @@
+/** \brief      TLS frame processor.
+ *
+ * \details     Encrypts the byte stream between the frame processors and the connection.
+ *              OpenSSL works on memory BIOs, so ciphertext passes the successor like any other
+ *              packet and the socket keeps batching and flow control. Packets transmitted during
+ *              the handshake are held back and the chain counts as congested meanwhile.
+ *              Each connection offers the latest session of its NW_TLSContext, so reconnects
+ *              resume the session instead of doing a full handshake.
+ *              If the context offloads, the encryption of TLS 1.3 connections with AES-GCM is
+ *              handed to the kernel (kTLS) once the handshake records left the socket. Packets
+ *              then pass unencrypted and raw writes like sendfile work again. Without kernel
+ *              support the connection stays encrypted in user space. Received data are always
+ *              decrypted in user space.
+ *              Once offloaded, OpenSSL must not write records anymore, the kernel owns the record
+ *              sequence and the send key. Replies to post-handshake messages, in particular the
+ *              key update a server may request, are discarded and counted, so the connection
+ *              keeps sending with its initial key. The context then stops offloading, so the
+ *              next connection can follow the key updates in user space.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       ProcTLS
+ */
+
+#include "ProcTLS.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of ProcTLS instances, connecting to 'host' with the settings of 'context'.
+ *
+ *  \param context The TLS context, shared by all connections to the server.
+ *  \param host The server name or address, checked against its certificate.
+ */
+ProcTLS::ProcTLS(shared_ptr<NW_TLSContext> context, string host) {
+    this->context=context;
+    this->host=host;
+    this->ssl=0;
+    this->input=0;
+    this->output=0;
+    this->state=TLS_CLOSED;
+    this->offloaded=false;
+    this->ciphertext=shared_ptr<vector<uint8_t>>(new vector<uint8_t>(TLS_RECV_SIZE));
+    this->handshakes=0;
+    this->resumed=0;
+    this->offloads=0;
+    this->keyUpdatesRefused=0;
+    this->bytesEncrypted=0;
+    this->bytesDecrypted=0;
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of ProcTLS instances, freeing the connection.
+ */
+ProcTLS::~ProcTLS() {
+    close();
+}
+
+/** \brief Initializes the processor.
+ *
+ *  Sets up the first connection, its handshake starts with the next flush.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::initialize() {
+
+    if (!this->context)
+        return NW_ERR_ARGUMENT;
+
+    return open();
+}
+
+/** \brief Continues handshake and sends pending data.
+ *
+ *  Drives the handshake and flushes the successor. Once the handshake records are sent,
+ *  offloads the encryption, if possible, and releases the held back packets.
+ *  While waiting for the server, only the state of the successor counts.
+ *
+ *  \return 0 if nothing is pending anymore, NW_ERR_WOULD_BLOCK if data are still pending, an error code otherwise.
+ */
+uint8_t ProcTLS::flush() {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    uint8_t status = handshake();
+    if (status)
+        return status;
+
+    status = FrameProcessor::flush();
+
+    // Handshake records are sent, the kernel may take over with the first application record.
+    if (status == NW_OK && this->state == TLS_OFFLOADING) {
+
+        if (offload()) {
+            this->offloaded=true;
+            this->offloads++;
+        }
+
+        this->state = TLS_ESTABLISHED;
+
+        status = release();
+        if (status == NW_OK)
+            status = FrameProcessor::flush();
+    }
+
+    return status;
+}
+
+/** \brief Reestablishes connection.
+ *
+ *  Reconnects the successor and starts a new connection, resuming the latest session.
+ *  Held back packets are dropped, like the pending data of the socket, which must not replay
+ *  records of the old session.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::reconnect() {
+
+    FrameProcessor::setReplay(false);
+    uint8_t status = FrameProcessor::reconnect();
+    uint8_t opened = open();
+
+    return status ? status : opened;
+}
+
+/** \brief Checks for congestion.
+ *
+ *  Returns whether the handshake is not done yet or the successor is congested.
+ *
+ *  \return true if packets would have to wait, false otherwise.
+ */
+bool ProcTLS::isCongested() {
+    return this->state != TLS_ESTABLISHED || FrameProcessor::isCongested();
+}
+
+/** \brief Checks for raw writes.
+ *
+ *  Data written to the socket directly are only encrypted if the kernel took over.
+ *
+ *  \return true if the encryption is offloaded and the successor accepts raw writes, false otherwise.
+ */
+bool ProcTLS::acceptsRaw() {
+    return this->state == TLS_ESTABLISHED && this->offloaded && FrameProcessor::acceptsRaw();
+}
+
+/** \brief Sets replay of unsent packets.
+ *
+ *  Records of a session can't be replayed on the next one, so replay stays disabled.
+ *
+ *  \param replay Ignored.
+ */
+void ProcTLS::setReplay(bool replay) {
+    FrameProcessor::setReplay(false);
+}
+
+/** \brief Collects statistics.
+ *
+ *  Adds the number of full and resumed handshakes, of offloaded connections,
+ *  of refused key updates and the encrypted and decrypted bytes.
+ *
+ *  \param stats The statistics to add to.
+ */
+void ProcTLS::collectStats(NW_Stats &stats) {
+
+    stats.add("tls.handshakes", this->handshakes);
+    stats.add("tls.resumed", this->resumed);
+    stats.add("tls.offloads", this->offloads);
+    stats.add("tls.key_updates_refused", this->keyUpdatesRefused);
+    stats.add("tls.bytes_encrypted", this->bytesEncrypted);
+    stats.add("tls.bytes_decrypted", this->bytesDecrypted);
+
+    FrameProcessor::collectStats(stats);
+}
+
+/** \brief Forwards packet to successor.
+ *
+ *  Encrypts 'packet' and sends the records. Passes it unchanged if the kernel encrypts,
+ *  holds it back during the handshake.
+ *
+ *  \param packet The packet to send.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::forward(shared_ptr<deque<BufferSlice>> packet) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    if (this->state == TLS_CLOSED)
+        return NW_ERR_TLS;
+
+    if (this->state != TLS_ESTABLISHED) {
+        this->held.push_back(packet);
+        return NW_OK;
+    }
+
+    if (this->offloaded) {
+        for (auto &slice : *packet)
+            this->bytesEncrypted += slice.size();
+
+        return this->getSuccessor()->transmit(packet);
+    }
+
+    return encrypt(packet);
+}
+
+/** \brief Backwards packet from successor.
+ *
+ *  Decrypts received records into [begin, end). Receives ciphertext from the successor
+ *  until a record is complete, continuing the handshake on the way.
+ *
+ *  \param packet The target container of receiving process.
+ *  \param begin The first position to write result to.
+ *  \param end The write limit, the end of the received data afterwards.
+ *  \return 0 in case of success, NW_ERR_WOULD_BLOCK if no data are available, an error code otherwise.
+ */
+uint8_t ProcTLS::backward(shared_ptr<vector<uint8_t>> packet,
+        uint8_t *&begin,
+        uint8_t *&end) {
+
+    if (!this->getSuccessor())
+        return NW_ERR_NO_SUCCESSOR;
+
+    if (this->state == TLS_CLOSED)
+        return NW_ERR_TLS;
+
+    while (true) {
+
+        uint8_t status = handshake();
+        if (status)
+            return status;
+
+        if (this->state != TLS_HANDSHAKE) {
+
+            ERR_clear_error();
+            int result = SSL_read(this->ssl, begin, end - begin);
+            int error = result > 0 ? SSL_ERROR_NONE : SSL_get_error(this->ssl, result);
+
+            // Post-handshake messages may have to be answered, unless the kernel took over.
+            if (this->offloaded)
+                refuse(error);
+            else if ((status = drain()))
+                return status;
+
+            if (result > 0) {
+                end = begin + result;
+                this->bytesDecrypted += result;
+                return NW_OK;
+            }
+
+            if (error == SSL_ERROR_ZERO_RETURN)
+                return NW_ERR_RECV;
+
+            if (error != SSL_ERROR_WANT_READ)
+                return NW_ERR_TLS;
+        }
+
+        // Record incomplete, receive more ciphertext.
+        uint8_t *first = &(*this->ciphertext)[0];
+        uint8_t *last = first + this->ciphertext->size();
+
+        status = this->getSuccessor()->receive(this->ciphertext, first, last);
+        if (status)
+            return status;
+
+        BIO_write(this->input, first, last - first);
+    }
+}
+
+/** \brief Starts connection.
+ *
+ *  Replaces the current connection by a new one, offering the latest session and checking
+ *  the server certificate against the host name or address.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::open() {
+
+    close();
+
+    this->ssl = this->context->createSession();
+    if (!this->ssl)
+        return NW_ERR_TLS;
+
+    this->input = BIO_new(BIO_s_mem());
+    this->output = BIO_new(BIO_s_mem());
+    if (!this->input || !this->output) {
+        BIO_free(this->input);
+        BIO_free(this->output);
+        this->input=0;
+        this->output=0;
+        close();
+        return NW_ERR_TLS;
+    }
+
+    // Missing input means data did not arrive yet, not the end of the connection.
+    BIO_set_mem_eof_return(this->input, -1);
+    SSL_set_bio(this->ssl, this->input, this->output);
+    SSL_set_connect_state(this->ssl);
+
+    uint8_t address[sizeof(in6_addr)];
+    bool numeric = inet_pton(AF_INET, this->host.c_str(), address) == 1
+            || inet_pton(AF_INET6, this->host.c_str(), address) == 1;
+
+    int checked = numeric ? X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(this->ssl), this->host.c_str())
+            : SSL_set_tlsext_host_name(this->ssl, this->host.c_str()) && SSL_set1_host(this->ssl, this->host.c_str());
+
+    if (!checked) {
+        close();
+        return NW_ERR_TLS;
+    }
+
+    this->state = TLS_HANDSHAKE;
+
+    return NW_OK;
+}
+
+/** \brief Frees connection.
+ *
+ *  Frees the current connection and drops held back packets.
+ */
+void ProcTLS::close() {
+
+    if (this->ssl) {
+
+        // Connections are dropped without close notify, which must not spoil the session.
+        SSL_set_shutdown(this->ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        SSL_free(this->ssl);
+    }
+
+    this->ssl=0;
+    this->input=0;
+    this->output=0;
+    this->state=TLS_CLOSED;
+    this->offloaded=false;
+    this->held.clear();
+}
+
+/** \brief Continues handshake.
+ *
+ *  Continues the handshake with the data received so far and sends its records.
+ *  Counts completed handshakes and releases held back packets, unless the connection
+ *  waits for the socket to drain to offload.
+ *
+ *  \return 0 in case of success, even if the handshake is not done yet, an error code otherwise.
+ */
+uint8_t ProcTLS::handshake() {
+
+    if (this->state == TLS_CLOSED)
+        return NW_ERR_TLS;
+
+    if (this->state != TLS_HANDSHAKE)
+        return NW_OK;
+
+    ERR_clear_error();
+    int result = SSL_do_handshake(this->ssl);
+    int error = result == 1 ? SSL_ERROR_NONE : SSL_get_error(this->ssl, result);
+
+    uint8_t status = drain();
+    if (status)
+        return status;
+
+    if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)
+        return NW_OK;
+
+    if (error != SSL_ERROR_NONE)
+        return NW_ERR_TLS;
+
+    this->handshakes++;
+    if (SSL_session_reused(this->ssl))
+        this->resumed++;
+
+    if (this->context->isOffloading() && SSL_version(this->ssl) == TLS1_3_VERSION) {
+        this->state = TLS_OFFLOADING;
+        return NW_OK;
+    }
+
+    this->state = TLS_ESTABLISHED;
+
+    return release();
+}
+
+/** \brief Encrypts packet.
+ *
+ *  Encrypts 'packet' and sends the records. Large slices are encrypted in place,
+ *  small ones gathered first, so they share records.
+ *
+ *  \param packet The packet to encrypt.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::encrypt(shared_ptr<deque<BufferSlice>> &packet) {
+
+    vector<uint8_t> gathered;
+
+    for (auto &slice : *packet) {
+
+        if (slice.size() < TLS_DIRECT_SIZE) {
+            gathered.insert(gathered.end(), slice.begin(), slice.end());
+            continue;
+        }
+
+        if (!gathered.empty() && !write(&gathered[0], gathered.size()))
+            return NW_ERR_TLS;
+
+        gathered.clear();
+
+        if (!write(slice.begin(), slice.size()))
+            return NW_ERR_TLS;
+    }
+
+    if (!gathered.empty() && !write(&gathered[0], gathered.size()))
+        return NW_ERR_TLS;
+
+    return drain();
+}
+
+/** \brief Encrypts data.
+ *
+ *  Encrypts 'length' bytes at 'data' into the output BIO, which takes them completely.
+ *
+ *  \param data The data to encrypt.
+ *  \param length The number of bytes.
+ *  \return true in case of success, false otherwise.
+ */
+bool ProcTLS::write(const uint8_t *data, size_t length) {
+
+    ERR_clear_error();
+    if (SSL_write(this->ssl, data, length) != (int)length)
+        return false;
+
+    this->bytesEncrypted += length;
+    return true;
+}
+
+/** \brief Sends records.
+ *
+ *  Transmits all records in the output BIO to the successor as one packet.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::drain() {
+
+    size_t length = BIO_ctrl_pending(this->output);
+    if (!length)
+        return NW_OK;
+
+    // Records of OpenSSL would break the record sequence of the kernel.
+    if (this->offloaded)
+        return NW_ERR_TLS;
+
+    shared_ptr<vector<uint8_t>> records(new vector<uint8_t>(length));
+    if (BIO_read(this->output, &(*records)[0], length) != (int)length)
+        return NW_ERR_TLS;
+
+    shared_ptr<deque<BufferSlice>> packet(new deque<BufferSlice>);
+    packet->push_back(BufferSlice(records));
+
+    uint8_t status = this->getSuccessor()->transmit(packet);
+
+    return status == NW_ERR_WOULD_BLOCK ? NW_OK : status;
+}
+
+/** \brief Discards records.
+ *
+ *  Drops the records OpenSSL wrote after the offload, which would break the record sequence
+ *  of the kernel. Unless reading failed, which sends an alert, they answer a post-handshake
+ *  message of the server, i.e. a requested key update. The refusal is counted and the context
+ *  keeps the next connections in user space.
+ *
+ *  \param error The result of the read operation that wrote the records.
+ */
+void ProcTLS::refuse(int error) {
+
+    if (!BIO_ctrl_pending(this->output))
+        return;
+
+    (void)BIO_reset(this->output);
+
+    if (error != SSL_ERROR_NONE && error != SSL_ERROR_WANT_READ)
+        return;
+
+    this->keyUpdatesRefused++;
+    this->context->disableOffload();
+}
+
+/** \brief Releases held back packets.
+ *
+ *  Sends the packets transmitted during the handshake, oldest first.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t ProcTLS::release() {
+
+    while (!this->held.empty()) {
+
+        shared_ptr<deque<BufferSlice>> packet = this->held.front();
+        this->held.pop_front();
+
+        uint8_t status = forward(packet);
+        if (status && status != NW_ERR_WOULD_BLOCK)
+            return status;
+    }
+
+    return NW_OK;
+}
+
+/** \brief Offloads encryption.
+ *
+ *  Hands the encryption of the connection to the kernel. Derives key and IV of the TLS 1.3
+ *  application traffic from the send secret, attaches the TLS ULP to the socket and configures
+ *  its transmit side, starting with record number 0. Only AES-GCM is offloaded.
+ *
+ *  \return true if the kernel encrypts from now on, false if the connection stays in user space.
+ */
+bool ProcTLS::offload() {
+
+    vector<uint8_t> secret;
+    if (!this->context->getTrafficSecret(this->ssl, secret))
+        return false;
+
+    const SSL_CIPHER *cipher = SSL_get_current_cipher(this->ssl);
+    uint32_t suite = cipher ? SSL_CIPHER_get_id(cipher) : 0;
+
+    size_t keyLength = 0;
+    if (suite == TLS1_3_CK_AES_128_GCM_SHA256)
+        keyLength = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    else if (suite == TLS1_3_CK_AES_256_GCM_SHA384)
+        keyLength = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+
+    // Static IV, split into salt and explicit part by the kernel interface.
+    uint8_t key[TLS_CIPHER_AES_GCM_256_KEY_SIZE];
+    uint8_t iv[TLS_CIPHER_AES_GCM_128_SALT_SIZE + TLS_CIPHER_AES_GCM_128_IV_SIZE];
+
+    const EVP_MD *digest = cipher ? SSL_CIPHER_get_handshake_digest(cipher) : 0;
+    bool done = keyLength && digest
+            && expandLabel(digest, secret, "key", key, keyLength)
+            && expandLabel(digest, secret, "iv", iv, sizeof(iv));
+
+    OPENSSL_cleanse(&secret[0], secret.size());
+
+    int32_t socketDesc = this->getDescriptor();
+    done = done && setsockopt(socketDesc, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0;
+
+    if (done && keyLength == TLS_CIPHER_AES_GCM_128_KEY_SIZE) {
+
+        tls12_crypto_info_aes_gcm_128 info;
+        memset(&info, 0, sizeof(info));
+        info.info.version = TLS_1_3_VERSION;
+        info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        memcpy(info.key, key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+        memcpy(info.salt, iv, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+        memcpy(info.iv, iv + TLS_CIPHER_AES_GCM_128_SALT_SIZE, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+
+        done = setsockopt(socketDesc, SOL_TLS, TLS_TX, &info, sizeof(info)) == 0;
+        OPENSSL_cleanse(&info, sizeof(info));
+
+    } else if (done) {
+
+        tls12_crypto_info_aes_gcm_256 info;
+        memset(&info, 0, sizeof(info));
+        info.info.version = TLS_1_3_VERSION;
+        info.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        memcpy(info.key, key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+        memcpy(info.salt, iv, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+        memcpy(info.iv, iv + TLS_CIPHER_AES_GCM_256_SALT_SIZE, TLS_CIPHER_AES_GCM_256_IV_SIZE);
+
+        done = setsockopt(socketDesc, SOL_TLS, TLS_TX, &info, sizeof(info)) == 0;
+        OPENSSL_cleanse(&info, sizeof(info));
+    }
+
+    OPENSSL_cleanse(key, sizeof(key));
+    OPENSSL_cleanse(iv, sizeof(iv));
+
+    return done;
+}
+
+/** \brief Derives traffic key material.
+ *
+ *  HKDF-Expand-Label of TLS 1.3 (RFC 8446, 7.1) with an empty context, deriving
+ *  'length' bytes for 'label' from 'secret'.
+ *
+ *  \param digest The hash function of the cipher suite.
+ *  \param secret The traffic secret.
+ *  \param label The label, without the "tls13 " prefix.
+ *  \param target The container to write the result to.
+ *  \param length The number of bytes to derive.
+ *  \return true in case of success, false otherwise.
+ */
+bool ProcTLS::expandLabel(const EVP_MD *digest, const vector<uint8_t> &secret,
+        string label, uint8_t *target, size_t length) {
+
+    if (secret.empty())
+        return false;
+
+    // Length, prefixed label and empty context.
+    label = "tls13 " + label;
+    vector<uint8_t> info;
+    info.push_back(length >> 8);
+    info.push_back(length);
+    info.push_back(label.size());
+    info.insert(info.end(), label.begin(), label.end());
+    info.push_back(0);
+
+    EVP_PKEY_CTX *derivation = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL);
+
+    bool done = derivation
+            && EVP_PKEY_derive_init(derivation) > 0
+            && EVP_PKEY_CTX_set_hkdf_mode(derivation, EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) > 0
+            && EVP_PKEY_CTX_set_hkdf_md(derivation, digest) > 0
+            && EVP_PKEY_CTX_set1_hkdf_key(derivation, &secret[0], secret.size()) > 0
+            && EVP_PKEY_CTX_add1_hkdf_info(derivation, &info[0], info.size()) > 0
+            && EVP_PKEY_derive(derivation, target, &length) > 0;
+
+    EVP_PKEY_CTX_free(derivation);
+
+    return done;
+}
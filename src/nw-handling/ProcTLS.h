@@ -0,0 +1,95 @@
+/*
+ * ProcTLS.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef PROCTLS_H_
+#define PROCTLS_H_
+
+#define TLS_RECV_SIZE       18432   // Bytes of ciphertext received at once, a full record and more.
+#define TLS_DIRECT_SIZE     4096    // Slices from this size on are encrypted in place, smaller ones gathered.
+
+#ifndef SOL_TLS
+#define SOL_TLS             282
+#endif
+
+#include "FrameProcessor.h"
+#include "NW_TLSContext.h"
+
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+typedef enum {
+    TLS_CLOSED,         // No connection.
+    TLS_HANDSHAKE,      // Handshake in progress, packets are held back.
+    TLS_OFFLOADING,     // Handshake done, waiting for the socket to drain before offloading.
+    TLS_ESTABLISHED     // Packets are encrypted, by the kernel if offloaded.
+}tlsState;
+
+class ProcTLS : public FrameProcessor {
+public:
+    ProcTLS(shared_ptr<NW_TLSContext> context, string host);
+    virtual ~ProcTLS();
+    uint8_t initialize();
+    virtual uint8_t flush();
+    virtual uint8_t reconnect();
+    virtual bool isCongested();
+    virtual bool acceptsRaw();
+    virtual void setReplay(bool replay);
+    virtual void collectStats(NW_Stats &stats);
+
+protected:
+    virtual uint8_t forward(shared_ptr<deque<BufferSlice>> packet);
+    virtual uint8_t backward(shared_ptr<vector<uint8_t>> packet,
+            uint8_t *&begin,
+            uint8_t *&end);
+
+private:
+    shared_ptr<NW_TLSContext> context;
+    string host;
+
+    // Connection and its memory BIOs, ciphertext is exchanged through the successor.
+    SSL *ssl;
+    BIO *input, *output;
+    tlsState state;
+    bool offloaded;
+
+    // Packets transmitted during the handshake.
+    deque<shared_ptr<deque<BufferSlice>>> held;
+
+    // Received ciphertext.
+    shared_ptr<vector<uint8_t>> ciphertext;
+
+    // Statistics.
+    uint32_t handshakes, resumed, offloads, keyUpdatesRefused;
+    uint64_t bytesEncrypted, bytesDecrypted;
+
+    uint8_t open();
+    void close();
+    uint8_t handshake();
+    uint8_t encrypt(shared_ptr<deque<BufferSlice>> &packet);
+    bool write(const uint8_t *data, size_t length);
+    uint8_t drain();
+    void refuse(int error);
+    uint8_t release();
+    bool offload();
+    static bool expandLabel(const EVP_MD *digest, const vector<uint8_t> &secret,
+            string label, uint8_t *target, size_t length);
+};
+
+#endif /* PROCTLS_H_ */
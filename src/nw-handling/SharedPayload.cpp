@@ -0,0 +1,84 @@
+/** \brief      Encoded payload of a message, shared by several communicators.
+ *
+ * \details     A message distributed to several communicators only has to be encoded once per
+ *              encoding, e.g. protocol version and device id. The first ProcPayload encoding it
+ *              stores its packets here, all others with the same encoding get copies of them.
+ *              Copies reference the same buffers and their precomputed checksums, so only the
+ *              slice lists are duplicated, which the later processors of each chain extend by
+ *              their own headers. The buffers themselves are never modified.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       SharedPayload
+ */
+
+#include "SharedPayload.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of SharedPayload instances, holding no encodings yet.
+ */
+SharedPayload::SharedPayload() : Value(VAL_SHARED_PAYLOAD, true) { }
+
+/** \brief Destructor.
+ *
+ *  Destructor of SharedPayload instances.
+ */
+SharedPayload::~SharedPayload() { }
+
+/** \brief Looks up encoded packets.
+ *
+ *  Appends copies of the packets stored for encoding 'key' to 'packets', if any.
+ *
+ *  \param key The encoding key.
+ *  \param packets The container to append the packets to.
+ *  \return true if the encoding was found, false otherwise.
+ */
+bool SharedPayload::lookup(uint32_t key, queue< shared_ptr< deque<BufferSlice>>> &packets) {
+
+    lock_guard<mutex> guard(this->lock);
+
+    auto encodingIt = this->encodings.find(key);
+    if (encodingIt == this->encodings.end())
+        return false;
+
+    for (auto &packet : encodingIt->second)
+        packets.push(shared_ptr<deque<BufferSlice>>(new deque<BufferSlice>(*packet)));
+
+    return true;
+}
+
+/** \brief Stores encoded packets.
+ *
+ *  Stores copies of 'packets' for encoding 'key', unless already stored. The checksums of
+ *  all slices are computed beforehand, so no chain has to compute them again.
+ *  The packets themselves are left unchanged.
+ *
+ *  \param key The encoding key.
+ *  \param packets The packets to store.
+ */
+void SharedPayload::store(uint32_t key, queue< shared_ptr< deque<BufferSlice>>> packets) {
+
+    vector< shared_ptr< deque<BufferSlice>>> encoding;
+    while (!packets.empty()) {
+
+        // Sum the given slices, so the caller's packets keep their checksums as well.
+        for (auto &slice : *packets.front())
+            slice.getChecksum();
+
+        encoding.push_back(shared_ptr<deque<BufferSlice>>(new deque<BufferSlice>(*packets.front())));
+        packets.pop();
+    }
+
+    lock_guard<mutex> guard(this->lock);
+    this->encodings.insert(make_pair(key, encoding));
+}
+
+/** \brief Clones the instance.
+ *
+ *  Encodings belong to one message, so the clone holds none.
+ *
+ *  \return An empty SharedPayload instance.
+ */
+shared_ptr<Value> SharedPayload::clone() {
+    return shared_ptr<Value>(new SharedPayload);
+}
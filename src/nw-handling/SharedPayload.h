@@ -0,0 +1,38 @@
+/*
+ * SharedPayload.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef SHAREDPAYLOAD_H_
+#define SHAREDPAYLOAD_H_
+
+#define ARG_ENCODED "Encoded"
+
+#include "../Value.h"
+#include "BufferSlice.h"
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <queue>
+
+using namespace std;
+
+class SharedPayload : public Value {
+public:
+    SharedPayload();
+    virtual ~SharedPayload();
+    bool lookup(uint32_t key, queue< shared_ptr< deque<BufferSlice>>> &packets);
+    void store(uint32_t key, queue< shared_ptr< deque<BufferSlice>>> packets);
+    virtual shared_ptr<Value> clone();
+
+private:
+    mutex lock;
+
+    // Encoded packets by encoding key, never modified once stored.
+    map<uint32_t, vector< shared_ptr< deque<BufferSlice>>>> encodings;
+};
+
+#endif /* SHAREDPAYLOAD_H_ */
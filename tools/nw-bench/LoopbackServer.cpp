@@ -0,0 +1,651 @@
+/** \brief      Loopback stand-in for the Amber server.
+ *
+ * \details     Speaks the framing protocol of the board unit over a TCP connection on the loopback
+ *              interface, so the network chain can be driven without the real backend.
+ *              Frames are parsed independently of ProcDataFrame: frame begin, 16 bit payload
+ *              length, payload, XOR checksum and frame end. Like on the board unit, frames with a
+ *              wrong checksum are dropped as a whole and other candidates are skipped by one byte.
+ *              Registrations are answered with the latest protocol version and the features
+ *              given on construction, sequenced payloads are acknowledged right away.
+ *              Command frames sent to the board unit may be split into small chunks, corrupted
+ *              and separated by garbage, to stress the frame parser of the board unit.
+ *              Optionally speaks TLS with a generated self-signed certificate, issuing session
+ *              tickets and counting full and resumed handshakes.
+ *              Accepts a single connection at a time.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ * \class       LoopbackServer
+ */
+
+#include "LoopbackServer.h"
+
+/** \brief Constructor.
+ *
+ *  Constructor of LoopbackServer instances.
+ *
+ *  \param features Features accepted in registration answers, e.g. FEATURE_ACK.
+ */
+LoopbackServer::LoopbackServer(uint8_t features) {
+
+    this->listenDesc=-1;
+    this->clientDesc=-1;
+    this->port=0;
+    this->features=features;
+    this->tls=0;
+    this->session=0;
+
+    this->frames=0;
+    this->wireBytes=0;
+    this->checksumErrors=0;
+    this->images=0;
+    this->telemetry[0]=0;
+    this->telemetry[1]=0;
+    for (auto &count : this->framesById)
+        count=0;
+    for (uint8_t resumed=0; resumed < 2; resumed++) {
+        this->handshakes[resumed]=0;
+        this->handshakeMicros[resumed]=0;
+    }
+
+    this->random.seed(chrono::steady_clock::now().time_since_epoch().count());
+}
+
+/** \brief Destructor.
+ *
+ *  Destructor of LoopbackServer instances.
+ */
+LoopbackServer::~LoopbackServer() {
+
+    disconnect();
+    if (this->listenDesc != -1)
+        close(this->listenDesc);
+    if (this->tls)
+        SSL_CTX_free(this->tls);
+}
+
+/** \brief Opens listening socket.
+ *
+ *  Listens on an ephemeral port of the loopback interface, see getPort.
+ *
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t LoopbackServer::start() {
+
+    this->listenDesc = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (this->listenDesc == -1)
+        return NW_ERR_SOCKET;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    socklen_t length = sizeof(address);
+    if (bind(this->listenDesc, (struct sockaddr*)&address, sizeof(address)) == -1 ||
+            listen(this->listenDesc, 1) == -1 ||
+            getsockname(this->listenDesc, (struct sockaddr*)&address, &length) == -1) {
+        close(this->listenDesc);
+        this->listenDesc=-1;
+        return NW_ERR_SOCKET;
+    }
+
+    this->port = ntohs(address.sin_port);
+    return NW_OK;
+}
+
+/** \brief Enables TLS.
+ *
+ *  Generates a P-256 key and a self-signed certificate for 127.0.0.1 and localhost, stores the
+ *  certificate to 'certFile' for clients to trust and speaks TLS with all following clients.
+ *
+ *  \param certFile The file to write the certificate to, in PEM format.
+ *  \return 0 in case of success, an error code otherwise.
+ */
+uint8_t LoopbackServer::enableTLS(string certFile) {
+
+    EVP_PKEY *key = EVP_EC_gen("P-256");
+    X509 *cert = X509_new();
+    bool done = key && cert;
+
+    if (done) {
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), LOOPBACK_CERT_DAYS*86400L);
+        X509_set_pubkey(cert, key);
+
+        X509_NAME *name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+
+        X509V3_CTX extensions;
+        X509V3_set_ctx_nodb(&extensions);
+        X509V3_set_ctx(&extensions, cert, cert, NULL, NULL, 0);
+        X509_EXTENSION *names = X509V3_EXT_conf_nid(NULL, &extensions, NID_subject_alt_name,
+                "IP:127.0.0.1,DNS:localhost");
+        done = names && X509_add_ext(cert, names, -1) && X509_sign(cert, key, EVP_sha256());
+        X509_EXTENSION_free(names);
+    }
+
+    FILE *file = done ? fopen(certFile.c_str(), "w") : NULL;
+    done = file && PEM_write_X509(file, cert);
+    if (file)
+        fclose(file);
+
+    if (done) {
+        this->tls = SSL_CTX_new(TLS_server_method());
+        done = this->tls
+                && SSL_CTX_use_certificate(this->tls, cert) == 1
+                && SSL_CTX_use_PrivateKey(this->tls, key) == 1;
+    }
+
+    // Records are written from two threads on a non-blocking socket.
+    if (done)
+        SSL_CTX_set_mode(this->tls, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+
+    return done ? NW_OK : NW_ERR_TLS;
+}
+
+/** \brief Drops the client.
+ *
+ *  Shuts the connection down, as if the network broke. The client has to reconnect.
+ */
+void LoopbackServer::dropClient() {
+
+    this->sendMutex.lock();
+    if (this->clientDesc != -1)
+        shutdown(this->clientDesc, SHUT_RDWR);
+    this->sendMutex.unlock();
+}
+
+/** \brief Getter for port.
+ *
+ *  \return Port the server listens on, 0 if not started.
+ */
+uint16_t LoopbackServer::getPort() {
+    return this->port;
+}
+
+/** \brief Checks for connection.
+ *
+ *  \return true if a client is connected, false otherwise.
+ */
+bool LoopbackServer::isConnected() {
+    return this->clientDesc != -1;
+}
+
+/** \brief Run method, implemented from Child.
+ *
+ *  Accepts a client and serves it, until terminate is called.
+ *
+ *  \return 0 on regular termination, -1 if the server was not started.
+ */
+int LoopbackServer::run() {
+
+    if (this->listenDesc == -1)
+        return -1;
+
+    while (!this->isTerminating()) {
+
+        struct pollfd desc;
+        desc.fd = this->clientDesc != -1 ? (int32_t)this->clientDesc : this->listenDesc;
+        desc.events = POLLIN;
+
+        if (poll(&desc, 1, LOOPBACK_POLL) <= 0)
+            continue;
+
+        if (this->clientDesc == -1) {
+
+            int32_t client = accept4(this->listenDesc, NULL, NULL, SOCK_CLOEXEC);
+            if (client == -1)
+                continue;
+
+            // Answers are small, don't let them wait for more data.
+            int32_t one=1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            if (this->tls && !handshake(client)) {
+                close(client);
+                continue;
+            }
+
+            this->rx.clear();
+            this->clientDesc = client;
+
+        } else
+            receive();
+    }
+
+    return 0;
+}
+
+/** \brief Does TLS handshake.
+ *
+ *  Does the server side of the handshake on 'client', blocking, and counts it as full or
+ *  resumed. The socket is non-blocking afterwards, so reading and writing threads never wait
+ *  for each other while holding sendMutex.
+ *
+ *  \param client The accepted connection.
+ *  \return true on success, false otherwise.
+ */
+bool LoopbackServer::handshake(int32_t client) {
+
+    SSL *ssl = SSL_new(this->tls);
+    if (!ssl)
+        return false;
+
+    struct timeval timeout = { LOOPBACK_HANDSHAKE, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    auto start = chrono::steady_clock::now();
+
+    if (SSL_set_fd(ssl, client) != 1 || SSL_accept(ssl) != 1) {
+        SSL_free(ssl);
+        return false;
+    }
+
+    uint8_t resumed = SSL_session_reused(ssl) ? 1 : 0;
+    this->handshakes[resumed]++;
+    this->handshakeMicros[resumed] += chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start).count();
+
+    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+    this->session = ssl;
+
+    return true;
+}
+
+/** \brief Receives from client.
+ *
+ *  Receives available bytes and handles all complete frames.
+ *  Closes the connection, if the client closed it.
+ */
+void LoopbackServer::receive() {
+
+    size_t pending = this->rx.size();
+    this->rx.resize(pending + LOOPBACK_RECV_SIZE);
+
+    ssize_t received;
+    if (this->session) {
+
+        this->sendMutex.lock();
+        ERR_clear_error();
+        received = SSL_read(this->session, &this->rx[pending], LOOPBACK_RECV_SIZE);
+        int error = received > 0 ? SSL_ERROR_NONE : SSL_get_error(this->session, received);
+        this->sendMutex.unlock();
+
+        // Record incomplete.
+        if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+            this->rx.resize(pending);
+            return;
+        }
+
+    } else
+        received = recv(this->clientDesc, &this->rx[pending], LOOPBACK_RECV_SIZE, 0);
+
+    if (received <= 0) {
+        disconnect();
+        this->rx.clear();
+        return;
+    }
+
+    this->rx.resize(pending + received);
+    this->wireBytes += received;
+
+    parse();
+}
+
+/** \brief Closes client connection.
+ *
+ *  Frees the TLS session, if any, and closes the connection.
+ */
+void LoopbackServer::disconnect() {
+
+    this->sendMutex.lock();
+
+    if (this->session)
+        SSL_free(this->session);
+    this->session=0;
+
+    if (this->clientDesc != -1)
+        close(this->clientDesc);
+    this->clientDesc=-1;
+
+    this->sendMutex.unlock();
+}
+
+/** \brief Parses received bytes.
+ *
+ *  Handles all complete frames and keeps the bytes of an incomplete one.
+ */
+void LoopbackServer::parse() {
+
+    size_t offset=0;
+
+    while (this->rx.size() - offset >= 5) {
+
+        uint8_t *candidate = &this->rx[offset];
+
+        // Search for frame begin.
+        if (candidate[0] != FRAME_BEGIN1 || candidate[1] != FRAME_BEGIN2 || candidate[2] != FRAME_BEGIN3) {
+            offset++;
+            continue;
+        }
+
+        size_t length = (candidate[3] << 8) | candidate[4];
+        if (this->rx.size() - offset < length + 9)
+            break;
+
+        // Check frame end and checksum, drop corrupted frames as a whole and
+        // resume search behind the frame begin of other candidates.
+        uint8_t *tail = candidate + 5 + length;
+        bool ended = tail[1] == FRAME_END1 && tail[2] == FRAME_END2 && tail[3] == FRAME_END3;
+        if (!ended || Checksum::xorBytes(candidate + 5, length, CHECKSUM_INIT) != tail[0]) {
+            this->checksumErrors++;
+            offset += ended ? length + 9 : 1;
+            continue;
+        }
+
+        handle(candidate + 5, length);
+        offset += length + 9;
+    }
+
+    this->rx.erase(this->rx.begin(), this->rx.begin() + offset);
+}
+
+/** \brief Handles payload.
+ *
+ *  Counts the payload by message id, answers registrations, acknowledges sequenced payloads
+ *  records the arrival of complete images and counts telemetry by encoding.
+ *
+ *  \param payload The payload.
+ *  \param length Its length.
+ */
+void LoopbackServer::handle(uint8_t *payload, size_t length) {
+
+    if (!length)
+        return;
+
+    // Acknowledge sequenced payloads and unwrap them.
+    if (payload[0] == MSG_ID_SEQUENCED && length > ACK_HEADER) {
+
+        vector<uint8_t> ack(payload, payload + ACK_HEADER);
+        ack[0] = MSG_ID_ACK;
+        sendFrame(ack);
+
+        payload += ACK_HEADER;
+        length -= ACK_HEADER;
+    }
+
+    this->frames++;
+    this->framesById[payload[0]]++;
+
+    switch (payload[0]) {
+    case MSG_ID_REGISTER:
+    {
+        // Message id, device id, protocol version and accepted features.
+        vector<uint8_t> answer;
+        answer.push_back(MSG_ID_REGISTER);
+        answer.push_back(length > 1 ? payload[1] : 0);
+        answer.push_back(PROTOCOL_VERSION);
+        answer.push_back(this->features);
+        sendFrame(answer);
+        break;
+    }
+    case MSG_ID_IMAGE:
+    {
+        // Last fragment of an image completes it.
+        if (length > 4 && payload[2] == DATA_TYPE_IMG && payload[3] == payload[4]) {
+
+            this->imageMutex.lock();
+            this->imageTimes.push_back(chrono::steady_clock::now());
+            this->imageMutex.unlock();
+
+            this->images++;
+        }
+
+        // Binary telemetry has the 4 byte latitude between the first two field ids,
+        // ASCII telemetry its length and text.
+        if (length > 8 && payload[2] == DATA_TYPE_TELEMETRY && payload[3] == FIELD_TYPE_POS_N)
+            this->telemetry[payload[8] == FIELD_TYPE_POS_E]++;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/** \brief Sends commands to the board unit.
+ *
+ *  Sends 'count' command frames, numbered by their command type modulo 256 and padded by
+ *  'padding' bytes, injecting the faults in 'inject'. Corrupted frames have a padding byte
+ *  flipped, so they fail the checksum but their frame begin and length stay intact.
+ *  Blocks until all frames are sent.
+ *
+ *  \param count Number of command frames.
+ *  \param padding Padding bytes behind the command type, at least 1 if frames are corrupted.
+ *  \param inject Faults to inject.
+ *  \return Number of intact frames sent.
+ */
+uint32_t LoopbackServer::sendCommands(uint32_t count, size_t padding, faults inject) {
+
+    uint32_t intact=0;
+
+    for (uint32_t index=0; index < count; index++) {
+
+        vector<uint8_t> payload;
+        payload.push_back(MSG_ID_COMMAND);
+        payload.push_back(0);
+        payload.push_back(index);
+        payload.insert(payload.end(), padding, 0x55);
+
+        vector<uint8_t> bytes;
+
+        // Garbage never contains a frame begin.
+        if (inject.noise) {
+            size_t noise = this->random() % (inject.noise + 1);
+            for (size_t byte=0; byte < noise; byte++)
+                bytes.push_back(this->random() % FRAME_BEGIN1);
+        }
+
+        frame(bytes, payload);
+
+        if (inject.corruptEvery && padding && (index + 1) % inject.corruptEvery == 0)
+            bytes[bytes.size() - 5] ^= 0xFF;
+        else
+            intact++;
+
+        // Send in chunks, giving the board unit time to see partial frames.
+        size_t offset=0;
+        while (offset < bytes.size()) {
+
+            size_t chunk = bytes.size() - offset;
+            if (inject.chunk)
+                chunk = min(chunk, 1 + this->random() % inject.chunk);
+
+            this->sendMutex.lock();
+            bool sent = sendAll(&bytes[offset], chunk);
+            this->sendMutex.unlock();
+
+            if (!sent)
+                return intact;
+
+            offset += chunk;
+            if (inject.chunk)
+                this_thread::yield();
+        }
+    }
+
+    return intact;
+}
+
+/** \brief Sends frame.
+ *
+ *  Frames 'payload' and sends it to the client.
+ *
+ *  \param payload The payload.
+ *  \return true on success, false otherwise.
+ */
+bool LoopbackServer::sendFrame(vector<uint8_t> &payload) {
+
+    vector<uint8_t> bytes;
+    frame(bytes, payload);
+
+    this->sendMutex.lock();
+    bool sent = sendAll(&bytes[0], bytes.size());
+    this->sendMutex.unlock();
+
+    return sent;
+}
+
+/** \brief Sends bytes.
+ *
+ *  Sends all bytes to the client, blocking until they are taken. Call with sendMutex locked.
+ *
+ *  \param data The bytes to send.
+ *  \param length Their number.
+ *  \return true on success, false otherwise.
+ */
+bool LoopbackServer::sendAll(const uint8_t *data, size_t length) {
+
+    while (length) {
+
+        if (this->clientDesc == -1)
+            return false;
+
+        ssize_t sent;
+        if (this->session) {
+
+            ERR_clear_error();
+            sent = SSL_write(this->session, data, length);
+
+            // Socket is full, wait until the client read.
+            int error = sent > 0 ? SSL_ERROR_NONE : SSL_get_error(this->session, sent);
+            if (error == SSL_ERROR_WANT_WRITE || error == SSL_ERROR_WANT_READ) {
+                struct pollfd desc;
+                desc.fd = this->clientDesc;
+                desc.events = error == SSL_ERROR_WANT_WRITE ? POLLOUT : POLLIN;
+                poll(&desc, 1, LOOPBACK_POLL);
+                continue;
+            }
+
+        } else
+            sent = send(this->clientDesc, data, length, MSG_NOSIGNAL);
+
+        if (sent <= 0)
+            return false;
+
+        data += sent;
+        length -= sent;
+    }
+
+    return true;
+}
+
+/** \brief Frames payload.
+ *
+ *  Appends 'payload' framed like ProcDataFrame does to 'target'.
+ *
+ *  \param target The bytes to append to.
+ *  \param payload The payload.
+ */
+void LoopbackServer::frame(vector<uint8_t> &target, vector<uint8_t> &payload) {
+
+    target.push_back(FRAME_BEGIN1);
+    target.push_back(FRAME_BEGIN2);
+    target.push_back(FRAME_BEGIN3);
+    target.push_back(payload.size() >> 8);
+    target.push_back(payload.size());
+    target.insert(target.end(), payload.begin(), payload.end());
+    target.push_back(Checksum::xorBytes(&payload[0], payload.size(), CHECKSUM_INIT));
+    target.push_back(FRAME_END1);
+    target.push_back(FRAME_END2);
+    target.push_back(FRAME_END3);
+}
+
+/** \brief Getter for received frames.
+ *
+ *  \return Number of intact frames received.
+ */
+uint64_t LoopbackServer::getFrames() {
+    return this->frames;
+}
+
+/** \brief Getter for received frames of a message id.
+ *
+ *  \param msgId The message id.
+ *  \return Number of intact frames received with message id 'msgId'.
+ */
+uint64_t LoopbackServer::getFrames(uint8_t msgId) {
+    return this->framesById[msgId];
+}
+
+/** \brief Getter for received bytes.
+ *
+ *  \return Number of bytes received, including framing.
+ */
+uint64_t LoopbackServer::getWireBytes() {
+    return this->wireBytes;
+}
+
+/** \brief Getter for checksum errors.
+ *
+ *  \return Number of frame candidates dropped for a wrong checksum or frame end.
+ */
+uint64_t LoopbackServer::getChecksumErrors() {
+    return this->checksumErrors;
+}
+
+/** \brief Getter for complete images.
+ *
+ *  \return Number of images received completely.
+ */
+uint64_t LoopbackServer::getImages() {
+    return this->images;
+}
+
+/** \brief Getter for telemetry frames.
+ *
+ *  \param binary Whether to count binary or ASCII telemetry.
+ *  \return Number of uncompressed telemetry frames in that encoding.
+ */
+uint64_t LoopbackServer::getTelemetry(bool binary) {
+    return this->telemetry[binary];
+}
+
+/** \brief Getter for handshakes.
+ *
+ *  \param resumed Whether to count resumed or full handshakes.
+ *  \return Number of TLS handshakes of that kind.
+ */
+uint64_t LoopbackServer::getHandshakes(bool resumed) {
+    return this->handshakes[resumed];
+}
+
+/** \brief Getter for handshake duration.
+ *
+ *  \param resumed Whether to average resumed or full handshakes.
+ *  \return Mean duration of TLS handshakes of that kind in milliseconds, 0 if there was none.
+ */
+double LoopbackServer::getHandshakeTime(bool resumed) {
+
+    uint64_t count = this->handshakes[resumed];
+    return count ? this->handshakeMicros[resumed] / 1000.0 / count : 0;
+}
+
+/** \brief Getter for image arrival times.
+ *
+ *  \return Arrival time of the last fragment of each complete image, in order.
+ */
+vector<chrono::steady_clock::time_point> LoopbackServer::getImageTimes() {
+
+    this->imageMutex.lock();
+    vector<chrono::steady_clock::time_point> result = this->imageTimes;
+    this->imageMutex.unlock();
+
+    return result;
+}
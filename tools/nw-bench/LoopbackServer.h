@@ -0,0 +1,115 @@
+/*
+ * LoopbackServer.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: Daniel Wagenknecht
+ */
+
+#ifndef LOOPBACKSERVER_H_
+#define LOOPBACKSERVER_H_
+
+#define LOOPBACK_POLL       100     // Milliseconds.
+#define LOOPBACK_RECV_SIZE  65536
+#define LOOPBACK_CERT_DAYS  1       // Validity of the generated certificate.
+#define LOOPBACK_HANDSHAKE  5       // Seconds to wait for the client during a TLS handshake.
+
+#include "../../src/Child.h"
+#include "../../src/nw-handling/ProcAck.h"
+#include "../../src/nw-handling/ProcCompress.h"
+#include "../../src/nw-handling/ProcDataFrame.h"
+#include "../../src/nw-handling/ProcPayload.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+/** Faults injected into frames sent to the board unit. */
+typedef struct faults {
+    size_t chunk;           // Maximum bytes per send call, 0 to send each frame at once.
+    uint32_t corruptEvery;  // Corrupt every n-th frame, 0 to corrupt none.
+    size_t noise;           // Maximum garbage bytes between frames.
+}faults;
+
+class LoopbackServer : public Child {
+public:
+    LoopbackServer(uint8_t features=0);
+    virtual ~LoopbackServer();
+    virtual int run();
+    uint8_t start();
+    uint16_t getPort();
+    bool isConnected();
+    uint8_t enableTLS(string certFile);
+    void dropClient();
+
+    uint32_t sendCommands(uint32_t count, size_t padding, faults inject);
+
+    uint64_t getFrames();
+    uint64_t getFrames(uint8_t msgId);
+    uint64_t getWireBytes();
+    uint64_t getChecksumErrors();
+    uint64_t getImages();
+    uint64_t getTelemetry(bool binary);
+    vector<chrono::steady_clock::time_point> getImageTimes();
+    uint64_t getHandshakes(bool resumed);
+    double getHandshakeTime(bool resumed);
+
+private:
+    int32_t listenDesc;
+    atomic<int32_t> clientDesc;
+    uint16_t port;
+    uint8_t features;
+
+    // Optional TLS, with the session of the current client.
+    SSL_CTX *tls;
+    SSL *session;
+
+    // Received bytes not parsed yet.
+    vector<uint8_t> rx;
+
+    // Statistics, read from other threads.
+    atomic<uint64_t> frames, wireBytes, checksumErrors, images;
+
+    // Telemetry frames in ASCII and in binary encoding.
+    atomic<uint64_t> telemetry[2];
+    atomic<uint64_t> framesById[256];
+
+    // Full and resumed handshakes and their accumulated duration in microseconds.
+    atomic<uint64_t> handshakes[2], handshakeMicros[2];
+
+    // Arrival of the last fragment of each image.
+    mutex imageMutex;
+    vector<chrono::steady_clock::time_point> imageTimes;
+
+    // Serializes frames written by the server thread and by sendCommands, and TLS records.
+    mutex sendMutex;
+    minstd_rand random;
+
+    bool handshake(int32_t client);
+    void receive();
+    void disconnect();
+    void parse();
+    void handle(uint8_t *payload, size_t length);
+    bool sendFrame(vector<uint8_t> &payload);
+    bool sendAll(const uint8_t *data, size_t length);
+    static void frame(vector<uint8_t> &target, vector<uint8_t> &payload);
+};
+
+#endif /* LOOPBACKSERVER_H_ */
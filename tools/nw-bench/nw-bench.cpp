@@ -0,0 +1,432 @@
+/** \brief      Throughput benchmark of the network chain.
+ *
+ * \details     Drives the realtime chain of the board unit (ProcPayload, optional ProcCompress and
+ *              ProcAck, ProcDataFrame, optional ProcTLS, NW_SocketInterface) by an NW_Reactor
+ *              against a LoopbackServer on the loopback interface.
+ *              The upload phase pushes synthetic data sets with an image of the given size, at
+ *              most 'outstanding' of them not yet received completely, and reports sustained
+ *              MB/s, frames per second and the latency from pushing a data set to the arrival of
+ *              its last image fragment. Telemetry has to switch to the binary encoding the server
+ *              selects on registration, whatever the device id.
+ *              The download phase sends command frames split into small chunks, corrupted and
+ *              separated by garbage, and checks that exactly the intact ones arrive, in order.
+ *              The reconnect phase drops the connection at the server several times and waits
+ *              for the board unit to register again, reporting full and resumed TLS handshakes.
+ *              Not part of the board unit build. Build it from the sources in tools/nw-bench,
+ *              src/nw-handling and src/msg-handling plus Child, Value, ValContainer and
+ *              NmeaParser, linked with pthread, zlib and OpenSSL (ssl, crypto).
+ *              Data sets log their lifetime to stderr, redirect it for clean output.
+ * \author      Daniel Wagenknecht
+ * \version     2026-10-19
+ */
+
+#include "LoopbackServer.h"
+#include "../../src/nw-handling/NW_Reactor.h"
+#include "../../src/nw-handling/NW_SocketInterface.h"
+#include "../../src/nw-handling/ProcTLS.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+
+#include <getopt.h>
+#include <unistd.h>
+
+#define BENCH_DEV_ID        1       // Default device id.
+#define BENCH_TIMEOUT       30000   // Milliseconds to wait for a phase to complete.
+#define BENCH_SHAPE_BURST   131072  // Burst allowance of the shaped image rate in bytes.
+#define BENCH_CERT_FILE     "/tmp/nw-bench-XXXXXX"  // Template of the server certificate file.
+
+using namespace std;
+
+/** Benchmark options. */
+typedef struct options {
+    uint8_t devID;          // Device id of the board unit.
+    uint32_t count;         // Data sets to upload.
+    size_t size;            // Image bytes per data set.
+    uint32_t outstanding;   // Data sets pushed but not received completely.
+    uint8_t compression;    // Deflate level, 0 without ProcCompress.
+    uint16_t window;        // Acknowledgement window, 0 without ProcAck.
+    uint8_t batching;       // Batching of bursts, see txBatching.
+    uint32_t limit;         // Image send rate in kbit/s, 0 without shaper.
+    bool tls;               // Whether the connection is encrypted by ProcTLS.
+    bool offload;           // Whether ProcTLS hands the encryption to the kernel, if supported.
+    string certFile;        // Server certificate trusted by the board unit.
+    uint32_t commands;      // Command frames to download.
+    faults inject;          // Faults of downloaded frames.
+    uint32_t reconnects;    // Connections dropped by the server.
+}options;
+
+/** \brief Waits for a condition.
+ *
+ *  \param done The condition.
+ *  \return true if the condition was met in time, false otherwise.
+ */
+template<typename Condition>
+static bool waitFor(Condition done) {
+
+    auto start = chrono::steady_clock::now();
+    while (!done()) {
+        if (chrono::steady_clock::now() - start > chrono::milliseconds(BENCH_TIMEOUT))
+            return false;
+        this_thread::sleep_for(chrono::microseconds(100));
+    }
+    return true;
+}
+
+/** \brief Creates the realtime chain.
+ *
+ *  Sets up the chain like Initializer::createComm does, connected to the loopback server.
+ *
+ *  \param opts Benchmark options.
+ *  \param port Port of the loopback server.
+ *  \return The communicator, empty on error.
+ */
+static shared_ptr<NetworkCommunicator> createComm(options &opts, uint16_t port) {
+
+    shared_ptr<NW_SocketInterface> interface(new NW_SocketInterface(
+            AF_UNSPEC, SOCK_STREAM, "127.0.0.1", to_string(port), "lo"));
+    interface->setTransmit(opts.batching, 0, 0);
+    if (interface->initialize())
+        return shared_ptr<NetworkCommunicator>();
+
+    shared_ptr<ProcPayload> payload(new ProcPayload(opts.devID, PROTOCOL_ASCII,
+            (opts.compression ? FEATURE_COMPRESS : 0) | (opts.window ? FEATURE_ACK : 0)));
+
+    // Small bursts, so the measured rate is the shaped one.
+    if (opts.limit) {
+        shared_ptr<NW_Shaper> shaper(new NW_Shaper);
+        shaper->setBudget(SHAPE_IMAGE, opts.limit*125, BENCH_SHAPE_BURST);
+        payload->setShaper(shaper);
+    }
+
+    shared_ptr<ProcCompress> compress;
+    if (opts.compression) {
+        compress = shared_ptr<ProcCompress>(new ProcCompress(opts.compression));
+        if (compress->initialize())
+            return shared_ptr<NetworkCommunicator>();
+    }
+
+    shared_ptr<ProcAck> ack;
+    if (opts.window)
+        ack = shared_ptr<ProcAck>(new ProcAck(opts.window));
+
+    shared_ptr<ProcTLS> secure;
+    if (opts.tls) {
+        shared_ptr<NW_TLSContext> context(new NW_TLSContext);
+        if (context->initialize(opts.certFile, opts.offload))
+            return shared_ptr<NetworkCommunicator>();
+
+        secure = shared_ptr<ProcTLS>(new ProcTLS(context, "127.0.0.1"));
+        if (secure->initialize())
+            return shared_ptr<NetworkCommunicator>();
+    }
+
+    shared_ptr<NetworkCommunicator> comm(new NetworkCommunicator(NW_TYPE_REALTIME));
+    if (!comm->appenProc(payload) ||
+            (compress && !comm->appenProc(compress)) ||
+            (ack && !comm->appenProc(ack)) ||
+            !comm->appenProc(shared_ptr<ProcDataFrame>(new ProcDataFrame)) ||
+            (secure && !comm->appenProc(secure)) ||
+            !comm->appenProc(interface))
+        return shared_ptr<NetworkCommunicator>();
+
+    return comm;
+}
+
+/** \brief Creates synthetic data set.
+ *
+ *  \param image Image bytes, shared by all data sets.
+ *  \return The data set.
+ */
+static shared_ptr<M2C_DataSet> createDataSet(shared_ptr<vector<unsigned char>> image) {
+
+    shared_ptr<M2C_DataSet> data(new M2C_DataSet);
+    data->setValue(ARG_IMG, shared_ptr<ValVectorUChar>(new ValVectorUChar(image)));
+    data->setValue(ARG_POS_E, shared_ptr<ValDouble>(new ValDouble(13.7372621)));
+    data->setValue(ARG_POS_N, shared_ptr<ValDouble>(new ValDouble(51.0504088)));
+    data->setValue(ARG_POS_H, shared_ptr<ValDouble>(new ValDouble(113.0)));
+
+    // All other fields are sent as plausible constants.
+    const char *fields[] = { ARG_ACC_X, ARG_ACC_Y, ARG_ACC_Z, ARG_GYRO_X, ARG_GYRO_Y, ARG_GYRO_Z,
+            ARG_OBD_SPEED, ARG_OBD_RPM, ARG_OBD_ENG_LOAD, ARG_OBD_COOL_TEMP, ARG_OBD_AIR_FLOW,
+            ARG_OBD_INLET_PRESS, ARG_OBD_INLET_TEMP, ARG_OBD_FUEL_LVL, ARG_OBD_FUEL_PRESS,
+            ARG_OBD_ENG_KM };
+    for (const char *field : fields)
+        data->setValue(field, shared_ptr<ValDouble>(new ValDouble(42.0)));
+
+    data->setType(MSG_DATA_COMPLETE);
+
+    return data;
+}
+
+/** \brief Upload phase.
+ *
+ *  Pushes data sets and reports throughput, latency and the telemetry encoding.
+ *
+ *  \return true if all data sets arrived and telemetry switched to binary, false otherwise.
+ */
+static bool upload(options &opts, LoopbackServer &server, shared_ptr<NetworkCommunicator> comm) {
+
+    // Incompressible image content, like JPEG data.
+    shared_ptr<vector<unsigned char>> image(new vector<unsigned char>(opts.size));
+    minstd_rand random(opts.size);
+    for (auto &byte : *image)
+        byte = random();
+
+    uint64_t imagesBefore = server.getImages();
+    uint64_t binaryBefore = server.getTelemetry(true);
+    uint64_t asciiBefore = server.getTelemetry(false);
+    uint64_t framesBefore = server.getFrames();
+    uint64_t bytesBefore = server.getWireBytes();
+    size_t timesBefore = server.getImageTimes().size();
+
+    vector<chrono::steady_clock::time_point> pushed;
+    auto start = chrono::steady_clock::now();
+
+    for (uint32_t index=0; index < opts.count; index++) {
+
+        if (!waitFor([&]{ return server.getImages() - imagesBefore + opts.outstanding > index; }))
+            return false;
+
+        pushed.push_back(chrono::steady_clock::now());
+        comm->out_push(createDataSet(image));
+    }
+
+    if (!waitFor([&]{ return server.getImages() - imagesBefore >= opts.count; }))
+        return false;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    vector<chrono::steady_clock::time_point> arrived = server.getImageTimes();
+
+    vector<double> latency;
+    for (uint32_t index=0; index < opts.count; index++)
+        latency.push_back(chrono::duration<double, milli>(arrived[timesBefore + index] - pushed[index]).count());
+    sort(latency.begin(), latency.end());
+
+    const char *modes[] = { "nodelay", "cork", "more" };
+    printf("upload: %u data sets of %zu bytes, %u outstanding, %s%s\n",
+            opts.count, opts.size, opts.outstanding, modes[opts.batching], opts.tls ? ", tls" : "");
+    printf("  throughput  %.1f MB/s, %.0f frames/s\n",
+            (server.getWireBytes() - bytesBefore) / seconds / 1e6,
+            (server.getFrames() - framesBefore) / seconds);
+    printf("  latency ms  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+            latency[latency.size() / 2], latency[latency.size() * 9 / 10],
+            latency[latency.size() * 99 / 100], latency.back());
+
+    // The server selects binary telemetry on registration, compressed frames aren't counted.
+    uint64_t binary = server.getTelemetry(true) - binaryBefore;
+    uint64_t ascii = server.getTelemetry(false) - asciiBefore;
+    printf("  telemetry   device %u, %llu binary, %llu ascii\n", opts.devID,
+            (unsigned long long)binary, (unsigned long long)ascii);
+
+    if (!opts.compression && !binary)
+        cerr << "nw-bench: telemetry not binary" << endl;
+
+    return opts.compression || binary > 0;
+}
+
+/** \brief Download phase.
+ *
+ *  Sends faulty command frames and checks that the intact ones arrive in order.
+ *
+ *  \return true if exactly the intact frames arrived, false otherwise.
+ */
+static bool download(options &opts, LoopbackServer &server, shared_ptr<NetworkCommunicator> comm) {
+
+    uint32_t intact = server.sendCommands(opts.commands, 16, opts.inject);
+
+    // Collect commands, expecting the command types of all intact frames in order.
+    uint32_t received=0, mismatches=0, expected=0;
+    waitFor([&]{
+        shared_ptr<Message_M2C> next;
+        while ((next = comm->in_pop())) {
+
+            if (next->getType() != MSG_COMMAND)
+                continue;
+
+            shared_ptr<Value> type;
+            next->getValue(ARG_COMMAND_TYPE, type);
+
+            // Skip corrupted frames.
+            while (opts.inject.corruptEvery && (expected + 1) % opts.inject.corruptEvery == 0)
+                expected++;
+
+            if ((uint8_t)dynamic_pointer_cast<ValInt>(type)->getValue() != (uint8_t)expected)
+                mismatches++;
+
+            expected++;
+            received++;
+        }
+        return received >= intact;
+    });
+
+    NW_Stats stats;
+    comm->collectStats(stats);
+
+    printf("download: %u commands, chunks of at most %zu bytes, every %u-th corrupted, %zu bytes noise\n",
+            opts.commands, opts.inject.chunk, opts.inject.corruptEvery, opts.inject.noise);
+    printf("  received %u of %u intact, %u out of order\n", received, intact, mismatches);
+    printf("%s", stats.toText().c_str());
+
+    return received == intact && !mismatches;
+}
+
+/** \brief Reconnect phase.
+ *
+ *  Drops the connection at the server and waits for the board unit to register again,
+ *  'reconnects' times. Reports the handshakes, if the connection is encrypted.
+ *
+ *  \return true if the board unit registered after each drop, false otherwise.
+ */
+static bool reconnect(options &opts, LoopbackServer &server) {
+
+    for (uint32_t index=0; index < opts.reconnects; index++) {
+
+        uint64_t registered = server.getFrames(MSG_ID_REGISTER);
+        server.dropClient();
+
+        if (!waitFor([&]{ return server.getFrames(MSG_ID_REGISTER) > registered; }))
+            return false;
+    }
+
+    printf("reconnect: %u connections dropped, all registered again\n", opts.reconnects);
+    if (opts.tls)
+        printf("  handshakes  full %llu (%.3f ms)  resumed %llu (%.3f ms)\n",
+                (unsigned long long)server.getHandshakes(false), server.getHandshakeTime(false),
+                (unsigned long long)server.getHandshakes(true), server.getHandshakeTime(true));
+
+    return true;
+}
+
+/** \brief Prints usage.
+ */
+static void usage() {
+
+    cerr << "usage: nw-bench [-d device id] [-n data sets] [-s image bytes] [-o outstanding] [-z deflate level]" << endl
+         << "                [-a ack window] [-t nodelay|cork|more] [-l image kbit/s] [-T] [-K]" << endl
+         << "                [-c commands] [-k max chunk] [-e corrupt every] [-g max noise]" << endl
+         << "                [-r reconnects]" << endl;
+}
+
+int main(int argc, char **argv) {
+
+    options opts;
+    opts.devID=BENCH_DEV_ID;
+    opts.count=500;
+    opts.size=100000;
+    opts.outstanding=4;
+    opts.compression=0;
+    opts.window=0;
+    opts.batching=TX_NODELAY;
+    opts.limit=0;
+    opts.tls=false;
+    opts.offload=false;
+    opts.commands=10000;
+    opts.inject.chunk=7;
+    opts.inject.corruptEvery=10;
+    opts.inject.noise=4;
+    opts.reconnects=0;
+
+    int option;
+    while ((option = getopt(argc, argv, "d:n:s:o:z:a:t:l:TKc:k:e:g:r:")) != -1) {
+        switch (option) {
+        case 'd': opts.devID = stoul(optarg); break;
+        case 'n': opts.count = stoul(optarg); break;
+        case 's': opts.size = stoul(optarg); break;
+        case 'o': opts.outstanding = max(1ul, stoul(optarg)); break;
+        case 'z': opts.compression = min(9ul, stoul(optarg)); break;
+        case 'a': opts.window = min((unsigned long)UINT16_MAX, stoul(optarg)); break;
+        case 't':
+            if (string(optarg) == "cork")
+                opts.batching = TX_CORK;
+            else if (string(optarg) == "more")
+                opts.batching = TX_MORE;
+            else if (string(optarg) != "nodelay") {
+                usage();
+                return 1;
+            }
+            break;
+        case 'l': opts.limit = stoul(optarg); break;
+        case 'T': opts.tls = true; break;
+        case 'K': opts.offload = true; break;
+        case 'c': opts.commands = stoul(optarg); break;
+        case 'k': opts.inject.chunk = stoul(optarg); break;
+        case 'e': opts.inject.corruptEvery = stoul(optarg); break;
+        case 'g': opts.inject.noise = stoul(optarg); break;
+        case 'r': opts.reconnects = stoul(optarg); break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    if (!opts.count || !opts.size) {
+        usage();
+        return 1;
+    }
+
+    // OpenSSL writes to the server socket without MSG_NOSIGNAL, e.g. alerts on dropped clients.
+    signal(SIGPIPE, SIG_IGN);
+
+    // Certificate of the server, trusted by the board unit.
+    if (opts.tls) {
+        char certFile[] = BENCH_CERT_FILE;
+        int32_t certDesc = mkstemp(certFile);
+        if (certDesc == -1) {
+            cerr << "nw-bench: certificate file failed" << endl;
+            return 1;
+        }
+        close(certDesc);
+        opts.certFile = certFile;
+    }
+
+    LoopbackServer server(FEATURE_COMPRESS | FEATURE_ACK);
+    if (server.start() || (opts.tls && server.enableTLS(opts.certFile))) {
+        cerr << "nw-bench: server setup failed" << endl;
+        if (opts.tls)
+            unlink(opts.certFile.c_str());
+        return 1;
+    }
+    thread serverThread(&LoopbackServer::run, &server);
+
+    shared_ptr<NetworkCommunicator> comm = createComm(opts, server.getPort());
+    if (!comm) {
+        cerr << "nw-bench: chain setup failed" << endl;
+        server.terminate();
+        serverThread.join();
+        if (opts.tls)
+            unlink(opts.certFile.c_str());
+        return 1;
+    }
+
+    NW_Reactor reactor;
+    thread reactorThread(&NW_Reactor::run, &reactor);
+    reactor.attach(comm);
+
+    bool success = waitFor([&]{ return server.getFrames(MSG_ID_REGISTER) > 0; });
+    if (!success)
+        cerr << "nw-bench: no registration" << endl;
+
+    if (success && !(success = upload(opts, server, comm)))
+        cerr << "nw-bench: upload incomplete" << endl;
+
+    if (success && !(success = download(opts, server, comm)))
+        cerr << "nw-bench: download incomplete" << endl;
+
+    if (success && !(success = reconnect(opts, server)))
+        cerr << "nw-bench: reconnect incomplete" << endl;
+
+    reactor.terminate();
+    reactor.wake();
+    reactorThread.join();
+
+    server.terminate();
+    serverThread.join();
+
+    if (opts.tls)
+        unlink(opts.certFile.c_str());
+
+    return success ? 0 : 1;
+}